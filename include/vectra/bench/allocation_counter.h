@@ -0,0 +1,17 @@
+#ifndef VECTRA_ALLOCATION_COUNTER_H
+#define VECTRA_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+// Heap allocations made through the global operator new, by every thread, since the program started
+struct AllocationCount
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+// allocation_counter.cpp replaces the global operator new and delete to count every allocation, so it is
+// only linked into the benchmark and never into the engine
+AllocationCount allocation_count();
+
+#endif //VECTRA_ALLOCATION_COUNTER_H
@@ -0,0 +1,51 @@
+#ifndef VECTRA_BENCHMARK_H
+#define VECTRA_BENCHMARK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "vectra/bench/workloads.h"
+#include "vectra/core/engine_state.h"
+#include "vectra/core/scene_serializer.h"
+
+struct BenchmarkOptions
+{
+    int steps = 100; // Measured steps per run
+    int warmup = 10; // Steps taken first and not measured, so start-up allocations and contacts settle
+    std::uint32_t seed = 1;
+    EngineState state; // Fixed step of 1 / simulation_frequency, substeps, sleeping and continuous collision
+};
+
+// Every per-body figure is per simulated body per step
+struct BenchmarkResult
+{
+    std::string workload;
+    std::size_t size = 0; // Bodies asked for
+    std::size_t bodies = 0; // Bodies the workload built
+    std::size_t objects = 0; // Game objects, counting the static ground and walls
+    int steps = 0;
+    double setup_ms = 0.0;
+    double step_ms = 0.0; // Wall time of every measured step
+    double ns_per_body = 0.0;
+    // Time spent in each profiler zone during the steps, by zone name. Zones nest and worker threads run
+    // some at once, so the stages don't add up to ns_per_body. Empty unless built with VECTRA_PROFILING
+    std::map<std::string, double> stage_ns_per_body;
+    double allocations_per_step = 0.0;
+    double allocated_bytes_per_step = 0.0;
+    double contacts_per_step = 0.0;
+    double contacts_per_second = 0.0; // Contacts generated per second of wall time spent stepping
+    // The render hand-off: filling a reused SceneSnapshot after every step
+    double snapshot_ns_per_body = 0.0;
+    double snapshot_allocations_per_step = 0.0;
+};
+
+// Builds the workload at `size` bodies and steps it. Runs on the calling thread and the JobSystem
+BenchmarkResult run_benchmark(const Workload& workload, std::size_t size, const BenchmarkOptions& options);
+
+// Results and the settings they were measured with, for bench_results.json
+json benchmark_report(const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options);
+
+#endif //VECTRA_BENCHMARK_H
@@ -0,0 +1,29 @@
+#ifndef VECTRA_WORKLOADS_H
+#define VECTRA_WORKLOADS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "vectra/core/scene.h"
+
+/**
+ * A generated benchmark scene. build adds about `bodies` simulated bodies to an empty scene, plus whatever
+ * static ground and walls hold them, and returns how many bodies it added. Soft bodies count their
+ * particles. The same size and seed always build the same scene, on every platform.
+ */
+struct Workload
+{
+    std::string name;
+    std::string description;
+    std::function<std::size_t(Scene& scene, std::size_t bodies, std::uint32_t seed)> build;
+};
+
+// Every workload of the suite, in the order they are run by default
+const std::vector<Workload>& benchmark_workloads();
+// nullptr if there is no workload called name
+const Workload* find_workload(const std::string& name);
+
+#endif //VECTRA_WORKLOADS_H
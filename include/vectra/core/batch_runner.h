@@ -0,0 +1,71 @@
+#ifndef VECTRA_BATCH_RUNNER_H
+#define VECTRA_BATCH_RUNNER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "vectra/core/engine_state.h"
+#include "vectra/core/scene_serializer.h"
+
+/**
+ * A parameter sweep: one scene run many times, each instance with some of its JSON values replaced.
+ * Read from a batch file such as
+ *   {
+ *       "scene": "balls_colliding.json",
+ *       "steps": 600,
+ *       "every": 10,
+ *       "output": "sweep_results",
+ *       "instances": [{"/objects/0/rigidbody/mass": 50.0}],
+ *       "sweep": {"pointer": "/objects/0/rigidbody/velocity/0", "from": 10, "to": 50, "count": 100}
+ *   }
+ * where every key of an instance is a JSON pointer into the scene file. The sweep adds count instances
+ * with the value at pointer spaced evenly from from to to.
+ */
+struct BatchDescription
+{
+    std::string scene;
+    int steps = 1000;
+    int every = 0; // Steps between the CSV rows of an instance, 0 for only the first and last state
+    std::string output_directory = "batch_results";
+    std::vector<json> instances; // JSON pointer -> value, one object per instance
+};
+
+// Throws json exceptions when a field has the wrong type
+BatchDescription batch_description_from_json(const json& j);
+
+struct BatchInstanceResult
+{
+    bool succeeded = false;
+    std::uint64_t steps = 0;
+    double simulated_time = 0.0;
+    double wall_ms = 0.0;
+    std::string message; // Why the instance failed, or the warnings of its scene
+};
+
+/**
+ * Runs every instance of a batch in one process. The scene file is read and parsed once. Each instance
+ * is one root job on the JobSystem: it applies its overrides to a copy of the parsed scene, builds and
+ * steps its own Scene, and streams its states to output/instance_<i>.csv. Idle threads take the next
+ * instance or help with the parallel stages of running ones, so the batch keeps every thread busy however
+ * uneven the instances are. summary.csv lists each instance's outcome.
+ */
+class BatchRunner
+{
+    public:
+        BatchRunner(BatchDescription description, const EngineState& state);
+
+        // False if the scene couldn't be loaded or any instance failed
+        bool run();
+        [[nodiscard]] const std::vector<BatchInstanceResult>& results() const;
+
+    private:
+        BatchDescription description_;
+        EngineState state_;
+        std::vector<BatchInstanceResult> results_;
+
+        [[nodiscard]] BatchInstanceResult run_instance(std::size_t index, const json& scene_data) const;
+        void write_summary() const;
+};
+
+#endif //VECTRA_BATCH_RUNNER_H
@@ -4,10 +4,14 @@
 
 
 #include "vectra/core/engine_state.h"
+#include "vectra/core/force_request_queue.h"
+#include "vectra/core/replay_log.h"
 #include "vectra/core/scene.h"
-#include "vectra/core/render_queue.h"
+#include "vectra/core/triple_buffer.h"
 #include "vectra/core/scene_snapshot.h"
 #include "vectra/core/scene_serializer.h"
+#include "vectra/core/snapshot_interpolator.h"
+#include "vectra/core/time_step_controller.h"
 
 #include "vectra/rendering/renderer.h"
 #include "vectra/rendering/engine_ui.h"
@@ -17,19 +21,35 @@ class Engine
 {
 private:
     EngineState state_;
-    RenderQueue<SceneSnapshot> render_queue_;
+    TripleBuffer<SceneSnapshot> snapshots_; // Newest physics state for the renderer
+    SnapshotInterpolator interpolator_; // Render thread only, blends the two newest snapshots
     SceneSerializer serializer_;
+    TimeStepController step_controller_;
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<EngineUI> ui;
+    ReplayRecorder recorder_; // Only records once record_to opened a log
+    bool recorded_paused_ = true; // Pause state the log last saw
+    ForceRequestQueue force_requests_; // Pushed by the Inspector, taken by the thread stepping the scene
+    std::vector<ForceRequest> taken_forces_; // Only touched by the thread stepping the scene
 
 
 public:
     std::unique_ptr<Scene> scene;
     Engine();
     void load_scene(const std::string& filename = "default_scene.json");
+    // Records the scenes loaded from now on and every step, pause and force to a replay log for vectra_headless --replay
+    bool record_to(const std::string& filename);
     void run_single_thread();
     void physics_thread_func();
     void rendering_thread_func();
     void run();
+    // Steps the loaded scene as fast as possible without rendering, returns wall time in milliseconds
+    double benchmark_physics(int steps);
+
+private:
+    // Called by whichever thread steps the scene: takes the Inspector's forces and records pauses
+    void take_inputs();
+    // One step of dt at the current simulation speed, recorded if recording
+    void step_scene(double dt);
 };
 #endif //VECTRA_ENGINE_H
\ No newline at end of file
@@ -13,8 +13,21 @@ struct EngineState
     linkit::real simulation_speed = 1.0; // 1.0 = normal speed, 0.5 = half-speed, 2.0 = double speed
     linkit::real target_fps = 144.0; // Target frames per second for rendering
     linkit::real simulation_frequency = 144.0; // Physics update frequency in Hz
+    bool interpolate_rendering = true; // Blend the two newest physics states so frames between ticks move smoothly
+
+    // Adaptive stepping: TimeStepController picks dt each tick, starting from simulation_frequency
+    bool adaptive_time_step = false;
+    linkit::real min_simulation_frequency = 30.0; // Bounds on the adaptive step
+    linkit::real max_simulation_frequency = 1000.0;
+    linkit::real current_dt = 0.0; // Physics step used for the last tick, reported by the physics loop
+    double tick_jitter = 0.0; // Mean lateness of physics ticks against their deadline in seconds, reported by the physics loop
+    double max_tick_jitter = 0.0; // Worst lateness over the last few hundred ticks
 
     int max_collision_contacts = 1000; // Max number of collision contacts to consider per physics update
+    int physics_substeps = 1; // >1 detects contacts once per tick and runs this many integrate + relax sub-steps
+    bool allow_sleeping = true; // Resting bodies stop being integrated until something disturbs them
+    bool continuous_collision = false; // Sweep fast bodies through each step so they can't tunnel through thin geometry
+    int worker_threads = 0; // Job system threads, counting the one waiting on them. 0 uses one per hardware thread
 
 
     int window_width = 2560;
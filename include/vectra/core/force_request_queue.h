@@ -0,0 +1,44 @@
+#ifndef VECTRA_FORCE_REQUEST_QUEUE_H
+#define VECTRA_FORCE_REQUEST_QUEUE_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "linkit/linkit.h"
+
+struct ForceRequest
+{
+    std::size_t object_index = 0;
+    linkit::Vector3 force = linkit::Vector3(0, 0, 0);
+};
+
+/**
+ * Forces the Inspector asks for on the render thread, handed to whichever thread steps the scene.
+ * Unlike the snapshots no request may be dropped, so they are queued under a mutex rather than
+ * overwritten. Both sides hold the lock only to append or to swap the whole queue out.
+ */
+class ForceRequestQueue
+{
+public:
+    void push(const std::size_t object_index, const linkit::Vector3& force)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.push_back({object_index, force});
+    }
+
+    // Moves every queued request into requests, oldest first, replacing what it held.
+    // Passing the same vector each time keeps both sides' allocations
+    void take(std::vector<ForceRequest>& requests)
+    {
+        requests.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests.swap(requests_);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<ForceRequest> requests_;
+};
+
+#endif //VECTRA_FORCE_REQUEST_QUEUE_H
@@ -4,14 +4,15 @@
 #include <memory>
 #include <string>
 
-#include "vectra/rendering/model.h"
 #include "vectra/physics/rigidbody.h"
+#include "vectra/physics/physics_world.h"
 #include "vectra/physics/collider_primitive.h"
 
 class GameObject
 {
     public:
         Rigidbody rb;
+        BodyHandle body = INVALID_BODY_HANDLE; // Simulated state in Scene::physics_world, assigned by Scene::add_game_object
         std::string name;       // Display name for hierarchy (auto-generated if empty)
         std::string model_name;
         std::unique_ptr<ColliderPrimitive> collider; // nullable, owns ColliderSphere/ColliderBox
@@ -0,0 +1,64 @@
+#ifndef VECTRA_HEADLESS_ENGINE_H
+#define VECTRA_HEADLESS_ENGINE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "vectra/core/engine_state.h"
+#include "vectra/core/replay_log.h"
+#include "vectra/core/scene.h"
+#include "vectra/core/scene_serializer.h"
+#include "vectra/core/time_step_controller.h"
+
+/**
+ * Runs scenes without a window, OpenGL context or UI, for offline and server-side simulation.
+ * Steps back to back with no frame pacing. Physics settings come from the same EngineState the
+ * windowed Engine uses: frequency, adaptive stepping, substeps, sleeping and continuous collision.
+ * Several engines can run at once on different threads. The job system is shared by all of them, so
+ * it is sized once by whoever owns the process.
+ */
+class HeadlessEngine
+{
+    public:
+        std::unique_ptr<Scene> scene;
+
+        explicit HeadlessEngine(const EngineState& state = EngineState());
+
+        // Loads from resources/scenes, or from filename itself when it is an absolute path.
+        // Errors and warnings are printed. Returns false, keeping the previous scene, if loading failed
+        bool load_scene(const std::string& filename);
+        // Runs an already loaded scene from its start. name is reported as the loaded scene
+        void set_scene(Scene&& loaded, const std::string& name);
+
+        // Steps the scene steps times as fast as possible. on_tick(tick) runs after every step.
+        // Returns the wall time in milliseconds
+        double run(int steps, const std::function<void(std::uint64_t tick)>& on_tick = {});
+
+        // Records every scene loaded and every step taken from now on into recorder, which must outlive
+        // the engine or be detached with nullptr. Recording needs the scene file, so set_scene isn't recorded
+        void record_to(ReplayRecorder* recorder);
+
+        // Writes the current state as a scene file, loadable like any other
+        void save_scene(const std::string& filename);
+
+        // One CSV row per object: tick, time, name, position, orientation, velocity and angular velocity
+        static void write_csv_header(std::ostream& out);
+        void write_csv_rows(std::ostream& out) const;
+
+        [[nodiscard]] std::uint64_t tick() const;
+        [[nodiscard]] double simulated_time() const; // Seconds of simulation since the scene was loaded
+        [[nodiscard]] const EngineState& state() const;
+
+    private:
+        EngineState state_;
+        SceneSerializer serializer_;
+        TimeStepController step_controller_;
+        std::uint64_t tick_ = 0;
+        double simulated_time_ = 0.0;
+        ReplayRecorder* recorder_ = nullptr;
+};
+
+#endif //VECTRA_HEADLESS_ENGINE_H
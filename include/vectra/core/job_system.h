@@ -0,0 +1,172 @@
+#ifndef VECTRA_JOB_SYSTEM_H
+#define VECTRA_JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job;
+using JobHandle = std::shared_ptr<Job>;
+
+// A unit of work, runnable once every job it depends on has finished
+struct Job
+{
+    std::function<void()> function;
+    std::atomic<int> unfinished{0}; // Dependencies still running, plus one until the job is scheduled
+    std::atomic<bool> done{false};
+    std::mutex mutex; // Guards continuations, finished and error
+    std::vector<JobHandle> continuations; // Jobs waiting on this one
+    bool finished = false;
+    std::exception_ptr error; // Thrown by the job, or by a job it depends on
+    bool root = false; // Only started by a thread that isn't running another job, see JobSystem::schedule_root
+};
+
+/**
+ * Engine-wide pool of worker threads, so physics stages, asset loading and serialization share one
+ * thread budget instead of each spawning their own std::threads.
+ * Every worker owns a deque of ready jobs. It takes its newest job first and, once it runs dry, steals
+ * the oldest job from another worker. Threads that aren't workers, such as the physics and render threads,
+ * share one extra deque. A thread waiting on a job keeps running other jobs until it finishes,
+ * so jobs can schedule and wait on more jobs without deadlocking. Root jobs wait in a queue of their own
+ * that only threads outside any job take from, so a waiting job never runs one nested.
+ */
+class JobSystem
+{
+public:
+    // Created with one thread per hardware thread on first use
+    static JobSystem& instance();
+
+    explicit JobSystem(std::size_t thread_count = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Threads that run jobs, counting the thread that waits on them. 0 uses one per hardware thread.
+    // Stops and restarts the workers, so no jobs may be running
+    void set_thread_count(std::size_t thread_count);
+    [[nodiscard]] std::size_t thread_count() const;
+
+    // Runs function on some thread once every job in dependencies has finished
+    JobHandle schedule(std::function<void()> function, const std::vector<JobHandle>& dependencies = {});
+    // Runs function once job has finished
+    JobHandle then(const JobHandle& job, std::function<void()> function);
+    // Like schedule, but only a thread that isn't already inside a job starts it, so a wait never picks it up
+    // and runs it nested on the waiting job's stack. For long independent jobs, such as batch instances,
+    // that wait on jobs of their own
+    JobHandle schedule_root(std::function<void()> function);
+
+    // Runs other jobs on the calling thread until job has finished, then rethrows anything it threw
+    void wait(const JobHandle& job);
+    void wait(const std::vector<JobHandle>& jobs);
+
+    // Calls function(first, last) over [0, count) in ranges of at most grain items. Threads take the
+    // next range as they finish one, so uneven ranges balance out. Returns once every range is done
+    template <class Function>
+    void parallel_for_ranges(std::size_t count, std::size_t grain, const Function& function);
+
+    // Calls function(i) for every i in [0, count), in ranges of at most grain items
+    template <class Function>
+    void parallel_for(std::size_t count, std::size_t grain, const Function& function);
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    std::size_t thread_count_ = 1;
+    std::vector<std::thread> workers_;
+    // One per worker, and a last one shared by every thread that isn't a worker
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    WorkQueue root_queue_; // Root jobs, oldest first, taken only outside any job
+
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    void start(std::size_t thread_count);
+    void stop();
+    void worker_loop(std::size_t index);
+
+    void push(JobHandle job);
+    // Own deque first, newest job first, then the oldest job of every other deque, then the oldest
+    // root job if the calling thread isn't inside a job
+    JobHandle pop();
+    // Runs one ready job, false if there was none
+    bool run_one();
+    void execute(const JobHandle& job);
+    [[nodiscard]] std::size_t own_queue() const;
+};
+
+template <class Function>
+void JobSystem::parallel_for_ranges(const std::size_t count, std::size_t grain, const Function& function)
+{
+    grain = std::max<std::size_t>(1, grain);
+    const std::size_t ranges = (count + grain - 1) / grain;
+    if (ranges <= 1 || thread_count_ == 1)
+    {
+        if (count > 0) function(0, count);
+        return;
+    }
+
+    // Every helper, and the calling thread, claims ranges until none are left
+    std::atomic<std::size_t> next{0};
+    auto claim_ranges = [&]()
+    {
+        for (std::size_t r = next.fetch_add(1, std::memory_order_relaxed); r < ranges;
+             r = next.fetch_add(1, std::memory_order_relaxed))
+        {
+            function(r * grain, std::min(count, (r + 1) * grain));
+        }
+    };
+
+    std::vector<JobHandle> helpers;
+    const std::size_t helper_count = std::min(ranges, thread_count_) - 1;
+    helpers.reserve(helper_count);
+    for (std::size_t h = 0; h < helper_count; h++) helpers.push_back(schedule(claim_ranges));
+
+    // The helpers refer to this stack frame, so they are waited on even if this thread's ranges throw
+    std::exception_ptr error;
+    try
+    {
+        claim_ranges();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        next.store(ranges, std::memory_order_relaxed);
+    }
+    for (const JobHandle& helper : helpers)
+    {
+        try
+        {
+            wait(helper);
+        }
+        catch (...)
+        {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+template <class Function>
+void JobSystem::parallel_for(const std::size_t count, const std::size_t grain, const Function& function)
+{
+    parallel_for_ranges(count, grain, [&function](const std::size_t first, const std::size_t last)
+    {
+        for (std::size_t i = first; i < last; i++) function(i);
+    });
+}
+
+#endif //VECTRA_JOB_SYSTEM_H
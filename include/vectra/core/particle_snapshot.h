@@ -0,0 +1,11 @@
+#ifndef VECTRA_PARTICLE_SNAPSHOT_H
+#define VECTRA_PARTICLE_SNAPSHOT_H
+
+#include <vector>
+
+struct ParticleSnapshot
+{
+    std::vector<float> instances; // x, y, z, radius per particle, uploaded as is for instanced drawing
+};
+
+#endif //VECTRA_PARTICLE_SNAPSHOT_H
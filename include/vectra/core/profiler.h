@@ -0,0 +1,149 @@
+#ifndef VECTRA_PROFILER_H
+#define VECTRA_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define VECTRA_PROFILER_RDTSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define VECTRA_PROFILER_RDTSC 1
+#else
+#define VECTRA_PROFILER_RDTSC 0
+#endif
+
+// Zones are built in when CMake's VECTRA_ENABLE_PROFILER defines VECTRA_PROFILING=1. Otherwise the macros
+// below expand to nothing and no profiling code is left in the engine
+#ifndef VECTRA_PROFILING
+#define VECTRA_PROFILING 0
+#endif
+
+// A finished zone, as read back from the profiler
+struct ProfileZone
+{
+    const char* name = nullptr;
+    std::int64_t start_ns = 0; // Since the profiler was created
+    std::int64_t end_ns = 0;
+    std::uint32_t depth = 0; // Zones that were open on the same thread when this one began
+    std::uint32_t thread = 0; // Index into Profiler::thread_names()
+};
+
+/**
+ * Collects timed zones from every thread. Each thread writes the zones it closes into its own ring buffer,
+ * so recording takes no locks and never allocates. Readers copy the rings out and drop whatever the owning
+ * thread overwrote while they were copying. A ring keeps the last ZONES_PER_THREAD zones of its thread.
+ * Zones are stamped with the CPU's time stamp counter where there is one, and with the steady clock
+ * otherwise. Ticks are only converted to nanoseconds when zones are read back.
+ */
+class Profiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t ZONES_PER_THREAD = 1 << 14;
+
+    // Never destroyed, so threads that exit during static destruction can still hand back their buffers
+    static Profiler& instance()
+    {
+        static Profiler* profiler = new Profiler();
+        return *profiler;
+    }
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // While disabled, a zone costs one relaxed load
+    void set_enabled(bool enabled);
+    [[nodiscard]] bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Name shown for the calling thread's zones
+    void set_thread_name(const std::string& name);
+    [[nodiscard]] std::vector<std::string> thread_names() const;
+
+    // Nanoseconds since the profiler was created
+    [[nodiscard]] std::int64_t now_ns() const;
+
+    // Raw timestamp in clock ticks, as stored for each zone
+    static std::int64_t ticks()
+    {
+#if VECTRA_PROFILER_RDTSC
+        return static_cast<std::int64_t>(__rdtsc());
+#else
+        return Clock::now().time_since_epoch().count();
+#endif
+    }
+
+    // Appends the recorded zones of every thread that ended at or after since_ns, in no particular order
+    void collect(std::vector<ProfileZone>& zones, std::int64_t since_ns = 0) const;
+    // Every recorded zone in Chrome's trace event format, for chrome://tracing or ui.perfetto.dev
+    bool write_chrome_trace(const std::string& filename) const;
+
+private:
+    friend class ProfileScope;
+    struct ThreadBuffer;
+    struct ThreadBufferOwner;
+
+    Profiler();
+
+    Clock::time_point epoch_;
+    std::int64_t epoch_ticks_;
+    std::atomic<bool> enabled_{true};
+    mutable std::mutex mutex_; // Guards buffers_ and the buffers' names and owners
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_; // Never shrinks, a thread's buffer is reused after it exits
+
+    ThreadBuffer& thread_buffer();
+    ThreadBuffer& acquire_buffer();
+    void release_buffer(ThreadBuffer& buffer);
+    // Called by ProfileScope. Sets depth to the zones already open on the calling thread
+    ThreadBuffer& open_zone(std::uint32_t& depth);
+    static void close_zone(ThreadBuffer& buffer, const char* name, std::int64_t start_ticks, std::uint32_t depth);
+    // Measured over the profiler's lifetime so far, so it gets more precise the longer it runs
+    [[nodiscard]] double ticks_per_ns() const;
+};
+
+// Times the enclosing scope as one zone. The name must outlive the profiler, usually a string literal
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+    {
+        Profiler& profiler = Profiler::instance();
+        if (!profiler.enabled()) return;
+        name_ = name;
+        buffer_ = &profiler.open_zone(depth_);
+        start_ticks_ = Profiler::ticks();
+    }
+
+    ~ProfileScope()
+    {
+        if (buffer_) Profiler::close_zone(*buffer_, name_, start_ticks_, depth_);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler::ThreadBuffer* buffer_ = nullptr; // Null when the profiler was disabled at the start of the scope
+    const char* name_ = nullptr;
+    std::int64_t start_ticks_ = 0;
+    std::uint32_t depth_ = 0;
+};
+
+#if VECTRA_PROFILING
+#define VECTRA_PROFILE_CONCAT_INNER(a, b) a##b
+#define VECTRA_PROFILE_CONCAT(a, b) VECTRA_PROFILE_CONCAT_INNER(a, b)
+// Times the rest of the enclosing scope
+#define VECTRA_PROFILE_SCOPE(name) const ProfileScope VECTRA_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+// Names the calling thread in the timeline and trace
+#define VECTRA_PROFILE_THREAD(name) Profiler::instance().set_thread_name(name)
+#else
+#define VECTRA_PROFILE_SCOPE(name) do {} while (false)
+#define VECTRA_PROFILE_THREAD(name) do {} while (false)
+#endif
+
+#endif //VECTRA_PROFILER_H
@@ -0,0 +1,119 @@
+#ifndef VECTRA_REPLAY_LOG_H
+#define VECTRA_REPLAY_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "linkit/linkit.h"
+#include "vectra/core/engine_state.h"
+#include "vectra/core/scene.h"
+#include "vectra/core/scene_serializer.h"
+
+/**
+ * A replay log is a run reduced to its starting scene and the inputs of every tick, so it can be stepped
+ * again headless and bit for bit. After a short header come events, each a tag byte and its payload:
+ *   SCENE     the physics settings and the scene file as CBOR. First event, and again on every restart
+ *   STEPS     n steps of the current dt
+ *   DT        the dt handed to Scene::step, simulation speed included
+ *   SPEED     simulation_speed, only reported
+ *   PAUSE     RESUME
+ *   FORCE     an object index and a force, passed to Scene::apply_force before the next step
+ *   CHECKSUM  scene_state_hash after the steps so far
+ *   END
+ * Counts and indices are LEB128 varints and reals their raw little-endian bits. dt and speed are only
+ * written when they change and consecutive steps share one STEPS event, so a fixed step run costs a few
+ * bytes per checksum.
+ * A replay matches the recording when built with the same precision, compiler and standard library, and
+ * run with the same job system thread count, which decides how parallel stages split their work. The
+ * header records the precision and the thread count.
+ */
+
+// FNV-1a over the bits of every body's pose and velocities, and every soft body and particle position and velocity
+std::uint64_t scene_state_hash(const Scene& scene);
+
+class ReplayRecorder
+{
+    public:
+        std::uint64_t checksum_interval = 60; // Steps between checksums, 0 for none
+
+        ReplayRecorder() = default;
+        ~ReplayRecorder();
+        ReplayRecorder(const ReplayRecorder&) = delete;
+        ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+        // Starts a new log. Returns false if the file couldn't be opened
+        bool open(const std::string& filename);
+        [[nodiscard]] bool is_open() const;
+        // Writes the pending steps and END. Also done by the destructor
+        void close();
+
+        // Thread safe: scenes are loaded on the render thread while the physics thread steps them.
+        // Call record_scene once the loaded scene has its settings, it checksums the starting state
+        void record_scene(const json& scene_data, const std::string& name, const EngineState& state, const Scene& scene);
+        // After every Scene::step, with the dt it was given
+        void record_step(linkit::real dt, linkit::real speed, const Scene& scene);
+        void record_pause(bool paused);
+        void record_force(std::size_t object_index, const linkit::Vector3& force);
+
+    private:
+        mutable std::mutex mutex_;
+        std::ofstream out_;
+        std::uint64_t pending_steps_ = 0; // Steps not yet written as a STEPS event
+        std::uint64_t steps_since_checksum_ = 0;
+        bool has_dt_ = false;
+        linkit::real dt_ = 0.0;
+        bool has_speed_ = false;
+        linkit::real speed_ = 0.0;
+
+        void flush_steps();
+        void write_checksum(const Scene& scene);
+};
+
+struct ReplayResult
+{
+    bool succeeded = false; // Read to its end with every checksum matching
+    std::uint64_t steps = 0;
+    std::uint64_t scenes = 0; // The first scene and every restart
+    std::uint64_t forces = 0;
+    std::uint64_t pauses = 0;
+    std::uint64_t checksums = 0; // Checked and matching
+    std::int64_t mismatch_step = -1; // Step after which the state first differed from the recording
+    double simulated_time = 0.0; // Sum of the recorded dts
+    double wall_ms = 0.0;
+    std::string message; // Why the replay failed, or a note on a log that was cut short
+};
+
+/**
+ * Steps a replay log back to back, as fast as the scene allows. Scenes come from the log itself, so the
+ * scene files may have changed since the recording.
+ */
+class ReplayPlayer
+{
+    public:
+        // Reads the header. Returns false, with message() saying why, if the file isn't a replay log of this
+        // build's precision
+        bool open(const std::string& filename);
+        [[nodiscard]] std::uint32_t recorded_threads() const;
+        [[nodiscard]] const std::string& message() const;
+
+        // Replays every event, stopping at the first checksum that doesn't match. on_step(scene, step) runs
+        // after every step
+        ReplayResult run(const std::function<void(const Scene& scene, std::uint64_t step)>& on_step = {});
+
+        // The scene being replayed, or nullptr before run
+        [[nodiscard]] const Scene* scene() const;
+
+    private:
+        std::ifstream in_;
+        std::uint32_t threads_ = 0;
+        std::string message_;
+        SceneSerializer serializer_;
+        std::unique_ptr<Scene> scene_;
+};
+
+#endif //VECTRA_REPLAY_LOG_H
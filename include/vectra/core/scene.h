@@ -5,19 +5,25 @@
 #include <deque>
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "vectra/rendering/camera.h"
 #include "vectra/rendering/scene_lights.h"
-#include "vectra/rendering/skybox.h"
 
 #include "vectra/core/gameobject.h"
 #include "vectra/core/scene_snapshot.h"
 #include "vectra/core/engine_state.h"
+#include "vectra/core/time_step_controller.h"
 
 #include "vectra/physics/force_registry.h"
 #include "vectra/physics/BVHNode.h"
 #include "vectra/physics/bounding_volumes/bounding_sphere.h"
 #include "vectra/physics/collision_handler.h"
+#include "vectra/physics/particle_system.h"
+#include "vectra/physics/physics_world.h"
+#include "vectra/physics/soft_body.h"
+#include "vectra/physics/spring_network.h"
 
 class Scene
 {
@@ -28,14 +34,27 @@ class Scene
         std::deque<GameObject> game_objects; // stable pointers
         SceneLights scene_lights;
         Camera camera;
-        Skybox skybox;
+        PhysicsWorld physics_world; // simulated body state, indexed by GameObject::body
         ForceRegistry force_registry;
+        SpringNetwork spring_network; // Stiff springs, solved implicitly after the force registry
         std::unique_ptr<BVHNode<BoundingSphere>> bvh_root;
         CollisionHandler collision_handler;
+        std::vector<SoftBody> soft_bodies; // Stepped after the rigid bodies, which push them but aren't pushed back
+        std::vector<ParticleSystem> particle_systems; // Stepped after the rigid bodies too, one-way and alongside the soft bodies
 private:
-    std::unordered_map<GameObject*, BVHNode<BoundingSphere>*> bvh_node_map;
+    // Leaf of each body, indexed by BodyHandle. Indexed rather than keyed by GameObject* so that nothing
+    // in a step depends on where objects happen to be allocated
+    std::vector<BVHNode<BoundingSphere>*> bvh_leaves_;
     std::unordered_map<std::string, int> name_counters_; // For auto-generating object names
     int max_collision_contacts_ = 1000;
+    int substeps_ = 1;
+    std::vector<linkit::real> body_core_radii_; // Indexed by BodyHandle, for the step error measures
+    StepStats last_step_stats_;
+    linkit::real energy_scale_ = 1;
+    std::vector<GameObject*> overlapping_objects_; // Scratch for the soft body broad phase
+    std::vector<GameObject*> particle_overlaps_; // Same for particles, which are stepped alongside the soft bodies
+    mutable std::shared_ptr<const SnapshotObjectTable> object_table_; // Built on demand, reset when objects are added
+    std::vector<std::pair<BodyHandle, linkit::Vector3>> external_forces_; // From apply_force, cleared after each step
 
 
 public:
@@ -44,12 +63,25 @@ public:
     void add_point_light(const PointLight& light);
     void add_spot_light(const SpotLight& light);
     void step(linkit::real dt);
+    // Pushes game_objects[object_index] with force throughout the next step, waking it. Out of range indices are ignored
+    void apply_force(std::size_t object_index, const linkit::Vector3& force);
     void set_from_engine_state(const EngineState& state);
 
-    SceneSnapshot create_snapshot() const;
+    // Fills snapshot in place, reusing its buffers
+    void create_snapshot(SceneSnapshot& snapshot) const;
+    [[nodiscard]] SceneSnapshot create_snapshot() const;
+    [[nodiscard]] const StepStats& last_step_stats() const;
 
 private:
     void update_bvh();
+    void sync_transforms();
+    void step_substepped(linkit::real dt);
+    void finish_step(linkit::real dt);
+    void step_soft_bodies(linkit::real dt);
+    void step_particle_systems(linkit::real dt);
+    void add_external_forces();
+    void measure_step(linkit::real dt);
+    [[nodiscard]] const std::shared_ptr<const SnapshotObjectTable>& object_table() const;
 };
 #endif //VECTRA_SCENE_H
 
@@ -42,10 +42,17 @@ public:
     void serialize_scene(const Scene& scene, const std::string& filename);
     SceneLoadResult deserialize_scene(const std::string& filename);
 
+    // The two halves of deserialize_scene, so one parsed file can build many scenes. read_scene_file
+    // throws on a missing or malformed file. source_name only labels errors
+    json read_scene_file(const std::string& filename);
+    SceneLoadResult deserialize_scene_json(const json& scene_data, const std::string& source_name);
+
 private:
     int indentation_level_ = 4;
     json read_json(const std::string& filename);
     static std::filesystem::path get_scenes_directory();
+    // filename in the scenes directory, or filename itself when it is absolute
+    static std::filesystem::path resolve_scene_path(const std::string& filename);
     void print_json(const json& j) const;
     void write_json(const std::string& filename, const json& j);
 
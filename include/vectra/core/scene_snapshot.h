@@ -1,17 +1,70 @@
 #ifndef VECTRA_SCENE_SNAPSHOT_H
 #define VECTRA_SCENE_SNAPSHOT_H
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
-#include "vectra/core/gameobject_snapshot.h"
+#include "vectra/core/particle_snapshot.h"
+#include "vectra/core/soft_body_snapshot.h"
 
 #include "vectra/physics/BVHNode.h"
+#include "vectra/physics/transform.h"
 #include "vectra/physics/bounding_volumes/bounding_sphere.h"
 
+// Names and models of the scene's objects. Only rebuilt when objects are added, every snapshot in between shares it
+struct SnapshotObjectTable
+{
+    std::vector<std::string> names; // By object ID
+    std::vector<std::uint32_t> model_ids; // By object ID, index into model_names
+    std::vector<std::string> model_names; // Each model the scene uses, once
+};
+
+/**
+ * The scene as the renderer and UI see it. An object's ID is its index in Scene::game_objects, and
+ * per object state is kept in flat arrays indexed by ID. Scene::create_snapshot fills a snapshot in place,
+ * so one reused from an earlier tick is refilled without allocating or copying strings.
+ */
 struct SceneSnapshot
 {
-    std::vector<GameObjectSnapshot> object_snapshots;
+    std::shared_ptr<const SnapshotObjectTable> object_table;
+    std::vector<float> model_matrices; // 16 floats per object, column major as uploaded to the GPU
+    std::vector<Transform> transforms;
+    std::vector<linkit::Vector3> forces; // Resultant force on each object
+    std::vector<std::uint8_t> has_spring;
+    std::vector<linkit::Vector3> spring_anchors; // Only meaningful where has_spring is set
+
+    std::vector<SoftBodySnapshot> soft_body_snapshots;
+    std::vector<ParticleSnapshot> particle_snapshots;
     BVHNode<BoundingSphere>* bvh_root = nullptr;
 
+    // Stamped by the physics loop when it publishes, so the renderer can interpolate between snapshots
+    std::uint64_t tick = 0; // Physics steps taken since the scene was loaded
+    std::chrono::steady_clock::time_point time{}; // Real time at which this state was due
+    double dt = 0.0; // Real time covered by the last step, in seconds
+
+    [[nodiscard]] std::size_t object_count() const { return transforms.size(); }
 };
-#endif //VECTRA_SCENE_SNAPSHOT_H
\ No newline at end of file
+
+// Writes transform's model matrix (translation * rotation * scale) as 16 floats, column major
+inline void write_model_matrix(const Transform& transform, float* matrix)
+{
+    const linkit::Matrix3 rotation = transform.rotation.to_matrix3();
+    const linkit::real scale[3] = {transform.scale.x, transform.scale.y, transform.scale.z};
+    for (int column = 0; column < 3; column++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            matrix[4 * column + row] = static_cast<float>(rotation.m[row][column] * scale[column]);
+        }
+        matrix[4 * column + 3] = 0.0f;
+    }
+    matrix[12] = static_cast<float>(transform.position.x);
+    matrix[13] = static_cast<float>(transform.position.y);
+    matrix[14] = static_cast<float>(transform.position.z);
+    matrix[15] = 1.0f;
+}
+
+#endif //VECTRA_SCENE_SNAPSHOT_H
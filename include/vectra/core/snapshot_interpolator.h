@@ -0,0 +1,42 @@
+#ifndef VECTRA_SNAPSHOT_INTERPOLATOR_H
+#define VECTRA_SNAPSHOT_INTERPOLATOR_H
+
+#include <chrono>
+
+#include "vectra/core/scene_snapshot.h"
+
+/**
+ * Keeps the two newest snapshots on the render thread and blends between them, so frames between
+ * physics ticks still show smooth motion. A frame at time `now` shows the scene one snapshot interval
+ * in the past. Positions are lerped and rotations nlerped. Soft body vertices are lerped too.
+ * Particles and debug data come from the newest snapshot: while blending, the frame borrows those
+ * buffers from it by swapping rather than copying them.
+ */
+class SnapshotInterpolator
+{
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Takes over newest by swapping buffers. newest is left holding the oldest snapshot, whose
+        // buffers can then be refilled by the producer
+        void push(SceneSnapshot& newest);
+
+        // The scene to draw at now. Without interpolation, or without two matching snapshots,
+        // this is the newest snapshot itself
+        SceneSnapshot& frame(Clock::time_point now, bool interpolate = true);
+
+    private:
+        SceneSnapshot previous_;
+        SceneSnapshot current_;
+        SceneSnapshot frame_; // Blended state, reused every frame
+        bool frame_borrowed_ = false; // frame_ holds current_'s unblended buffers, and current_ holds frame_'s old ones
+
+        // Fraction of the way from previous_ to current_ at now, 1 if they can't be blended
+        [[nodiscard]] double blend_factor(Clock::time_point now) const;
+        // Swaps the unblended buffers between current_ and frame_, so each call lends or returns them
+        void swap_unblended();
+        void borrow_for_frame();
+        void return_to_current();
+};
+
+#endif //VECTRA_SNAPSHOT_INTERPOLATOR_H
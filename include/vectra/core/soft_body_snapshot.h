@@ -0,0 +1,16 @@
+#ifndef VECTRA_SOFT_BODY_SNAPSHOT_H
+#define VECTRA_SOFT_BODY_SNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "linkit/linkit.h"
+
+struct SoftBodySnapshot
+{
+    std::vector<linkit::Vector3> positions;
+    std::shared_ptr<const std::vector<std::uint32_t>> triangles; // Shared with the SoftBody, never changes
+};
+
+#endif //VECTRA_SOFT_BODY_SNAPSHOT_H
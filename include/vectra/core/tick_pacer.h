@@ -0,0 +1,33 @@
+#ifndef VECTRA_TICK_PACER_H
+#define VECTRA_TICK_PACER_H
+
+#include <chrono>
+
+/**
+ * Puts the physics thread to sleep until its next tick is due.
+ * A plain sleep can wake up a scheduler quantum late, a large share of a 144 Hz tick. The pacer sleeps
+ * until a margin before the deadline and yields for the rest. The margin follows how late its recent
+ * sleeps woke up. It also reports how late each tick starts against its deadline, the tick jitter.
+ */
+class TickPacer
+{
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Blocks until deadline. Returns at once if it has already passed
+        void wait_until(Clock::time_point deadline);
+
+        // Lateness of ticks against their deadlines, in seconds. The mean is a moving average,
+        // the max is the worst tick of the last full window
+        [[nodiscard]] double mean_jitter() const;
+        [[nodiscard]] double max_jitter() const;
+
+    private:
+        double spin_margin_ = 0.001; // Seconds before the deadline at which sleeping stops and spinning starts
+        double mean_jitter_ = 0.0;
+        double max_jitter_ = 0.0;
+        double window_max_jitter_ = 0.0;
+        int window_ticks_ = 0;
+};
+
+#endif //VECTRA_TICK_PACER_H
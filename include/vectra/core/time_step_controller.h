@@ -0,0 +1,49 @@
+#ifndef VECTRA_TIME_STEP_CONTROLLER_H
+#define VECTRA_TIME_STEP_CONTROLLER_H
+
+#include <cstddef>
+
+#include "linkit/linkit.h"
+#include "vectra/core/engine_state.h"
+
+// Error measures of the last Scene::step, read by the adaptive step controller
+struct StepStats
+{
+    linkit::real dt = 0;
+    linkit::real max_motion_ratio = 0; // Largest distance moved in the step, in units of that body's core radius
+    linkit::real max_penetration = 0; // Deepest contact left after resolve_interpretations
+    linkit::real kinetic_energy = 0;
+    linkit::real energy_drift = 0; // Change of kinetic energy over the step not done by applied forces, relative to its recent peak
+    std::size_t contacts = 0; // Contacts the narrow phase generated, for benchmarks
+};
+
+/**
+ * Chooses the physics time step from how violent the last step was. Every error measure is divided
+ * by its tolerance; the worst one shrinks the step when above 1 and lets it grow while the scene is calm.
+ */
+class TimeStepController
+{
+    public:
+        linkit::real min_dt = static_cast<linkit::real>(1.0 / 1000.0);
+        linkit::real max_dt = static_cast<linkit::real>(1.0 / 30.0);
+
+        linkit::real motion_tolerance = static_cast<linkit::real>(0.25);
+        linkit::real penetration_tolerance = static_cast<linkit::real>(0.01);
+        linkit::real energy_tolerance = static_cast<linkit::real>(0.05);
+
+        // Largest change of dt allowed from one step to the next
+        linkit::real max_growth = static_cast<linkit::real>(1.25);
+        linkit::real max_shrink = static_cast<linkit::real>(0.5);
+
+        void configure(const EngineState& state);
+        // Moves the step's bounds while running, pulling the current step inside them
+        void set_frequency_bounds(linkit::real min_frequency, linkit::real max_frequency);
+        [[nodiscard]] linkit::real dt() const;
+        // Feeds back the stats of the step just taken and returns the dt for the next one
+        linkit::real update(const StepStats& stats);
+
+    private:
+        linkit::real dt_ = static_cast<linkit::real>(1.0 / 144.0);
+};
+
+#endif //VECTRA_TIME_STEP_CONTROLLER_H
@@ -0,0 +1,61 @@
+#ifndef VECTRA_TRIPLE_BUFFER_H
+#define VECTRA_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Hands the latest value from one producer thread to one consumer thread without locks or waiting.
+ * Three slots: one being written, one being read, and one in the middle holding the newest complete value.
+ * publish() swaps the written slot into the middle and acquire() swaps the middle out for reading,
+ * each with a single atomic exchange. Values the consumer never picked up are overwritten: latest wins.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Producer: slot to fill before publish(). Reusing it keeps its allocations from three values back
+    T& write_buffer()
+    {
+        return buffers_[write_];
+    }
+
+    // Producer: makes the write buffer the newest value, never blocks
+    void publish()
+    {
+        write_ = middle_.exchange(static_cast<std::uint8_t>(write_ | FRESH), std::memory_order_acq_rel) & INDEX;
+    }
+
+    void publish(T value)
+    {
+        write_buffer() = std::move(value);
+        publish();
+    }
+
+    // Consumer: takes the newest published value if there is one since the last call, never blocks.
+    // Returns false and keeps the current read buffer otherwise
+    bool acquire()
+    {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) return false;
+        read_ = middle_.exchange(read_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    // Consumer: value taken by the last successful acquire(), or a default T before the first one
+    T& read_buffer()
+    {
+        return buffers_[read_];
+    }
+
+private:
+    static constexpr std::uint8_t INDEX = 0b011;
+    static constexpr std::uint8_t FRESH = 0b100; // Middle holds a value the consumer hasn't taken yet
+
+    T buffers_[3];
+    std::uint8_t write_ = 0; // Only touched by the producer
+    std::uint8_t read_ = 1; // Only touched by the consumer
+    std::atomic<std::uint8_t> middle_{2};
+};
+
+#endif //VECTRA_TRIPLE_BUFFER_H
@@ -3,6 +3,7 @@
 #define VECTRA_BVHNODE_H
 
 #include <memory>
+#include <utility>
 #include <vector>
 #include "vectra/core/gameobject.h"
 
@@ -37,12 +38,14 @@ public:
     void recalculate_bounding_volume()
     {
         if (!children[0] || !children[1]) return;
-        bounding_volume = std::make_unique<BoundingVolumeClass>(
-            *children[0]->bounding_volume,
-            *children[1]->bounding_volume
-        );
+        // Refit in place, this runs for every ancestor of every body that moved
+        const BoundingVolumeClass combined(*children[0]->bounding_volume, *children[1]->bounding_volume);
+        if (bounding_volume) *bounding_volume = combined;
+        else bounding_volume = std::make_unique<BoundingVolumeClass>(combined);
     }
 
+    // Splits the leaf chosen for new_obj: its old object moves to children[0] and new_obj becomes children[1],
+    // which is returned. Scene::add_game_object relies on this to re-map only those two leaves
     BVHNode<BoundingVolumeClass>* insert(GameObject* new_obj, const BoundingVolumeClass& new_volume)
     {
         if (is_leaf())
@@ -79,18 +82,18 @@ public:
 
         if (children[0] && children[1] && children[0]->overlaps(children[1]))
         {
-            contacts = children[0]->potential_contacts_with(children[1], contacts, limit);
+            contacts = children[0]->potential_contacts_with(children[1], std::move(contacts), limit);
             if (contacts.size() >= limit) return contacts;
         }
 
         if (children[0])
         {
-            contacts = children[0]->potential_contacts_inside(contacts, limit);
+            contacts = children[0]->potential_contacts_inside(std::move(contacts), limit);
             if (contacts.size() >= limit) return contacts;
         }
         if (children[1])
         {
-            contacts = children[1]->potential_contacts_inside(contacts, limit);
+            contacts = children[1]->potential_contacts_inside(std::move(contacts), limit);
         }
         return contacts;
     }
@@ -113,12 +116,12 @@ public:
         {
             if (children[0])
             {
-                contacts = children[0]->potential_contacts_with(other, contacts, limit);
+                contacts = children[0]->potential_contacts_with(other, std::move(contacts), limit);
                 if (contacts.size() >= limit) return contacts;
             }
             if (children[1])
             {
-                contacts = children[1]->potential_contacts_with(other, contacts, limit);
+                contacts = children[1]->potential_contacts_with(other, std::move(contacts), limit);
             }
             return contacts;
         }
@@ -126,17 +129,30 @@ public:
         {
             if (other->children[0])
             {
-                contacts = potential_contacts_with(other->children[0], contacts, limit);
+                contacts = potential_contacts_with(other->children[0], std::move(contacts), limit);
                 if (contacts.size() >= limit) return contacts;
             }
             if (other->children[1])
             {
-                contacts = potential_contacts_with(other->children[1], contacts, limit);
+                contacts = potential_contacts_with(other->children[1], std::move(contacts), limit);
             }
             return contacts;
         }
     }
 
+    // Appends every object whose volume overlaps `volume`
+    void query(const BoundingVolumeClass& volume, std::vector<GameObject*>& objects) const
+    {
+        if (!bounding_volume || !bounding_volume->overlaps(volume)) return;
+        if (is_leaf())
+        {
+            objects.push_back(object);
+            return;
+        }
+        if (children[0]) children[0]->query(volume, objects);
+        if (children[1]) children[1]->query(volume, objects);
+    }
+
     // Recompute bounds from this node up to the root.
     void recalc_upwards() {
         BVHNode* n = this;
@@ -41,6 +41,10 @@ struct CollisionContact
     linkit::Vector3 contact_velocity;       // Relative velocity in contact space
     linkit::real desired_delta_velocity;    // Target velocity change for resolution
 
+    // State at detection time, used to advance the contact analytically between sub-steps
+    linkit::real initial_penetration_depth = 0;
+    std::vector<linkit::Vector3> initial_relative_positions;
+
     CollisionContact(const linkit::Vector3& collision_point, const linkit::Vector3& collision_normal, linkit::real penetration_depth);
     CollisionContact(const linkit::Vector3& collision_point, const linkit::Vector3& collision_normal,
                      linkit::real penetration_depth, const ContactFeature& feature);
@@ -5,6 +5,7 @@
 #include "linkit/linkit.h"
 
 #include "vectra/physics/collision_contact.h"
+#include "vectra/physics/physics_world.h"
 
 
 class GameObject;
@@ -17,12 +18,13 @@ class CollisionData
         [[nodiscard]] const std::vector<CollisionContact>& get_contacts() const;
         void set_objects(GameObject* obj1, GameObject* obj2);
         void set_restitution(linkit::real restitution_value);
-        [[nodiscard]] bool has_duplicate_contact(const CollisionContact& contact, linkit::real tolerance = 0.01f) const;
+        [[nodiscard]] bool has_duplicate_contact(const CollisionContact& contact, linkit::real tolerance = static_cast<linkit::real>(0.01)) const;
 
         GameObject* objects[2] = {nullptr, nullptr};
+        BodyHandle bodies[2] = {INVALID_BODY_HANDLE, INVALID_BODY_HANDLE};
         bool valid = false;
-        linkit::real restitution = 0.3f;
-        linkit::real friction_coefficient = 0.4f;  // Default friction coefficient
+        linkit::real restitution = static_cast<linkit::real>(0.3);
+        linkit::real friction_coefficient = static_cast<linkit::real>(0.4);  // Default friction coefficient
         std::vector<CollisionContact> contacts;
 };
 
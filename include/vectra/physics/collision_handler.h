@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <array>
+#include <cstdint>
 
 #include "vectra/physics/BVHNode.h"
 #include "vectra/physics/collision_contact.h"
@@ -18,29 +19,116 @@ class CollisionHandler
         CollisionHandler();
 
         void add_collision(const CollisionData& collision);
-        void narrow_phase(const std::vector<PotentialContact>& potential_contacts);
+        // With continuous collision, fast pairs are left to continuous_phase unless sweep_fast_pairs is false.
+        // Callers that never run continuous_phase pass false so those pairs still get a discrete test
+        void narrow_phase(const std::vector<PotentialContact>& potential_contacts, const PhysicsWorld& world,
+                          bool sweep_fast_pairs = true);
 
         CollisionData solve_collision(ColliderPrimitive& first, ColliderPrimitive& second);
         static CollisionData solve_sphere_sphere(const ColliderSphere& first, const ColliderSphere& second);
         static CollisionData solve_box_box(ColliderBox& first, ColliderBox& second);
         static CollisionData solve_sphere_box(ColliderSphere& sphere, ColliderBox& box);
-        void solve_contacts();
-        void resolve_interpretations();
+        // Radius of the largest sphere inside the collider, the thinnest thing a body can tunnel through
+        static linkit::real core_radius(const ColliderPrimitive& collider);
+
+        struct ShapeDistance
+        {
+            linkit::real distance; // Negative when overlapping
+            linkit::Vector3 normal; // From the first shape to the second
+            linkit::Vector3 point;
+        };
+
+        struct BoxAxes
+        {
+            std::array<linkit::Vector3, 3> axes;
+            linkit::Vector3 center;
+        };
+        static BoxAxes get_box_axes(const Transform& tf);
+
+        static ShapeDistance sphere_box_distance(const linkit::Vector3& center, linkit::real radius,
+                                                 const ColliderBox& box, const linkit::Vector3& box_position);
+        // For many spheres against one box, with its axes computed once. The box sits at box_axes.center
+        static ShapeDistance sphere_box_distance(const linkit::Vector3& center, linkit::real radius,
+                                                 const BoxAxes& box_axes, const linkit::Vector3& half_sizes);
+        void solve_contacts(PhysicsWorld& world);
+        // Iterative penetration resolution, deepest contact first
+        void resolve_interpretations(PhysicsWorld& world);
         void clear_contacts();
 
+        // Sub-stepping: contacts are detected once per tick and advanced from body motion afterwards
+        void cache_contact_state(const PhysicsWorld& world);
+        void update_contact_separation(const PhysicsWorld& world);
+
+        // Continuous collision: fast pairs are checked for a time of impact along their swept path. Each body
+        // moves back once, to its earliest impact, and the contacts of the bodies moved are found again
+        void continuous_phase(PhysicsWorld& world);
+
         std::vector<CollisionData> collisions;
 
+        bool continuous_collision = false;
+        // Relative motion in one step, as a fraction of the smaller body's core radius, above which a pair is swept
+        linkit::real ccd_motion_threshold = static_cast<linkit::real>(0.5);
+
+        // Penetration resolution budget (iterations = contacts * position_iterations_per_contact) and tolerance
+        int position_iterations_per_contact = 4;
+        linkit::real position_epsilon = static_cast<linkit::real>(0.001);
+
     private:
+        struct ContactRef
+        {
+            std::size_t collision;
+            std::size_t contact;
+        };
 
-        // Helper structures for box-box collision
-        struct BoxAxes
+        // Scratch buffers for resolve_interpretations, kept to avoid reallocating every step
+        std::vector<ContactRef> contact_refs_;
+        std::vector<std::size_t> body_contact_offsets_;
+        std::vector<std::size_t> body_contact_cursor_;
+        std::vector<std::size_t> body_contacts_;
+
+        // A contact's penetration when it was queued. Stale once the contact has moved on
+        struct QueuedPenetration
         {
-            std::array<linkit::Vector3, 3> axes;
-            linkit::Vector3 center;
+            linkit::real penetration;
+            std::size_t contact; // Index into contact_refs_
         };
+        // Max-heap of contacts deeper than position_epsilon. Deepest first, lowest index on ties
+        std::vector<QueuedPenetration> deepest_contacts_;
+
+        // Runs the shape test for a pair at its current pose. Leaves the handler untouched, so pairs can be tested in parallel
+        CollisionData test_discrete(GameObject* first, GameObject* second, const PhysicsWorld& world);
+        // Same, and records any contacts
+        void detect_discrete(GameObject* first, GameObject* second, const PhysicsWorld& world);
+
+        // Narrow phase scratch, one slot per broad phase pair
+        std::vector<std::uint8_t> pair_outcomes_;
+        std::vector<CollisionData> pair_results_;
+
+        // Fast pairs from the broad phase, tested by continuous_phase instead of the discrete narrow phase
+        std::vector<PotentialContact> ccd_candidates_;
+        // continuous_phase scratch: whether each candidate has an impact, each body's earliest impact, and the bodies moved back
+        std::vector<std::uint8_t> ccd_pair_hits_;
+        std::vector<linkit::real> ccd_body_toi_;
+        std::vector<std::uint8_t> ccd_rewound_;
+
+        // Distance between two colliders placed at the given positions (orientations are taken as they are now)
+        static ShapeDistance shape_distance(const ColliderPrimitive& first, const linkit::Vector3& first_position,
+                                            const ColliderPrimitive& second, const linkit::Vector3& second_position);
+        // Relative motion this step is large enough to skip over the thinner body's core
+        [[nodiscard]] bool is_fast_pair(const PotentialContact& pair, const PhysicsWorld& world) const;
+        // Conservative advancement along both bodies' linear motion this step
+        [[nodiscard]] bool time_of_impact(const PotentialContact& pair, const PhysicsWorld& world,
+                                          linkit::real& toi, ShapeDistance& hit) const;
+
+        // Moves the bodies of one contact out of penetration and reports how far each one moved
+        static bool apply_position_change(PhysicsWorld& world, const CollisionData& collision, const CollisionContact& contact,
+                                          linkit::Vector3 linear_change[2], linkit::Vector3 angular_change[2]);
+
+        // Body poses when cache_contact_state was called
+        std::vector<linkit::Vector3> cached_positions_;
+        std::vector<linkit::Quaternion> cached_orientations_;
 
         // Multi-point contact generation helpers
-        static BoxAxes get_box_axes(const Transform& tf);
         static void generate_face_contacts(
             ColliderBox& reference_box,
             ColliderBox& incident_box,
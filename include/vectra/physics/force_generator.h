@@ -3,15 +3,67 @@
 
 #include <vector>
 #include "vectra/core/gameobject.h"
+#include "vectra/physics/physics_world.h"
+
+// Built-in generators the ForceRegistry evaluates in type batches rather than one virtual call per body
+enum class ForceGeneratorKind
+{
+    CUSTOM,
+    SIMPLE_GRAVITY,
+    ANCHORED_SPRING,
+    OBJECT_ANCHORED_SPRING
+};
+
+class ForceGenerator;
+
+/**
+ * Where generators add their forces during the force stage: either the world's own accumulators or a
+ * per-thread buffer that ForceRegistry reduces into them afterwards.
+ */
+struct ForceAccumulator
+{
+    linkit::Vector3* forces;
+    linkit::Vector3* torques;
+    const linkit::Vector3* positions; // Body positions, for the lever arm in add_force_at_world_point
+
+    void add_force(const BodyHandle body, const linkit::Vector3& force)
+    {
+        forces[body] += force;
+    }
+
+    void add_force_at_world_point(const BodyHandle body, const linkit::Vector3& force, const linkit::Vector3& point)
+    {
+        forces[body] += force;
+        torques[body] += (point - positions[body]) % force;
+    }
+};
+
+// A generator together with one body it acts on
+struct ForceBinding
+{
+    ForceGenerator* generator;
+    BodyHandle body;
+};
 
 class ForceGenerator
 {
 public:
     virtual ~ForceGenerator() = default;
     /**
-     * Calculates and applies the force to the given GameObject.
+     * Called once per physics step before any update_force, however many bodies share this generator.
+     * Per-step state the generator needs is built here, on a single thread.
+     */
+    virtual void prepare(const PhysicsWorld& world, linkit::real dt) {}
+    /**
+     * Calculates the force on the given body and adds it to the accumulator. The world is frozen for the
+     * whole force stage, and calls for different bodies may run concurrently on several threads.
+     */
+    virtual void update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, BodyHandle body, linkit::real dt) const = 0;
+    /**
+     * Anything other than CUSTOM promises the generator is exactly that built-in type, so the registry
+     * may evaluate it through the type's static update_batch instead of update_force.
      */
-    virtual void update_force(GameObject& obj, linkit::real dt) = 0;
+    [[nodiscard]] virtual ForceGeneratorKind kind() const { return ForceGeneratorKind::CUSTOM; }
 };
 
-#endif //VECTRA_FORCE_GENERATOR_H
\ No newline at end of file
+#endif //VECTRA_FORCE_GENERATOR_H
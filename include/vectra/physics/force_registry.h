@@ -12,17 +12,43 @@ protected:
     struct ForceRegistration
     {
         GameObject* obj;
+        BodyHandle body;
         std::shared_ptr<ForceGenerator> force_generator;
     };
 
+    // Registrations split by ForceGeneratorKind, rebuilt by update_forces after add, remove or clear
+    bool batches_dirty_ = true;
+    std::vector<ForceGenerator*> unique_generators_; // In first-registration order, each prepared once per step
+    std::vector<ForceBinding> simple_gravity_batch_; // Bindings of one generator are contiguous
+    std::vector<ForceBinding> anchored_spring_batch_;
+    std::vector<ForceBinding> object_anchored_spring_batch_;
+    std::vector<ForceBinding> custom_batch_; // Registration order, one virtual update_force each
+
+    // Per-thread accumulators for the parallel force stage, [thread][body]. Thread 0 adds straight into the world
+    std::vector<std::vector<linkit::Vector3>> thread_forces_;
+    std::vector<std::vector<linkit::Vector3>> thread_torques_;
+
+    void rebuild_batches();
+    // Evaluates share `thread_index` of thread_count of every batch
+    void evaluate_share(const PhysicsWorld& world, ForceAccumulator& accumulator, std::size_t thread_index,
+                        std::size_t thread_count, linkit::real dt) const;
+
+    // Per-body index, kept up to date by add, remove and clear
+    std::vector<std::vector<std::shared_ptr<ForceGenerator>>> body_forces_; // [body], in registration order
+    std::vector<ForceGenerator*> spring_slots_; // [body], first spring registered on the body or nullptr
+
+    void refresh_spring_slot(BodyHandle body);
+
 
 public:
-    std::vector<ForceRegistration> registered_forces;
+    std::vector<ForceRegistration> registered_forces; // Read only, change it through add, remove and clear
     void add(GameObject* obj, std::shared_ptr<ForceGenerator> force_generator);
     void remove(GameObject* obj, std::shared_ptr<ForceGenerator> force_generator);
     std::vector<std::shared_ptr<ForceGenerator>> object_forces(GameObject* obj) const;
+    // Anchor of the first spring acting on the body, without scanning the registrations. False if there is none
+    bool spring_anchor(BodyHandle body, linkit::Vector3& anchor) const;
     void clear();
-    void update_forces(linkit::real dt);
+    void update_forces(PhysicsWorld& world, linkit::real dt);
 };
 
-#endif //VECTRA_FORCE_REGISTRY_H
\ No newline at end of file
+#endif //VECTRA_FORCE_REGISTRY_H
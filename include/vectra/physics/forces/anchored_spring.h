@@ -4,8 +4,22 @@
 #include "linkit/linkit.h"
 #include "vectra/physics/force_generator.h"
 
+// Hooke's law along the line from the anchor to the body. Shared by both spring generators
+inline linkit::Vector3 spring_force(const linkit::Vector3& position, const linkit::Vector3& anchor,
+                                    const linkit::real spring_constant, const linkit::real rest_length)
+{
+    linkit::Vector3 force = position;
+    force -= anchor;
+
+    linkit::real magnitude = force.magnitude();
+    magnitude = (rest_length - magnitude) * spring_constant;
+
+    force.normalize();
+    force *= magnitude;
+    return force;
+}
 
-class AnchoredSpring : public ForceGenerator
+class AnchoredSpring final : public ForceGenerator
 {
 public:
     linkit::Vector3 anchor_point;
@@ -13,7 +27,10 @@ public:
     linkit::real rest_length;
     linkit::real damping;
     explicit AnchoredSpring(const linkit::Vector3& anchor_point, linkit::real spring_constant, linkit::real rest_length, linkit::real damping);
-    void update_force(GameObject& obj, linkit::real dt) override;
+    void update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, BodyHandle body, linkit::real dt) const override;
+    [[nodiscard]] ForceGeneratorKind kind() const override { return ForceGeneratorKind::ANCHORED_SPRING; }
+    // Every binding must hold an AnchoredSpring
+    static void update_batch(const PhysicsWorld& world, ForceAccumulator& accumulator, const ForceBinding* bindings, std::size_t count);
     [[nodiscard]] linkit::Vector3 get_anchor_point() const;
 };
 
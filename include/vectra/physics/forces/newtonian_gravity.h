@@ -1,10 +1,19 @@
 #ifndef VECTRA_NEWTONIAN_GRAVITY_H
 #define VECTRA_NEWTONIAN_GRAVITY_H
 
+#include <cstdint>
+#include <vector>
 
 #include "linkit/linkit.h"
 #include "vectra/physics/force_generator.h"
 
+enum class GravityMethod
+{
+    PER_BODY,   // Each registered body sums over affected_objects on its own
+    ALL_PAIRS,  // Exact sum, every pair evaluated once per step using Newton's third law
+    BARNES_HUT  // Distant groups of bodies act through their centre of mass, O(N log N)
+};
+
 class NewtonianGravity : public ForceGenerator
 {
 
@@ -13,10 +22,55 @@ public:
     std::vector<GameObject*> affected_objects;
     linkit::real gravitational_constant;
     linkit::real cero_mass_substitute = 0.0f; // Substitute mass for objects with zero mass
-    explicit NewtonianGravity(linkit::real g_const = 6.67e-11);
-    explicit NewtonianGravity(std::vector<GameObject*> game_objects, linkit::real g_const = 6.67e-11);
-    void update_force(GameObject& obj, linkit::real dt) override;
+
+    GravityMethod method = GravityMethod::PER_BODY;
+    linkit::real opening_angle = static_cast<linkit::real>(0.5); // Barnes-Hut: a cell of size s at distance d is opened while s / d >= opening_angle
+    linkit::real softening = 0; // ALL_PAIRS and BARNES_HUT: added in quadrature to every distance to tame close encounters
+
+    explicit NewtonianGravity(linkit::real g_const = static_cast<linkit::real>(6.67e-11));
+    explicit NewtonianGravity(std::vector<GameObject*> game_objects, linkit::real g_const = static_cast<linkit::real>(6.67e-11));
+    // ALL_PAIRS and BARNES_HUT evaluate the force on every affected body here, once per step
+    void prepare(const PhysicsWorld& world, linkit::real dt) override;
+    void update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, BodyHandle body, linkit::real dt) const override;
+
+private:
+    struct Source
+    {
+        linkit::Vector3 position;
+        linkit::real mass;
+        BodyHandle body;
+    };
+
+    struct OctreeNode
+    {
+        linkit::Vector3 center; // Centre of the cubic cell
+        linkit::real half_size;
+        linkit::Vector3 center_of_mass;
+        linkit::real mass;
+        std::uint32_t first; // Sources in this cell are sources_[first, first + count)
+        std::uint32_t count;
+        std::int32_t children[8]; // -1 when the octant is empty or the node is a leaf
+    };
+
+    std::vector<Source> sources_; // Barnes-Hut reorders these so every cell covers a contiguous range
+    std::vector<OctreeNode> nodes_; // nodes_[0] is the root
+    std::vector<linkit::Vector3> cached_forces_; // Per source, filled by prepare
+    std::vector<std::int32_t> cached_index_; // BodyHandle -> index into cached_forces_, -1 if not a source
+
+    // All-pairs kernel inputs and per-thread accumulators, structure of arrays
+    std::vector<linkit::real> pair_x_, pair_y_, pair_z_;
+    std::vector<linkit::real> pair_source_mass_;
+    std::vector<std::vector<linkit::real>> thread_accelerations_; // [thread][3 * body], without G
+
+    void prepare_all_pairs(const PhysicsWorld& world);
+    void prepare_barnes_hut(const PhysicsWorld& world);
+    // Accumulates every pair whose first body is in rows first_row, first_row + stride, ...
+    void all_pairs_rows(std::size_t first_row, std::size_t stride, linkit::real* accelerations) const;
+
+    std::int32_t build_node(std::uint32_t first, std::uint32_t count, const linkit::Vector3& center, linkit::real half_size, int depth);
+    // Gravitational acceleration at a point, skipping the contribution of `body` itself
+    [[nodiscard]] linkit::Vector3 barnes_hut_field(const linkit::Vector3& position, BodyHandle body) const;
 };
 
 
-#endif //VECTRA_NEWTONIAN_GRAVITY_H
\ No newline at end of file
+#endif //VECTRA_NEWTONIAN_GRAVITY_H
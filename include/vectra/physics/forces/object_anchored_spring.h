@@ -7,7 +7,7 @@
 #include "vectra/physics/force_generator.h"
 
 
-class ObjectAnchoredSpring : public ForceGenerator
+class ObjectAnchoredSpring final : public ForceGenerator
 {
 protected:
 
@@ -18,7 +18,10 @@ public:
     linkit::real damping;
 
     explicit ObjectAnchoredSpring(GameObject* anchor_object, linkit::real spring_constant, linkit::real rest_length, linkit::real damping);
-    void update_force(GameObject& obj, linkit::real dt) override;
+    void update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, BodyHandle body, linkit::real dt) const override;
+    [[nodiscard]] ForceGeneratorKind kind() const override { return ForceGeneratorKind::OBJECT_ANCHORED_SPRING; }
+    // Every binding must hold an ObjectAnchoredSpring
+    static void update_batch(const PhysicsWorld& world, ForceAccumulator& accumulator, const ForceBinding* bindings, std::size_t count);
     [[nodiscard]] linkit::Vector3 get_anchor_point() const;
 };
 
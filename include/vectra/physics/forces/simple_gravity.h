@@ -4,15 +4,18 @@
 #include "linkit/linkit.h"
 #include "vectra/physics/force_generator.h"
 
-class SimpleGravity : public ForceGenerator
+class SimpleGravity final : public ForceGenerator
 {
 
 
 public:
     linkit::Vector3 gravitational_field;
-    explicit SimpleGravity(linkit::real acceleration = -9.81);
-    explicit SimpleGravity(const linkit::Vector3& field = linkit::Vector3(0, -9.81, 0));
-    void update_force(GameObject& obj, linkit::real dt) override;
+    explicit SimpleGravity(linkit::real acceleration = static_cast<linkit::real>(-9.81));
+    explicit SimpleGravity(const linkit::Vector3& field = linkit::Vector3(0, static_cast<linkit::real>(-9.81), 0));
+    void update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, BodyHandle body, linkit::real dt) const override;
+    [[nodiscard]] ForceGeneratorKind kind() const override { return ForceGeneratorKind::SIMPLE_GRAVITY; }
+    // Every binding must hold a SimpleGravity. The field is reloaded only when the generator changes
+    static void update_batch(const PhysicsWorld& world, ForceAccumulator& accumulator, const ForceBinding* bindings, std::size_t count);
 };
 
 #endif //VECTRA_SIMPLE_GRAVITY_H
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef VECTRA_PARALLEL_H
+#define VECTRA_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "vectra/core/job_system.h"
+
+// Threads worth using for `items` units of work, given the fewest items that repay handing work to another thread
+inline std::size_t worker_count(const std::size_t items, const std::size_t min_items_per_thread)
+{
+    const std::size_t threads = JobSystem::instance().thread_count();
+    return std::max<std::size_t>(1, std::min(threads, items / min_items_per_thread));
+}
+
+// Calls function(thread_index) once for every index in [0, thread_count) on the job system
+template <class Function>
+void run_on_threads(const std::size_t thread_count, const Function& function)
+{
+    JobSystem::instance().parallel_for(thread_count, 1, function);
+}
+
+// Calls function(i) for every i in [0, count) on the job system. The work is split into a few ranges per
+// thread so that threads finishing early can take over the rest
+template <class Function>
+void parallel_for(const std::size_t count, const std::size_t min_items_per_thread, const Function& function)
+{
+    const std::size_t thread_count = worker_count(count, min_items_per_thread);
+    if (thread_count == 1)
+    {
+        for (std::size_t i = 0; i < count; i++) function(i);
+        return;
+    }
+    JobSystem::instance().parallel_for(count, count / (4 * thread_count), function);
+}
+
+#endif //VECTRA_PARALLEL_H
@@ -0,0 +1,104 @@
+#ifndef VECTRA_PARTICLE_SYSTEM_H
+#define VECTRA_PARTICLE_SYSTEM_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "linkit/linkit.h"
+#include "vectra/core/gameobject.h"
+#include "vectra/physics/bounding_volumes/bounding_sphere.h"
+#include "vectra/physics/collision_handler.h"
+
+// Spawns particles into a ParticleSystem
+struct ParticleEmitter
+{
+    linkit::Vector3 position = linkit::Vector3(0, 0, 0);
+    linkit::Vector3 direction = linkit::Vector3(0, 1, 0); // Mean launch direction, need not be normalized
+    linkit::real spread = static_cast<linkit::real>(0.2); // Random part of the launch direction, relative to direction
+    linkit::real speed = 5;
+    linkit::real rate = 100; // Particles per second
+    int burst = 0; // Particles emitted at once on the first step
+    linkit::real lifetime = 5; // Seconds, 0 or less lives forever
+    linkit::real radius = static_cast<linkit::real>(0.05);
+    linkit::real mass = static_cast<linkit::real>(0.01);
+
+    linkit::real pending = 0; // Fraction of a particle carried over to the next step
+    bool burst_done = false;
+};
+
+/**
+ * Many small spheres that only need a position, velocity, radius, mass and lifetime.
+ * Kept as structure of arrays and stepped in batches, without the Rigidbody, collider, BVH leaf and
+ * snapshot strings every GameObject carries. Particles bounce off rigid bodies without pushing them.
+ * They can also collide with each other through a spatial hash.
+ */
+class ParticleSystem
+{
+public:
+    std::string name;
+    std::vector<ParticleEmitter> emitters;
+
+    // Live particles, structure of arrays. Dead particles are swapped with the last one and dropped
+    std::vector<linkit::Vector3> positions;
+    std::vector<linkit::Vector3> velocities;
+    std::vector<linkit::real> radii;
+    std::vector<linkit::real> masses;
+    std::vector<linkit::real> lifetimes; // Seconds left
+
+    std::size_t max_particles = 100000; // Emitters stop while the system is full
+    linkit::Vector3 gravity = linkit::Vector3(0, static_cast<linkit::real>(-9.81), 0);
+    linkit::real drag = 0; // Fraction of velocity lost per second
+    linkit::real restitution = static_cast<linkit::real>(0.5); // Bounciness against rigid bodies and other particles
+    linkit::real friction = static_cast<linkit::real>(0.1); // Fraction of sliding velocity removed on contact with a rigid body
+    bool collide_particles = false;
+    std::uint32_t seed; // Of the emitters' random launch directions, read only
+
+    explicit ParticleSystem(std::uint32_t seed = 0);
+
+    void emit(const linkit::Vector3& position, const linkit::Vector3& velocity, linkit::real radius,
+              linkit::real mass, linkit::real lifetime);
+
+    // A step is advance, then collide with the rigid bodies whose volumes overlap bounds()
+    void advance(linkit::real dt);
+    void collide(const std::vector<GameObject*>& colliders);
+    // Sphere around every particle, as of the last advance
+    [[nodiscard]] const BoundingSphere& bounds() const;
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    std::mt19937 random_;
+    BoundingSphere bounds_ = BoundingSphere(linkit::Vector3(0, 0, 0), 0);
+
+    // Rigid bodies touching the particles this step, resolved once instead of per particle
+    struct RigidCollider
+    {
+        bool is_sphere; // Otherwise a box
+        linkit::real radius; // Of the sphere, or of a sphere around the box
+        CollisionHandler::BoxAxes frame; // Collider position, and axes for a box
+        linkit::Vector3 half_sizes;
+    };
+    std::vector<RigidCollider> colliders_;
+
+    // Spatial hash, particles sorted by bucket: bucket b holds sorted_[bucket_start_[b], bucket_start_[b + 1])
+    std::vector<std::uint32_t> bucket_of_;
+    std::vector<std::uint32_t> bucket_start_;
+    std::vector<std::uint32_t> sorted_;
+    std::vector<linkit::Vector3> position_changes_, velocity_changes_;
+
+    // Rigid collision reuses bucket_of_ with coarser cells: box around each bucket's particles, and the colliders
+    // overlapping it. Bucket b tests colliders_[bucket_colliders_[k]] for k in [bucket_collider_start_[b], bucket_collider_start_[b + 1])
+    std::vector<linkit::Vector3> bucket_low_, bucket_high_;
+    std::vector<std::uint32_t> bucket_collider_start_;
+    std::vector<std::uint32_t> bucket_colliders_;
+
+    void run_emitters(linkit::real dt);
+    void remove_dead(linkit::real dt);
+    void integrate(linkit::real dt);
+    void collide_with_particles();
+    void collide_with_rigid_bodies();
+    void bounce_off(std::size_t particle, const RigidCollider& collider);
+};
+
+#endif //VECTRA_PARTICLE_SYSTEM_H
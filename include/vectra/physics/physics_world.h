@@ -0,0 +1,73 @@
+#ifndef VECTRA_PHYSICS_WORLD_H
+#define VECTRA_PHYSICS_WORLD_H
+
+#include <cstdint>
+#include <vector>
+
+#include "linkit/linkit.h"
+#include "vectra/physics/rigidbody.h"
+#include "vectra/physics/transform.h"
+
+// Index of a body inside a PhysicsWorld. Stays valid for the lifetime of the world.
+using BodyHandle = std::uint32_t;
+constexpr BodyHandle INVALID_BODY_HANDLE = UINT32_MAX;
+
+/**
+ * Structure-of-arrays store for the simulated state of every rigid body in a scene.
+ * Integration, force accumulation and the contact solver iterate these arrays directly
+ * instead of walking GameObjects. Rigidbody is only used to describe a body when it is added.
+ */
+class PhysicsWorld
+{
+    public:
+        std::vector<linkit::Vector3> positions;
+        std::vector<linkit::Vector3> previous_positions; // Positions before the last integrate, for swept collision
+        std::vector<linkit::Quaternion> orientations;
+        std::vector<linkit::Vector3> velocities;
+        std::vector<linkit::Vector3> angular_velocities;
+        std::vector<linkit::Vector3> accumulated_forces;
+        std::vector<linkit::Vector3> accumulated_torques;
+        std::vector<linkit::real> masses;
+        std::vector<linkit::real> inverse_masses;
+        std::vector<linkit::Matrix3> local_inverse_inertia_tensors;
+        std::vector<linkit::Matrix3> inverse_inertia_tensors; // World space, refreshed once per step by integrate
+        std::vector<std::uint8_t> has_moved; // uint8_t rather than vector<bool> so entries are addressable
+
+        // Sleeping: bodies whose averaged motion stays below sleep_epsilon stop being integrated
+        std::vector<std::uint8_t> is_awake;
+        std::vector<linkit::real> motion;
+        std::vector<linkit::Vector3> sleep_forces; // Accumulated force when the body fell asleep
+        bool allow_sleeping = true;
+        linkit::real sleep_epsilon = static_cast<linkit::real>(0.01);
+
+        // Dynamic, awake bodies in handle order. Rebuilt by integrate
+        std::vector<BodyHandle> active_bodies;
+
+        BodyHandle add_body(const Rigidbody& rb);
+        [[nodiscard]] std::size_t size() const;
+        void clear();
+
+        void clear_accumulators();
+        void add_force(BodyHandle body, const linkit::Vector3& force);
+        // Will add a torque based on force applied at a point in world space
+        void add_force_at_world_point(BodyHandle body, const linkit::Vector3& force, const linkit::Vector3& point);
+
+        [[nodiscard]] bool has_finite_mass(BodyHandle body) const;
+        [[nodiscard]] linkit::Matrix3 inverse_inertia_tensor(BodyHandle body) const;
+
+        void set_awake(BodyHandle body, bool awake);
+        void integrate(linkit::real dt);
+        // Averages each active body's motion and puts slow bodies to sleep. Call after contacts are solved
+        void update_sleep_states(linkit::real dt);
+
+        // Copies the simulated pose into a transform (scale is left untouched)
+        void write_pose(BodyHandle body, Transform& transform) const;
+        // Copies the simulated state back into a Rigidbody description, e.g. before serialising
+        void read_body(BodyHandle body, Rigidbody& rb) const;
+
+    private:
+        void build_active_list();
+        void integrate_batch(const BodyHandle* bodies, std::size_t count, linkit::real dt);
+};
+
+#endif //VECTRA_PHYSICS_WORLD_H
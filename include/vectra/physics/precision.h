@@ -0,0 +1,26 @@
+#ifndef VECTRA_PRECISION_H
+#define VECTRA_PRECISION_H
+
+#include <limits>
+#include <type_traits>
+
+#include "linkit/linkit.h"
+
+// The float and double builds (VECTRA_BUILD_PRECISION_VARIANTS) define VECTRA_DOUBLE_PRECISION to 0 or 1.
+// Catch a linkit that ignored the requested precision instead of silently building the wrong one.
+#ifdef VECTRA_DOUBLE_PRECISION
+static_assert(std::is_same_v<linkit::real, double> == static_cast<bool>(VECTRA_DOUBLE_PRECISION),
+              "linkit::real does not match the precision this target was configured for");
+#endif
+
+constexpr bool REAL_IS_DOUBLE = std::is_same_v<linkit::real, double>;
+constexpr const char* REAL_PRECISION_NAME = REAL_IS_DOUBLE ? "double" : "float";
+
+// Initial value for minimum searches
+constexpr linkit::real REAL_MAX = std::numeric_limits<linkit::real>::max();
+
+// Below this, products of unit-scale directions are treated as parallel or degenerate.
+// Kept a few orders of magnitude above the rounding noise of linkit::real
+constexpr linkit::real PARALLEL_TOLERANCE = REAL_IS_DOUBLE ? static_cast<linkit::real>(1e-10) : static_cast<linkit::real>(1e-6);
+
+#endif //VECTRA_PRECISION_H
@@ -9,10 +9,11 @@
 #include "linkit/linkit.h"
 
 
+// Describes a body's initial state and mass properties. Once added to a Scene the simulated
+// state lives in the scene's PhysicsWorld and only the transform is mirrored back here.
 class Rigidbody
 {
     public:
-        bool has_moved;
         Transform transform;
         linkit::Vector3 velocity;
         linkit::Vector3 acceleration;
@@ -20,12 +21,6 @@ class Rigidbody
         linkit::Vector3 angular_velocity;
         linkit::Vector3 angular_acceleration;
 
-        linkit::Vector3 accumulated_force;
-        linkit::Vector3 accumulated_torque;
-
-        // Stores the acceleration from the previous frame for resting contact handling
-        linkit::Vector3 last_frame_acceleration;
-
         linkit::real mass;
         linkit::real inverse_mass;
         linkit::Matrix3 _local_inverse_inertia_tensor;
@@ -34,21 +29,12 @@ class Rigidbody
 
 
         Rigidbody();
-        void clear_accumulators();
 
         linkit::Matrix4 transform_matrix();
         linkit::Matrix4 inverse_transform_matrix();
         linkit::Vector3 local_to_world(const linkit::Vector3& local_point);
         linkit::Vector3 world_to_local(const linkit::Vector3& world_point);
         [[nodiscard]] linkit::Matrix3 get_inverse_inertia_tensor() const;
-        void add_force(const linkit::Vector3& force);
-        // Will add a torque based on force applied at a point in world space
-        void add_force_at_world_point(const linkit::Vector3& force, const linkit::Vector3& point);
-        void add_force_at_local_point(const linkit::Vector3& force, const linkit::Vector3& point);
-        void compute_accelerations();
-        void step_rotation(linkit::real dt);
-        void step_position(linkit::real dt);
-        void step(linkit::real dt);
         [[nodiscard]] bool has_finite_mass() const;
         [[nodiscard]] bool has_infinite_mass() const;
         [[nodiscard]] linkit::Matrix3 cuboid_inertia_tensor() const;
@@ -0,0 +1,120 @@
+#ifndef VECTRA_SOFT_BODY_H
+#define VECTRA_SOFT_BODY_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "linkit/linkit.h"
+#include "vectra/core/gameobject.h"
+#include "vectra/physics/bounding_volumes/bounding_sphere.h"
+#include "vectra/physics/collision_handler.h"
+
+enum class SoftBodyShape
+{
+    CLOTH, // Sheet of resolution[0] x resolution[1] particles in the XZ plane
+    BLOCK  // Lattice of resolution[0] x resolution[1] x resolution[2] particles, filled with tetrahedra
+};
+
+// What a soft body is built from, kept so it can be saved again
+struct SoftBodyDescription
+{
+    SoftBodyShape shape = SoftBodyShape::CLOTH;
+    linkit::Vector3 origin = linkit::Vector3(0, 0, 0); // Centre of the rest shape
+    std::array<int, 3> resolution = {16, 16, 1}; // Particles along each axis
+    linkit::real spacing = static_cast<linkit::real>(0.1); // Rest distance between neighbouring particles
+    linkit::real particle_mass = static_cast<linkit::real>(0.01);
+    std::vector<std::uint32_t> pinned; // Particles held in place
+};
+
+struct DistanceConstraint
+{
+    std::uint32_t particles[2];
+    linkit::real rest_length;
+};
+
+struct VolumeConstraint
+{
+    std::uint32_t particles[4];
+    linkit::real rest_volume; // Six times the signed volume of the tetrahedron
+};
+
+/**
+ * Point masses held together by constraints and simulated with extended position based dynamics (XPBD),
+ * for cloth and soft bodies that would be far too heavy as one GameObject per particle.
+ * Each step is split into small substeps of one constraint pass each.
+ * Within a constraint type the constraints are coloured so that no two of the same colour share a particle.
+ * A colour can then be projected in parallel, while colours run one after another as in Gauss-Seidel.
+ * Rigid bodies push particles out but are not pushed back.
+ */
+class SoftBody
+{
+public:
+    std::string name;
+    SoftBodyDescription description;
+
+    // Particles, structure of arrays
+    std::vector<linkit::Vector3> positions;
+    std::vector<linkit::Vector3> previous_positions; // At the start of the current substep
+    std::vector<linkit::Vector3> velocities;
+    std::vector<linkit::real> inverse_masses; // 0 for pinned particles
+
+    // Rendered surface, three particle indices per triangle. Never changes, so snapshots share it
+    std::shared_ptr<const std::vector<std::uint32_t>> triangles;
+
+    // Reordered by colour when the body is built
+    std::vector<DistanceConstraint> stretch_constraints; // Along every edge
+    std::vector<DistanceConstraint> bending_constraints; // Between the far corners of triangles sharing an edge
+    std::vector<VolumeConstraint> volume_constraints; // BLOCK only
+
+    // Compliance is inverse stiffness, 0 is infinitely stiff
+    linkit::real stretch_compliance = 0;
+    linkit::real bending_compliance = static_cast<linkit::real>(1e-4);
+    linkit::real volume_compliance = 0;
+    linkit::real damping = static_cast<linkit::real>(0.1); // Fraction of velocity lost per second
+    linkit::real friction = static_cast<linkit::real>(0.3); // Fraction of sliding removed while touching a rigid body
+    linkit::real particle_radius = static_cast<linkit::real>(0.02);
+    linkit::Vector3 gravity = linkit::Vector3(0, static_cast<linkit::real>(-9.81), 0);
+    int substeps = 10;
+
+    explicit SoftBody(const SoftBodyDescription& description);
+
+    // colliders are the rigid bodies that may touch the soft body this step, e.g. from BVH::query
+    void step(linkit::real dt, const std::vector<GameObject*>& colliders);
+    // Sphere holding every particle now and after a step of dt, for the broad phase
+    [[nodiscard]] BoundingSphere swept_bounds(linkit::real dt) const;
+    [[nodiscard]] std::size_t particle_count() const;
+
+private:
+    // Colour c of a constraint type is the range [colours[c], colours[c + 1]). The last colour holds
+    // constraints that did not fit in the first 64 and is projected on one thread
+    std::vector<std::size_t> stretch_colours_;
+    std::vector<std::size_t> bending_colours_;
+    std::vector<std::size_t> volume_colours_;
+
+    // Rigid bodies touching the soft body this step, resolved once instead of per particle
+    struct RigidCollider
+    {
+        bool is_sphere; // Otherwise a box
+        linkit::real radius; // Of the sphere, or of a sphere around the box
+        CollisionHandler::BoxAxes frame; // Collider position, and axes for a box
+        linkit::Vector3 half_sizes;
+    };
+    std::vector<RigidCollider> colliders_;
+
+    std::uint32_t add_particle(const linkit::Vector3& position, linkit::real mass);
+    void build_cloth();
+    void build_block();
+    // Bending constraints across every edge shared by two of the triangles
+    void add_bending(const std::vector<std::uint32_t>& triangle_indices);
+    void colour_constraints();
+
+    void solve_distances(std::vector<DistanceConstraint>& constraints, const std::vector<std::size_t>& colours,
+                         linkit::real compliance, linkit::real h);
+    void solve_volumes(linkit::real h);
+    void solve_collisions();
+};
+
+#endif //VECTRA_SOFT_BODY_H
@@ -0,0 +1,77 @@
+#ifndef VECTRA_SPRING_NETWORK_H
+#define VECTRA_SPRING_NETWORK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "linkit/linkit.h"
+#include "vectra/core/gameobject.h"
+#include "vectra/physics/physics_world.h"
+
+// Damped spring between two bodies, acting on both
+struct NetworkSpring
+{
+    GameObject* first;
+    GameObject* second;
+    linkit::real spring_constant;
+    linkit::real rest_length;
+    linkit::real damping;
+};
+
+/**
+ * Stiff springs solved together as one implicit system instead of as independent force generators.
+ * Each step takes a backward Euler step for every body the springs connect:
+ *   (M - dt * df/dv - 1.5 * dt^2 * df/dx) dv = dt * (f + dt * df/dx * v)
+ * and solves it with Jacobi-preconditioned conjugate gradients. The matrix is never built, its product
+ * with a vector is summed spring by spring.
+ * Stays stable at frame-rate steps for stiffnesses that need many substeps with explicit springs.
+ */
+class SpringNetwork
+{
+public:
+    std::vector<NetworkSpring> springs; // Read only, change it through add and clear
+
+    int max_iterations = 50;
+    linkit::real tolerance = static_cast<linkit::real>(1e-4); // Conjugate gradients stop once the residual falls below tolerance * |rhs|
+
+    void add(GameObject* first, GameObject* second, linkit::real spring_constant, linkit::real rest_length, linkit::real damping);
+    void clear();
+    [[nodiscard]] bool empty() const;
+
+    /**
+     * Call after the force registry and before PhysicsWorld::integrate. Folds the forces already
+     * accumulated on network bodies into the solve, then replaces them with the force that produces
+     * the implicit velocity change through the integrator.
+     */
+    void solve(PhysicsWorld& world, linkit::real dt);
+    [[nodiscard]] int last_iterations() const;
+
+private:
+    // Per-step linearisation of one spring. Its block of the system matrix is
+    // axial * n n^T + lateral * (I - n n^T), added on the diagonal and subtracted off it
+    struct SpringBlock
+    {
+        std::int32_t first; // Unknown index, -1 for a body with infinite mass
+        std::int32_t second;
+        linkit::Vector3 direction;
+        linkit::real axial;
+        linkit::real lateral;
+    };
+
+    bool dirty_ = true;
+    std::vector<BodyHandle> bodies_; // Unknown index -> body, finite mass bodies only
+    std::vector<std::int32_t> unknown_index_; // BodyHandle -> unknown index or -1
+    std::vector<SpringBlock> blocks_;
+    int last_iterations_ = 0;
+
+    // Conjugate gradient state, one entry per unknown. delta_v_ is kept as the next step's first guess
+    std::vector<linkit::Vector3> rhs_, delta_v_, residual_, search_, product_, preconditioned_;
+    std::vector<linkit::Vector3> inverse_diagonal_;
+    std::vector<std::vector<linkit::Vector3>> thread_products_; // [thread][unknown], threads above 0 only
+
+    void rebuild(const PhysicsWorld& world);
+    // out = A * p
+    void multiply(const PhysicsWorld& world, const std::vector<linkit::Vector3>& p, std::vector<linkit::Vector3>& out);
+};
+
+#endif //VECTRA_SPRING_NETWORK_H
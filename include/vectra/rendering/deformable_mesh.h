@@ -0,0 +1,35 @@
+#ifndef VECTRA_DEFORMABLE_MESH_H
+#define VECTRA_DEFORMABLE_MESH_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "linkit/linkit.h"
+
+#include "vectra/rendering/shader.h"
+#include "vectra/rendering/texture.h"
+#include "vectra/rendering/vertex.h"
+
+/**
+ * Mesh whose vertices move every frame, such as a soft body's surface. Drawn in one call from a
+ * dynamic vertex buffer that is refilled by update(); normals are recomputed from the triangles.
+ */
+class DeformableMesh {
+    public:
+        DeformableMesh();
+        ~DeformableMesh();
+        DeformableMesh(const DeformableMesh&) = delete;
+        DeformableMesh& operator=(const DeformableMesh&) = delete;
+
+        void update(const std::vector<linkit::Vector3>& positions, const std::shared_ptr<const std::vector<std::uint32_t>>& triangles);
+        void draw(Shader &shader);
+    private:
+        unsigned int VAO, VBO, EBO;
+        std::vector<Vertex> vertices_;
+        std::size_t vertex_capacity_ = 0; // Vertices the VBO has room for
+        std::shared_ptr<const std::vector<std::uint32_t>> triangles_; // Currently in the EBO
+        Texture texture_;
+};
+
+#endif //VECTRA_DEFORMABLE_MESH_H
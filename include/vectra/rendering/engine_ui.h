@@ -8,6 +8,8 @@
 struct ImVec4;
 
 #include "vectra/core/engine_state.h"
+#include "vectra/core/force_request_queue.h"
+#include "vectra/core/profiler.h"
 #include "vectra/core/scene_snapshot.h"
 
 // Forward declaration for ImGuiID
@@ -17,7 +19,7 @@ class EngineUI
 {
 public:
     static void initialize(GLFWwindow* window);
-    void draw(EngineState& state, SceneSnapshot& scene_snapshot, GLuint scene_texture_id);
+    void draw(EngineState& state, ForceRequestQueue& force_requests, SceneSnapshot& scene_snapshot, GLuint scene_texture_id);
     void end_frame();
     void cleanup();
 
@@ -25,6 +27,14 @@ private:
     int selected_object_index_ = -1;
     bool first_frame_ = true;  // For initial dock layout setup
     std::string upload_status_message_;  // Status message for file upload
+    float inspector_force_[3] = {0.0f, 500.0f, 0.0f};  // Force the Inspector's Apply button pushes with
+
+    // Profiler timeline
+    bool profiler_frozen_ = false;  // Keeps showing the same zones so they can be inspected
+    float profiler_window_ms_ = 50.0f;  // Length of the timeline
+    std::int64_t profiler_view_end_ns_ = 0;
+    std::vector<ProfileZone> profiler_zones_;
+    std::string profiler_status_message_;
 
     // Color palette (Dracula-inspired) stored as class attributes
     static ImVec4 color_background;
@@ -45,10 +55,11 @@ private:
     void setup_initial_dock_layout(ImGuiID dockspace_id);
     void draw_toolbar(EngineState& state);
     void draw_hierarchy(const SceneSnapshot& scene_snapshot);
-    void draw_inspector(const SceneSnapshot& scene_snapshot);
+    void draw_inspector(ForceRequestQueue& force_requests, const SceneSnapshot& scene_snapshot);
     void draw_scene_view(EngineState& state, GLuint scene_texture_id);
     void draw_scene_selection(EngineState& state);
     void draw_debug_panel(EngineState& state); // NEW: Debug tab for engine-level toggles and settings
+    void draw_profiler();
     static void draw_restart_overlay();
 };
 #endif //VECTRA_ENGINE_UI_H
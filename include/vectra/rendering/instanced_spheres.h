@@ -0,0 +1,32 @@
+#ifndef VECTRA_INSTANCED_SPHERES_H
+#define VECTRA_INSTANCED_SPHERES_H
+
+#include <vector>
+
+#include "vectra/rendering/shader.h"
+#include "vectra/rendering/texture.h"
+#include "vectra/rendering/vertex.h"
+
+/**
+ * One small sphere mesh drawn many times in a single instanced call, such as a particle system.
+ * Each instance is a position and radius (four floats) streamed into a per-instance buffer by update().
+ * Drawn with particle.vert, which places and scales the sphere per instance.
+ */
+class InstancedSpheres {
+    public:
+        InstancedSpheres();
+        ~InstancedSpheres();
+        InstancedSpheres(const InstancedSpheres&) = delete;
+        InstancedSpheres& operator=(const InstancedSpheres&) = delete;
+
+        void update(const std::vector<float>& instances);
+        void draw(Shader &shader);
+    private:
+        unsigned int VAO, VBO, EBO, instance_VBO;
+        unsigned int index_count_ = 0;
+        std::size_t instance_count_ = 0;
+        std::size_t instance_capacity_ = 0; // Instances the instance buffer has room for
+        Texture texture_;
+};
+
+#endif //VECTRA_INSTANCED_SPHERES_H
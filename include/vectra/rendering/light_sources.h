@@ -4,10 +4,12 @@
 #include <vector>
 #include <tuple>
 #include <iostream>
+#include <string>
 
 #include <glm/glm.hpp>
 
-#include "vectra/rendering/shader.h"
+// Lights are plain data. Uploading them lives in light_sources.cpp, so scenes load without OpenGL
+class Shader;
 
 struct DirectionalLight {
     glm::vec3 direction;
@@ -37,13 +39,8 @@ struct DirectionalLight {
 
     }
 
-    void apply_to_shader(const Shader& shader, const std::string& uniform_name) const {
-        shader.set_vec3(uniform_name + ".direction", direction);
-        shader.set_vec3(uniform_name + ".ambient", ambient);
-        shader.set_vec3(uniform_name + ".diffuse", diffuse);
-        shader.set_vec3(uniform_name + ".specular", specular);
-        shader.set_float(uniform_name + ".strength", strength);
-    }
+    // Sets the uniform struct uniform_name to this light
+    void apply_to_shader(const Shader& shader, const std::string& uniform_name) const;
 
     void display_info() const
     {
@@ -121,15 +118,7 @@ struct PointLight {
         }
     }
 
-    void apply_to_shader(const Shader& shader, const std::string& uniform_name) const {
-        shader.set_vec3(uniform_name + ".position", position);
-        shader.set_vec3(uniform_name + ".ambient", ambient);
-        shader.set_vec3(uniform_name + ".diffuse", diffuse);
-        shader.set_vec3(uniform_name + ".specular", specular);
-        shader.set_float(uniform_name + ".constant", constant);
-        shader.set_float(uniform_name + ".linear", linear);
-        shader.set_float(uniform_name + ".quadratic", quadratic);
-    }
+    void apply_to_shader(const Shader& shader, const std::string& uniform_name) const;
 
     void display_info() const
     {
@@ -211,18 +200,7 @@ struct SpotLight {
         }
     }
 
-    void apply_to_shader(const Shader& shader, const std::string& uniform_name) const {
-        shader.set_vec3(uniform_name + ".position", position);
-        shader.set_vec3(uniform_name + ".direction", direction);
-        shader.set_float(uniform_name + ".cut_off", cut_off);
-        shader.set_float(uniform_name + ".outer_cut_off", outer_cut_off);
-        shader.set_vec3(uniform_name + ".ambient", ambient);
-        shader.set_vec3(uniform_name + ".diffuse", diffuse);
-        shader.set_vec3(uniform_name + ".specular", specular);
-        shader.set_float(uniform_name + ".constant", constant);
-        shader.set_float(uniform_name + ".linear", linear);
-        shader.set_float(uniform_name + ".quadratic", quadratic);
-    }
+    void apply_to_shader(const Shader& shader, const std::string& uniform_name) const;
 
     void display_info() const
     {
@@ -5,10 +5,13 @@
 #include <GLFW/glfw3.h>
 
 #include "vectra/rendering/debug_drawer.h"
+#include "vectra/rendering/deformable_mesh.h"
+#include "vectra/rendering/instanced_spheres.h"
 #include "vectra/rendering/shader.h"
 #include "vectra/rendering/model.h"
 #include "vectra/rendering/framebuffer.h"
 #include "vectra/rendering/scene_lights.h"
+#include "vectra/rendering/skybox.h"
 
 #include "vectra/core/engine_state.h"
 #include "vectra/core/scene.h"
@@ -22,12 +25,17 @@ class Renderer
         std::unique_ptr<DebugDrawer> debug_drawer_; // Add debug drawer
         std::unordered_map<std::string, Model> model_cache_; // Model cache
         std::unique_ptr<Shader> model_shader_; // Add shader
+        std::unique_ptr<Shader> particle_shader_; // Model shader fed by per-instance positions and radii
         std::unique_ptr<Shader> depth_shader_; // NEW: depth-only shader for shadow pass
         Camera camera_; // Camera for rendering (set by scene)
         SceneLights scene_lights_; // Scene lights for rendering (set by scene)
         std::unique_ptr<Skybox> skybox_; // Skybox for rendering (set by scene) - must be initialized after OpenGL context
         glm::mat4 projection_matrix_{};
         std::unique_ptr<Framebuffer> scene_fbo_; // Framebuffer for scene rendering
+        std::vector<std::unique_ptr<DeformableMesh>> soft_body_meshes_; // One per soft body in the snapshot
+        std::vector<std::unique_ptr<InstancedSpheres>> particle_meshes_; // One per particle system in the snapshot
+        std::shared_ptr<const SnapshotObjectTable> resolved_table_; // Object table snapshot_models_ was resolved for
+        std::vector<Model*> snapshot_models_; // By model ID of resolved_table_
 
 
 
@@ -49,7 +57,11 @@ class Renderer
         void cleanup(const Scene& scene);
     private:
         void draw_game_object(::GameObject& obj, glm::mat4 model_matrix, glm::mat4 view_matrix, glm::mat4 projection_matrix, Scene& scene);
-        void draw_game_object(const std::string& model_name, glm::mat4 model_matrix, glm::mat4 view_matrix, glm::mat4 projection_matrix, glm::vec3 camera_position);
+        void draw_game_object(Model& model, glm::mat4 model_matrix, glm::mat4 view_matrix, glm::mat4 projection_matrix, glm::vec3 camera_position);
+        // Looks up the snapshot's models once per object table instead of once per object and frame
+        void resolve_models(const SceneSnapshot& snapshot);
+        void draw_soft_bodies(const SceneSnapshot& snapshot, glm::mat4 view_matrix, glm::mat4 projection_matrix, glm::vec3 camera_position);
+        void draw_particles(const SceneSnapshot& snapshot, glm::mat4 view_matrix, glm::mat4 projection_matrix, glm::vec3 camera_position);
 
         // Shadow mapping
         // Render shadow maps for lights that can cast shadows. 'dt' passed by value (no const qualifier).
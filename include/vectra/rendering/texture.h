@@ -8,4 +8,7 @@ struct Texture {
     std::string type;
     std::string path;
 };
+
+// Loads directory/path into a new OpenGL texture and returns its id
+unsigned int texture_from_file(const char *path, const std::string &directory, bool gamma = false);
 #endif //VECTRA_TEXTURE_H
\ No newline at end of file
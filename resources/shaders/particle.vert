@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec4 aInstance; // Particle position and radius
+
+out vec2 TexCoords;
+out vec3 Normal;
+out vec3 FragPos;
+
+uniform mat4 view;       // World -> View
+uniform mat4 projection; // View  -> Clip
+
+void main()
+{
+    // A unit sphere, scaled uniformly and moved to the particle, so its normals need no transform
+    TexCoords = aTexCoords;
+    FragPos = aInstance.xyz + aPos * aInstance.w;
+    Normal = aNormal;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,69 @@
+#include "vectra/bench/allocation_counter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+// The standard has the array, nothrow and sized forms of new and delete call these four, so replacing them
+// counts every allocation made through new
+
+namespace
+{
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> allocated_bytes{0};
+
+    void count(const std::size_t size)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+AllocationCount allocation_count()
+{
+    AllocationCount result;
+    result.allocations = allocations.load(std::memory_order_relaxed);
+    result.bytes = allocated_bytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+void* operator new(const std::size_t size)
+{
+    count(size);
+    void* memory = std::malloc(std::max<std::size_t>(size, 1));
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment)
+{
+    count(size);
+    const auto align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+    void* memory = _aligned_malloc(std::max<std::size_t>(size, 1), align);
+#else
+    // aligned_alloc takes a whole number of alignments
+    void* memory = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align);
+#endif
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+#ifdef _MSC_VER
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
@@ -0,0 +1,141 @@
+#include "vectra/bench/benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "vectra/bench/allocation_counter.h"
+#include "vectra/core/job_system.h"
+#include "vectra/core/profiler.h"
+#include "vectra/core/scene.h"
+#include "vectra/physics/precision.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double elapsed_ns(const Clock::time_point start, const Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+}
+
+BenchmarkResult run_benchmark(const Workload& workload, const std::size_t size, const BenchmarkOptions& options)
+{
+    BenchmarkResult result;
+    result.workload = workload.name;
+    result.size = size;
+    result.steps = options.steps;
+
+    const Clock::time_point setup_start = Clock::now();
+    Scene scene;
+    scene.name = workload.name;
+    result.bodies = workload.build(scene, size, options.seed);
+    result.objects = scene.game_objects.size();
+    scene.set_from_engine_state(options.state);
+    result.setup_ms = elapsed_ns(setup_start, Clock::now()) / 1e6;
+
+    const linkit::real dt = 1 / options.state.simulation_frequency;
+    SceneSnapshot snapshot;
+    for (int i = 0; i < options.warmup; i++)
+    {
+        scene.step(dt);
+        scene.create_snapshot(snapshot);
+    }
+
+    double step_ns = 0.0;
+    double snapshot_ns = 0.0;
+    std::uint64_t step_allocations = 0;
+    std::uint64_t step_bytes = 0;
+    std::uint64_t snapshot_allocations = 0;
+    std::uint64_t contacts = 0;
+#if VECTRA_PROFILING
+    std::vector<ProfileZone> zones;
+    std::map<std::string, double> stage_ns;
+#endif
+
+    for (int i = 0; i < options.steps; i++)
+    {
+#if VECTRA_PROFILING
+        const std::int64_t zones_since = Profiler::instance().now_ns();
+#endif
+        const AllocationCount before = allocation_count();
+        const Clock::time_point start = Clock::now();
+        scene.step(dt);
+        const Clock::time_point stepped = Clock::now();
+        const AllocationCount after_step = allocation_count();
+        scene.create_snapshot(snapshot);
+        const Clock::time_point snapshotted = Clock::now();
+        const AllocationCount after_snapshot = allocation_count();
+
+        step_ns += elapsed_ns(start, stepped);
+        snapshot_ns += elapsed_ns(stepped, snapshotted);
+        step_allocations += after_step.allocations - before.allocations;
+        step_bytes += after_step.bytes - before.bytes;
+        snapshot_allocations += after_snapshot.allocations - after_step.allocations;
+        contacts += scene.last_step_stats().contacts;
+
+#if VECTRA_PROFILING
+        // Collected every step, before the rings wrap around
+        zones.clear();
+        Profiler::instance().collect(zones, zones_since);
+        for (const ProfileZone& zone : zones)
+        {
+            if (zone.start_ns >= zones_since) stage_ns[zone.name] += static_cast<double>(zone.end_ns - zone.start_ns);
+        }
+#endif
+    }
+
+    const double body_steps = static_cast<double>(std::max<std::size_t>(1, result.bodies)) * std::max(1, options.steps);
+    const double steps = std::max(1, options.steps);
+    result.step_ms = step_ns / 1e6;
+    result.ns_per_body = step_ns / body_steps;
+#if VECTRA_PROFILING
+    for (const auto& [name, ns] : stage_ns) result.stage_ns_per_body[name] = ns / body_steps;
+#endif
+    result.allocations_per_step = static_cast<double>(step_allocations) / steps;
+    result.allocated_bytes_per_step = static_cast<double>(step_bytes) / steps;
+    result.contacts_per_step = static_cast<double>(contacts) / steps;
+    result.contacts_per_second = step_ns > 0 ? static_cast<double>(contacts) / (step_ns / 1e9) : 0.0;
+    result.snapshot_ns_per_body = snapshot_ns / body_steps;
+    result.snapshot_allocations_per_step = static_cast<double>(snapshot_allocations) / steps;
+    return result;
+}
+
+json benchmark_report(const std::vector<BenchmarkResult>& results, const BenchmarkOptions& options)
+{
+    json runs = json::array();
+    for (const BenchmarkResult& result : results)
+    {
+        runs.push_back({
+            {"workload", result.workload},
+            {"size", result.size},
+            {"bodies", result.bodies},
+            {"objects", result.objects},
+            {"steps", result.steps},
+            {"setup_ms", result.setup_ms},
+            {"step_ms", result.step_ms},
+            {"ns_per_body", result.ns_per_body},
+            {"stage_ns_per_body", result.stage_ns_per_body},
+            {"allocations_per_step", result.allocations_per_step},
+            {"allocated_bytes_per_step", result.allocated_bytes_per_step},
+            {"contacts_per_step", result.contacts_per_step},
+            {"contacts_per_second", result.contacts_per_second},
+            {"snapshot_ns_per_body", result.snapshot_ns_per_body},
+            {"snapshot_allocations_per_step", result.snapshot_allocations_per_step}
+        });
+    }
+
+    return {
+        {"precision", REAL_PRECISION_NAME},
+        {"profiling", VECTRA_PROFILING != 0},
+        {"threads", JobSystem::instance().thread_count()},
+        {"steps", options.steps},
+        {"warmup", options.warmup},
+        {"seed", options.seed},
+        {"dt", 1 / options.state.simulation_frequency},
+        {"substeps", options.state.physics_substeps},
+        {"sleeping", options.state.allow_sleeping},
+        {"continuous_collision", options.state.continuous_collision},
+        {"results", runs}
+    };
+}
@@ -0,0 +1,336 @@
+#include "vectra/bench/workloads.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include "vectra/physics/forces/newtonian_gravity.h"
+#include "vectra/physics/forces/simple_gravity.h"
+#include "vectra/physics/soft_body.h"
+
+namespace
+{
+    // Static boxes are cut into tiles about this wide. One huge box would have a bounding sphere
+    // overlapping every body, and the broad phase would pair it with all of them
+    constexpr linkit::real STATIC_TILE_SIZE = 4;
+
+    // mt19937's sequence is fixed by the standard but the std distributions are not, so values are scaled
+    // by hand to build the same scene with every standard library
+    class Random
+    {
+    public:
+        explicit Random(const std::uint32_t seed) : engine_(seed) {}
+
+        linkit::real uniform(const linkit::real low, const linkit::real high)
+        {
+            return low + (high - low) * static_cast<linkit::real>(engine_() / 4294967296.0);
+        }
+
+        linkit::Vector3 uniform_vector(const linkit::real extent)
+        {
+            const linkit::real x = uniform(-extent, extent);
+            const linkit::real y = uniform(-extent, extent);
+            const linkit::real z = uniform(-extent, extent);
+            return {x, y, z};
+        }
+
+    private:
+        std::mt19937 engine_;
+    };
+
+    // Smallest n with n * n >= count
+    std::size_t square_side(const std::size_t count)
+    {
+        auto side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+        while (side * side < count) side++;
+        return std::max<std::size_t>(1, side);
+    }
+
+    // Smallest n with n * n * n >= count
+    std::size_t cube_side(const std::size_t count)
+    {
+        auto side = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+        while (side * side * side < count) side++;
+        return std::max<std::size_t>(1, side);
+    }
+
+    // mass 0 makes the body static
+    GameObject* add_body(Scene& scene, const std::string& collider_type, const linkit::Vector3& position,
+                         const linkit::Vector3& scale, const linkit::real mass,
+                         const linkit::Vector3& velocity = linkit::Vector3(0, 0, 0))
+    {
+        GameObject obj;
+        obj.set_shape(collider_type == "ColliderSphere" ? "sphere" : "cube");
+        obj.rb.transform.position = position;
+        obj.rb.transform.scale = scale;
+        obj.rb.mass = mass;
+        obj.rb.inverse_mass = mass != 0 ? 1 / mass : 0;
+        obj.rb.velocity = velocity;
+        obj.set_collider_type(collider_type);
+        scene.add_game_object(std::move(obj));
+        return &scene.game_objects.back();
+    }
+
+    // Fills the box from low to high with static tiles
+    void add_static_slab(Scene& scene, const linkit::Vector3& low, const linkit::Vector3& high)
+    {
+        const linkit::Vector3 size = high - low;
+        const auto tiles = [](const linkit::real extent)
+        {
+            return std::max(1, static_cast<int>(std::ceil(extent / STATIC_TILE_SIZE)));
+        };
+        const int nx = tiles(size.x);
+        const int ny = tiles(size.y);
+        const int nz = tiles(size.z);
+        const linkit::Vector3 half_sizes(size.x / (2 * nx), size.y / (2 * ny), size.z / (2 * nz));
+
+        for (int x = 0; x < nx; x++)
+        {
+            for (int y = 0; y < ny; y++)
+            {
+                for (int z = 0; z < nz; z++)
+                {
+                    const linkit::Vector3 center(low.x + half_sizes.x * (2 * x + 1),
+                                                 low.y + half_sizes.y * (2 * y + 1),
+                                                 low.z + half_sizes.z * (2 * z + 1));
+                    add_body(scene, "ColliderBox", center, half_sizes, 0);
+                }
+            }
+        }
+    }
+
+    // Ground with its top at y = 0 under the square [-half_width, half_width] in x and z
+    void add_ground(Scene& scene, const linkit::real half_width)
+    {
+        add_static_slab(scene, linkit::Vector3(-half_width, -1, -half_width), linkit::Vector3(half_width, 0, half_width));
+    }
+
+    std::shared_ptr<SimpleGravity> earth_gravity()
+    {
+        return std::make_shared<SimpleGravity>(linkit::Vector3(0, -9.81, 0));
+    }
+
+    // Spheres thrown around between four walls. Mostly sphere-sphere contacts, few of them resting
+    std::size_t build_spheres_in_box(Scene& scene, const std::size_t bodies, const std::uint32_t seed)
+    {
+        constexpr linkit::real radius = 0.25;
+        constexpr linkit::real spacing = 0.75;
+        Random random(seed);
+
+        const std::size_t side = cube_side(bodies);
+        const linkit::real half_width = 0.5 * spacing * static_cast<linkit::real>(side);
+        const linkit::real height = 2 * spacing * static_cast<linkit::real>(side);
+        add_ground(scene, half_width + 1);
+        add_static_slab(scene, linkit::Vector3(-half_width - 1, 0, -half_width - 1), linkit::Vector3(-half_width, height, half_width + 1));
+        add_static_slab(scene, linkit::Vector3(half_width, 0, -half_width - 1), linkit::Vector3(half_width + 1, height, half_width + 1));
+        add_static_slab(scene, linkit::Vector3(-half_width, 0, -half_width - 1), linkit::Vector3(half_width, height, -half_width));
+        add_static_slab(scene, linkit::Vector3(-half_width, 0, half_width), linkit::Vector3(half_width, height, half_width + 1));
+
+        const auto gravity = earth_gravity();
+        for (std::size_t i = 0; i < bodies; i++)
+        {
+            const std::size_t x = i % side;
+            const std::size_t z = (i / side) % side;
+            const std::size_t y = i / (side * side);
+            const linkit::Vector3 position(-half_width + spacing * (static_cast<linkit::real>(x) + 0.5),
+                                           spacing * (static_cast<linkit::real>(y) + 0.5),
+                                           -half_width + spacing * (static_cast<linkit::real>(z) + 0.5));
+
+            const linkit::Vector3 jitter = random.uniform_vector(0.1);
+            const linkit::Vector3 velocity = random.uniform_vector(2);
+            GameObject* sphere = add_body(scene, "ColliderSphere", position + jitter,
+                                          linkit::Vector3(radius, radius, radius), 1, velocity);
+            scene.force_registry.add(sphere, gravity);
+        }
+        return bodies;
+    }
+
+    // Columns of ten unit boxes resting on the ground, which stress resting contact and sleeping
+    std::size_t build_box_stacks(Scene& scene, const std::size_t bodies, const std::uint32_t seed)
+    {
+        constexpr std::size_t stack_height = 10;
+        constexpr linkit::real spacing = 2;
+        Random random(seed);
+
+        const std::size_t stacks = (bodies + stack_height - 1) / stack_height;
+        const std::size_t side = square_side(stacks);
+        const linkit::real half_width = 0.5 * spacing * static_cast<linkit::real>(side);
+        add_ground(scene, half_width + 1);
+
+        const auto gravity = earth_gravity();
+        for (std::size_t i = 0; i < bodies; i++)
+        {
+            const std::size_t stack = i / stack_height;
+            const std::size_t level = i % stack_height;
+            // A little off centre, as stacks built by hand would be
+            const linkit::real offset_x = random.uniform(-0.02, 0.02);
+            const linkit::real offset_z = random.uniform(-0.02, 0.02);
+            const linkit::Vector3 position(
+                -half_width + spacing * (static_cast<linkit::real>(stack % side) + 0.5) + offset_x,
+                0.5 + 1.01 * static_cast<linkit::real>(level),
+                -half_width + spacing * (static_cast<linkit::real>(stack / side) + 0.5) + offset_z);
+
+            GameObject* box = add_body(scene, "ColliderBox", position, linkit::Vector3(0.5, 0.5, 0.5), 1);
+            scene.force_registry.add(box, gravity);
+        }
+        return bodies;
+    }
+
+    // Flat pyramids of unit boxes with a base of ten, each row offset by half a box from the one below
+    std::size_t build_pyramids(Scene& scene, const std::size_t bodies, const std::uint32_t seed)
+    {
+        constexpr std::size_t base = 10;
+        constexpr std::size_t pyramid_size = base * (base + 1) / 2;
+        constexpr linkit::real pyramid_spacing = 12;
+        (void)seed; // Nothing random in a pyramid
+
+        const std::size_t pyramids = (bodies + pyramid_size - 1) / pyramid_size;
+        const std::size_t side = square_side(pyramids);
+        const linkit::real half_width = 0.5 * pyramid_spacing * static_cast<linkit::real>(side);
+        add_ground(scene, half_width + 1);
+
+        const auto gravity = earth_gravity();
+        std::size_t added = 0;
+        for (std::size_t pyramid = 0; pyramid < pyramids && added < bodies; pyramid++)
+        {
+            const linkit::real left = -half_width + pyramid_spacing * static_cast<linkit::real>(pyramid % side) + 1;
+            const linkit::real z = -half_width + pyramid_spacing * (static_cast<linkit::real>(pyramid / side) + 0.5);
+            for (std::size_t row = 0; row < base && added < bodies; row++)
+            {
+                for (std::size_t column = 0; column < base - row && added < bodies; column++)
+                {
+                    const linkit::Vector3 position(left + 0.5 * static_cast<linkit::real>(row) + static_cast<linkit::real>(column) + 0.5,
+                                                   0.5 + 1.01 * static_cast<linkit::real>(row), z);
+                    GameObject* box = add_body(scene, "ColliderBox", position, linkit::Vector3(0.5, 0.5, 0.5), 1);
+                    scene.force_registry.add(box, gravity);
+                    added++;
+                }
+            }
+        }
+        return added;
+    }
+
+    // Soft blocks of 10 x 10 x 10 particles dropped on the ground. Counts particles, not blocks
+    std::size_t build_soft_lattice(Scene& scene, const std::size_t bodies, const std::uint32_t seed)
+    {
+        constexpr int resolution = 10;
+        constexpr std::size_t block_particles = resolution * resolution * resolution;
+        constexpr linkit::real spacing = 1.5;
+        (void)seed;
+
+        const std::size_t blocks = std::max<std::size_t>(1, (bodies + block_particles / 2) / block_particles);
+        const std::size_t side = square_side(blocks);
+        const linkit::real half_width = 0.5 * spacing * static_cast<linkit::real>(side);
+        add_ground(scene, half_width + 1);
+
+        std::size_t particles = 0;
+        scene.soft_bodies.reserve(blocks);
+        for (std::size_t block = 0; block < blocks; block++)
+        {
+            SoftBodyDescription description;
+            description.shape = SoftBodyShape::BLOCK;
+            description.resolution = {resolution, resolution, resolution};
+            description.spacing = 0.1;
+            description.origin = linkit::Vector3(-half_width + spacing * (static_cast<linkit::real>(block % side) + 0.5), 1,
+                                                 -half_width + spacing * (static_cast<linkit::real>(block / side) + 0.5));
+
+            SoftBody soft_body(description);
+            soft_body.name = "Soft Block " + std::to_string(block);
+            particles += soft_body.particle_count();
+            scene.soft_bodies.push_back(std::move(soft_body));
+        }
+        return particles;
+    }
+
+    // A rotating ball of small spheres held together by their own gravity, with Barnes-Hut
+    std::size_t build_nbody(Scene& scene, const std::size_t bodies, const std::uint32_t seed)
+    {
+        constexpr linkit::real radius = 0.05;
+        constexpr linkit::real g_const = 1;
+        Random random(seed);
+
+        const linkit::real cluster_radius = 2 * std::cbrt(static_cast<linkit::real>(bodies));
+        // Spinning as a solid body at the rate that balances gravity at the rim
+        const linkit::real spin = std::sqrt(g_const * static_cast<linkit::real>(bodies) /
+                                            (cluster_radius * cluster_radius * cluster_radius));
+
+        auto gravity = std::make_shared<NewtonianGravity>(g_const);
+        gravity->method = GravityMethod::BARNES_HUT;
+        gravity->softening = 0.5;
+        gravity->affected_objects.reserve(bodies);
+
+        for (std::size_t i = 0; i < bodies; i++)
+        {
+            linkit::Vector3 position = random.uniform_vector(cluster_radius);
+            while (position.magnitude_squared() > cluster_radius * cluster_radius)
+            {
+                position = random.uniform_vector(cluster_radius);
+            }
+
+            const linkit::Vector3 velocity = linkit::Vector3(-position.z, 0, position.x) * spin + random.uniform_vector(0.1);
+            GameObject* body = add_body(scene, "ColliderSphere", position, linkit::Vector3(radius, radius, radius), 1, velocity);
+            gravity->affected_objects.push_back(body);
+        }
+
+        for (GameObject* body : gravity->affected_objects) scene.force_registry.add(body, gravity);
+        return bodies;
+    }
+
+    // Chains of twenty spheres joined by stiff springs, released level with a static anchor and swinging down
+    std::size_t build_spring_chains(Scene& scene, const std::size_t bodies, const std::uint32_t seed)
+    {
+        constexpr std::size_t chain_length = 20;
+        constexpr linkit::real link_spacing = 0.5;
+        constexpr linkit::real radius = 0.1;
+        constexpr linkit::real x_spacing = 12;
+        constexpr linkit::real z_spacing = 1;
+        constexpr linkit::real height = 15;
+        (void)seed;
+
+        const std::size_t chains = (bodies + chain_length - 1) / chain_length;
+        const std::size_t side = square_side(chains);
+
+        const auto gravity = earth_gravity();
+        std::size_t added = 0;
+        for (std::size_t chain = 0; chain < chains; chain++)
+        {
+            const linkit::Vector3 anchor_position(x_spacing * static_cast<linkit::real>(chain % side), height,
+                                                  z_spacing * static_cast<linkit::real>(chain / side));
+            GameObject* previous = add_body(scene, "ColliderSphere", anchor_position, linkit::Vector3(radius, radius, radius), 0);
+
+            for (std::size_t link = 1; link <= chain_length && added < bodies; link++)
+            {
+                const linkit::Vector3 position = anchor_position + linkit::Vector3(link_spacing * static_cast<linkit::real>(link), 0, 0);
+                GameObject* next = add_body(scene, "ColliderSphere", position, linkit::Vector3(radius, radius, radius), 1);
+                scene.force_registry.add(next, gravity);
+                scene.spring_network.add(previous, next, 2000, link_spacing, 5);
+                previous = next;
+                added++;
+            }
+        }
+        return added;
+    }
+}
+
+const std::vector<Workload>& benchmark_workloads()
+{
+    static const std::vector<Workload> workloads = {
+        {"spheres_in_box", "Spheres bouncing around a box, sphere-sphere and sphere-box contacts", build_spheres_in_box},
+        {"box_stacks", "Columns of ten boxes, resting box-box contacts and sleeping", build_box_stacks},
+        {"pyramids", "Pyramids of 55 boxes, resting contacts between rows", build_pyramids},
+        {"soft_lattice", "Soft blocks of 1000 particles, XPBD constraints and particle-box collisions", build_soft_lattice},
+        {"nbody", "Self-gravitating cluster, Barnes-Hut gravity", build_nbody},
+        {"spring_chains", "Hanging chains of twenty spheres, implicit spring network", build_spring_chains},
+    };
+    return workloads;
+}
+
+const Workload* find_workload(const std::string& name)
+{
+    for (const Workload& workload : benchmark_workloads())
+    {
+        if (workload.name == name) return &workload;
+    }
+    return nullptr;
+}
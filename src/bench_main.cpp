@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "vectra/bench/benchmark.h"
+#include "vectra/bench/workloads.h"
+#include "vectra/core/job_system.h"
+#include "vectra/core/profiler.h"
+#include "vectra/physics/precision.h"
+
+namespace
+{
+    void print_usage()
+    {
+        std::cout << "Usage: vectra_bench [options]\n"
+                  << "  --workloads A,B   Workloads to run (default all, see --list)\n"
+                  << "  --sizes N,M       Bodies per workload (default 1000,10000,100000)\n"
+                  << "  --steps N         Measured steps per run (default 100)\n"
+                  << "  --warmup N        Steps before measuring (default 10)\n"
+                  << "  --seed N          Seed of the generated scenes (default 1)\n"
+                  << "  --frequency HZ    Physics frequency (default 144)\n"
+                  << "  --substeps N      Physics substeps per step\n"
+                  << "  --ccd             Continuous collision\n"
+                  << "  --no-sleep        Keep resting bodies awake\n"
+                  << "  --threads N       Job system threads (default one per hardware thread)\n"
+                  << "  --output FILE     Results as JSON (default bench_results.json, - for stdout)\n"
+                  << "  --list            List the workloads\n";
+    }
+
+    std::vector<std::string> split(const std::string& text)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, ','))
+        {
+            if (!part.empty()) parts.push_back(part);
+        }
+        return parts;
+    }
+
+    // std::stoi and friends stop at the first character they can't read, so "12abc" would pass as 12.
+    // These throw invalid_argument unless the whole text is a number in range
+    int parse_int(const std::string& text, const int min)
+    {
+        std::size_t end = 0;
+        const int value = std::stoi(text, &end);
+        if (end != text.size() || value < min) throw std::invalid_argument(text);
+        return value;
+    }
+
+    double parse_positive(const std::string& text)
+    {
+        std::size_t end = 0;
+        const double value = std::stod(text, &end);
+        if (end != text.size() || !(value > 0)) throw std::invalid_argument(text);
+        return value;
+    }
+
+    std::uint32_t parse_seed(const std::string& text)
+    {
+        std::size_t end = 0;
+        const unsigned long long value = std::stoull(text, &end);
+        if (end != text.size() || text.find('-') != std::string::npos || value > std::numeric_limits<std::uint32_t>::max())
+            throw std::invalid_argument(text);
+        return static_cast<std::uint32_t>(value);
+    }
+}
+
+// vectra_bench [options]. Steps generated workloads at several sizes and writes what every run measured as JSON
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    // Every contact counts in a benchmark, the engine's default cap would hide the broad phase's real load
+    options.state.max_collision_contacts = std::numeric_limits<int>::max();
+
+    std::vector<const Workload*> workloads;
+    std::vector<std::size_t> sizes = {1000, 10000, 100000};
+    std::string output_file = "bench_results.json";
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string option = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (option == "--help")
+        {
+            print_usage();
+            return 0;
+        }
+        if (option == "--list")
+        {
+            for (const Workload& workload : benchmark_workloads())
+            {
+                std::cout << std::left << std::setw(16) << workload.name << workload.description << "\n";
+            }
+            return 0;
+        }
+
+        try
+        {
+            if (option == "--workloads" && has_value)
+            {
+                for (const std::string& name : split(argv[++i]))
+                {
+                    const Workload* workload = find_workload(name);
+                    if (!workload)
+                    {
+                        std::cerr << "Unknown workload: " << name << std::endl;
+                        return 1;
+                    }
+                    workloads.push_back(workload);
+                }
+            }
+            else if (option == "--sizes" && has_value)
+            {
+                sizes.clear();
+                for (const std::string& size : split(argv[++i])) sizes.push_back(static_cast<std::size_t>(parse_int(size, 1)));
+            }
+            else if (option == "--steps" && has_value) options.steps = parse_int(argv[++i], 1);
+            else if (option == "--warmup" && has_value) options.warmup = parse_int(argv[++i], 0);
+            else if (option == "--seed" && has_value) options.seed = parse_seed(argv[++i]);
+            else if (option == "--frequency" && has_value) options.state.simulation_frequency = parse_positive(argv[++i]);
+            else if (option == "--substeps" && has_value) options.state.physics_substeps = parse_int(argv[++i], 1);
+            else if (option == "--ccd") options.state.continuous_collision = true;
+            else if (option == "--no-sleep") options.state.allow_sleeping = false;
+            else if (option == "--threads" && has_value) options.state.worker_threads = parse_int(argv[++i], 1);
+            else if (option == "--output" && has_value) output_file = argv[++i];
+            else
+            {
+                std::cerr << "Unknown option: " << option << std::endl;
+                print_usage();
+                return 1;
+            }
+        }
+        catch (const std::logic_error&)
+        {
+            // The std::sto* calls throw invalid_argument or out_of_range, both logic_errors
+            std::cerr << "Invalid value for " << option << ": " << argv[i] << std::endl;
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (workloads.empty())
+    {
+        for (const Workload& workload : benchmark_workloads()) workloads.push_back(&workload);
+    }
+
+    VECTRA_PROFILE_THREAD("Main");
+    JobSystem::instance().set_thread_count(static_cast<std::size_t>(std::max(0, options.state.worker_threads)));
+
+    // The JSON may go to stdout, so progress goes to stderr then
+    std::ostream& log = output_file == "-" ? std::cerr : std::cout;
+    log << "[" << REAL_PRECISION_NAME << "] " << JobSystem::instance().thread_count() << " threads, "
+        << options.steps << " steps after " << options.warmup << " warm-up steps" << std::endl;
+
+    std::vector<BenchmarkResult> results;
+    for (const Workload* workload : workloads)
+    {
+        for (const std::size_t size : sizes)
+        {
+            const BenchmarkResult& result = results.emplace_back(run_benchmark(*workload, size, options));
+            log << std::left << std::setw(16) << result.workload << std::right << std::setw(8) << result.bodies
+                << " bodies: " << std::fixed << std::setprecision(1) << result.ns_per_body << " ns/body, "
+                << result.allocations_per_step << " allocations/step, " << std::setprecision(0)
+                << result.contacts_per_second << " contacts/s" << std::defaultfloat << std::endl;
+        }
+    }
+
+    const json report = benchmark_report(results, options);
+    if (output_file == "-")
+    {
+        std::cout << report.dump(4) << std::endl;
+        return 0;
+    }
+
+    std::ofstream output(output_file);
+    if (!output.is_open())
+    {
+        std::cerr << "Could not open " << output_file << std::endl;
+        return 1;
+    }
+    output << report.dump(4) << std::endl;
+    log << "Results written to " << output_file << std::endl;
+    return 0;
+}
@@ -0,0 +1,206 @@
+#include "vectra/core/batch_runner.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "vectra/core/headless_engine.h"
+#include "vectra/core/job_system.h"
+#include "vectra/core/profiler.h"
+
+namespace
+{
+    // A CSV field in quotes, with its own quotes doubled
+    std::string csv_quoted(const std::string& text)
+    {
+        std::string quoted = "\"";
+        for (const char c : text)
+        {
+            quoted += c;
+            if (c == '"') quoted += '"';
+        }
+        return quoted + '"';
+    }
+}
+
+BatchDescription batch_description_from_json(const json& j)
+{
+    BatchDescription description;
+    j.at("scene").get_to(description.scene);
+    if (j.contains("steps"))
+        j.at("steps").get_to(description.steps);
+    if (j.contains("every"))
+        j.at("every").get_to(description.every);
+    if (j.contains("output"))
+        j.at("output").get_to(description.output_directory);
+
+    if (j.contains("instances"))
+    {
+        for (const auto& instance : j.at("instances"))
+        {
+            description.instances.push_back(instance);
+        }
+    }
+
+    if (j.contains("sweep"))
+    {
+        const json& sweep = j.at("sweep");
+        const auto pointer = sweep.at("pointer").get<std::string>();
+        const auto from = sweep.at("from").get<double>();
+        const auto to = sweep.at("to").get<double>();
+        const auto count = sweep.at("count").get<int>();
+        for (int i = 0; i < count; i++)
+        {
+            const double t = count > 1 ? static_cast<double>(i) / (count - 1) : 0.0;
+            description.instances.push_back(json{{pointer, from + (to - from) * t}});
+        }
+    }
+
+    // Without overrides the scene is still run once
+    if (description.instances.empty())
+        description.instances.push_back(json::object());
+    return description;
+}
+
+BatchRunner::BatchRunner(BatchDescription description, const EngineState& state)
+    : description_(std::move(description)), state_(state)
+{
+}
+
+bool BatchRunner::run()
+{
+    SceneSerializer serializer;
+    json scene_data;
+    try
+    {
+        scene_data = serializer.read_scene_file(description_.scene);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Failed to read scene " << description_.scene << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    // Load the scene as written once, so its warnings are printed once rather than by every instance
+    const SceneLoadResult check = serializer.deserialize_scene_json(scene_data, description_.scene);
+    for (const auto& error : check.errors)
+    {
+        std::cerr << error << std::endl;
+    }
+    for (const auto& warning : check.warnings)
+    {
+        std::cout << warning << std::endl;
+    }
+    if (check.has_errors()) return false;
+
+    std::filesystem::create_directories(description_.output_directory);
+
+    // Instances finish in any order, but each writes only its own result slot and file. They are root jobs:
+    // a thread waiting inside one instance helps with the parallel stages of any instance, but never starts
+    // another instance nested on its stack, so only one scene per thread is alive at a time
+    results_.assign(description_.instances.size(), BatchInstanceResult());
+    std::vector<JobHandle> jobs;
+    jobs.reserve(description_.instances.size());
+    for (std::size_t i = 0; i < description_.instances.size(); i++)
+    {
+        jobs.push_back(JobSystem::instance().schedule_root([this, i, &scene_data]
+        {
+            results_[i] = run_instance(i, scene_data);
+        }));
+    }
+    JobSystem::instance().wait(jobs);
+
+    write_summary();
+    bool succeeded = true;
+    for (std::size_t i = 0; i < results_.size(); i++)
+    {
+        if (results_[i].succeeded) continue;
+        std::cerr << "Instance " << i << " failed: " << results_[i].message << std::endl;
+        succeeded = false;
+    }
+    return succeeded;
+}
+
+const std::vector<BatchInstanceResult>& BatchRunner::results() const
+{
+    return results_;
+}
+
+BatchInstanceResult BatchRunner::run_instance(const std::size_t index, const json& scene_data) const
+{
+    VECTRA_PROFILE_SCOPE("Batch instance");
+    BatchInstanceResult result;
+    const std::string name = description_.scene + " #" + std::to_string(index);
+    try
+    {
+        json instance_data = scene_data;
+        for (const auto& [pointer, value] : description_.instances[index].items())
+        {
+            // Assigning through a pointer creates any missing path, so a typo would silently run the scene unchanged
+            const json::json_pointer target(pointer);
+            if (!instance_data.contains(target))
+            {
+                result.message = "Override " + pointer + " is not in the scene";
+                return result;
+            }
+            instance_data[target] = value;
+        }
+
+        SceneSerializer serializer;
+        SceneLoadResult loaded = serializer.deserialize_scene_json(instance_data, name);
+        if (loaded.has_errors())
+        {
+            result.message = loaded.errors.front();
+            return result;
+        }
+
+        // Overrides can produce warnings the unmodified scene didn't have, so they are kept per instance
+        for (const auto& warning : loaded.warnings)
+        {
+            result.message += (result.message.empty() ? "" : "; ") + warning;
+        }
+
+        HeadlessEngine engine(state_);
+        engine.set_scene(std::move(loaded.scene), name);
+
+        const std::filesystem::path csv_path =
+            std::filesystem::path(description_.output_directory) / ("instance_" + std::to_string(index) + ".csv");
+        std::ofstream csv(csv_path);
+        if (!csv.is_open())
+        {
+            result.message = "Could not open " + csv_path.string();
+            return result;
+        }
+        HeadlessEngine::write_csv_header(csv);
+        engine.write_csv_rows(csv);
+
+        const int every = description_.every;
+        result.wall_ms = engine.run(description_.steps, [&](const std::uint64_t tick)
+        {
+            if (every > 0 && tick % every == 0) engine.write_csv_rows(csv);
+        });
+        if (every <= 0 || engine.tick() % every != 0) engine.write_csv_rows(csv);
+
+        result.steps = engine.tick();
+        result.simulated_time = engine.simulated_time();
+        result.succeeded = true;
+    }
+    catch (const std::exception& e)
+    {
+        result.message = e.what();
+    }
+    return result;
+}
+
+void BatchRunner::write_summary() const
+{
+    std::ofstream summary(std::filesystem::path(description_.output_directory) / "summary.csv");
+    summary << "instance,succeeded,steps,simulated_time,wall_ms,overrides,message\n";
+    for (std::size_t i = 0; i < results_.size(); i++)
+    {
+        const BatchInstanceResult& result = results_[i];
+        summary << i << ',' << (result.succeeded ? 1 : 0) << ',' << result.steps << ',' << result.simulated_time << ','
+                << result.wall_ms << ',' << csv_quoted(description_.instances[i].dump()) << ','
+                << csv_quoted(result.message) << '\n';
+    }
+}
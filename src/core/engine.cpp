@@ -1,23 +1,27 @@
+#include <algorithm>
 #include <thread>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 
 #include "linkit/linkit.h"
 #include "vectra/core/engine.h"
+#include "vectra/core/job_system.h"
+#include "vectra/core/profiler.h"
+#include "vectra/core/tick_pacer.h"
 
 #include <iostream>
 #include <unistd.h>
 
-#include "vectra/core/render_queue.h"
-
 
 #include "vectra/physics/forces/simple_gravity.h"
 #include "vectra/physics/forces/object_anchored_spring.h"
 
 
-Engine::Engine() : render_queue_()
+Engine::Engine()
 {
     state_ = EngineState();
+    JobSystem::instance().set_thread_count(static_cast<std::size_t>(std::max(0, state_.worker_threads)));
     renderer = std::make_unique<Renderer>(&state_);
     scene = std::make_unique<Scene>();
 
@@ -55,13 +59,60 @@ void Engine::load_scene(const std::string& filename)
     state_.loaded_scene = filename;
     renderer->setup_from_scene(*scene);
     scene->set_from_engine_state(state_);
+
+    if (recorder_.is_open())
+    {
+        try
+        {
+            recorder_.record_scene(serializer_.read_scene_file(filename), filename, state_, *scene);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Could not record " << filename << ": " << e.what() << std::endl;
+        }
+    }
+}
+
+bool Engine::record_to(const std::string& filename)
+{
+    if (!recorder_.open(filename))
+    {
+        std::cerr << "Could not open " << filename << std::endl;
+        return false;
+    }
+    recorded_paused_ = true;
+    return true;
+}
+
+void Engine::take_inputs()
+{
+    force_requests_.take(taken_forces_);
+    for (const ForceRequest& request : taken_forces_)
+    {
+        scene->apply_force(request.object_index, request.force);
+        recorder_.record_force(request.object_index, request.force);
+    }
+    if (state_.is_paused != recorded_paused_)
+    {
+        recorded_paused_ = state_.is_paused;
+        recorder_.record_pause(recorded_paused_);
+    }
+}
+
+void Engine::step_scene(const double dt)
+{
+    const linkit::real speed = state_.simulation_speed;
+    const auto scaled_dt = static_cast<linkit::real>(dt * speed);
+    scene->step(scaled_dt);
+    recorder_.record_step(scaled_dt, speed, *scene);
 }
 
 
 void Engine::run_single_thread()
 {
     linkit::real t = 0.0;
-    const linkit::real dt_phys = 1.0 / state_.simulation_frequency;
+    step_controller_.configure(state_);
+    linkit::real dt_phys = state_.adaptive_time_step ? step_controller_.dt() : 1.0 / state_.simulation_frequency;
 
     linkit::real currentTime = glfwGetTime();
     linkit::real accumulator = 0.0;
@@ -71,6 +122,8 @@ void Engine::run_single_thread()
     renderer->use_skybox();
     auto window = renderer->get_window();
 
+    SceneSnapshot scene_snapshot; // Refilled every frame, keeping its buffers
+
 
     while (!glfwWindowShouldClose(window)) {
         // Handle scene restart
@@ -80,6 +133,8 @@ void Engine::run_single_thread()
             state_.scene_should_restart = false;
             accumulator = 0.0;
             currentTime = glfwGetTime();
+            step_controller_.configure(state_);
+            dt_phys = state_.adaptive_time_step ? step_controller_.dt() : 1.0 / state_.simulation_frequency;
         }
 
         double new_time = glfwGetTime();
@@ -90,29 +145,42 @@ void Engine::run_single_thread()
         static double fps_timer = 0.0; static int fps_frames = 0;
         fps_timer += frame_time; fps_frames++;
         if (fps_timer >= 1.0) {
-            std::string title = "Vectra Engine";
+            std::string title = "Vectra Engine - " + std::to_string(static_cast<int>(fps_frames / fps_timer + 0.5)) + " FPS";
             glfwSetWindowTitle(window, title.c_str());
             fps_timer -= 1.0; fps_frames = 0;
         }
 
+        VECTRA_PROFILE_SCOPE("Frame");
+
         accumulator += frame_time;
+        take_inputs();
         while (accumulator >= dt_phys) {
-            if (!state_.is_paused) scene->step(dt_phys * state_.simulation_speed);
-            accumulator -= dt_phys;
-            t += dt_phys;
+            const linkit::real step_dt = dt_phys;
+            if (!state_.is_paused)
+            {
+                step_scene(step_dt);
+                if (state_.adaptive_time_step)
+                {
+                    step_controller_.set_frequency_bounds(state_.min_simulation_frequency, state_.max_simulation_frequency);
+                    dt_phys = step_controller_.update(scene->last_step_stats());
+                }
+            }
+            accumulator -= step_dt;
+            t += step_dt;
+            state_.current_dt = step_dt;
         }
 
         // Clear the main window
         Renderer::begin_frame();
 
         // Create a scene snapshot
-        auto scene_snapshot = scene->create_snapshot();
+        scene->create_snapshot(scene_snapshot);
 
         // Render scene to framebuffer
         renderer->render_to_framebuffer(scene_snapshot, static_cast<linkit::real>(frame_time));
 
         // Draw UI with framebuffer texture
-        ui->draw(state_, scene_snapshot, renderer->get_scene_texture_id());
+        ui->draw(state_, force_requests_, scene_snapshot, renderer->get_scene_texture_id());
         ui->end_frame();
 
         renderer->end_frame();
@@ -120,6 +188,7 @@ void Engine::run_single_thread()
         double end_frame_time = glfwGetTime();
         double time_to_wait = min_frame_time - (end_frame_time - new_time);
         if (time_to_wait > 0.0) {
+            VECTRA_PROFILE_SCOPE("Frame wait");
             std::this_thread::sleep_for(std::chrono::duration<double>(time_to_wait));
         }
     }
@@ -129,14 +198,20 @@ void Engine::run_single_thread()
 
 void Engine::physics_thread_func()
 {
-    using Clock = std::chrono::high_resolution_clock;
+    using Clock = TickPacer::Clock;
     using Duration = std::chrono::duration<double>;
+    VECTRA_PROFILE_THREAD("Physics");
 
-    // Fixed physics time step (e.g., 60 Hz)
-    const double dt = 1.0 / state_.simulation_frequency;
+    // Fixed physics time step (e.g., 60 Hz), or chosen per tick by the step controller
+    step_controller_.configure(state_);
+    double dt = state_.adaptive_time_step ? step_controller_.dt() : 1.0 / state_.simulation_frequency;
 
+    TickPacer pacer;
     auto current_time = Clock::now();
     double accumulator = 0.0;
+    std::uint64_t tick = 0;
+    // The renderer needs one snapshot of a newly loaded scene even while it is paused
+    bool publish_pending = true;
 
     while (state_.is_running)
     {
@@ -145,6 +220,10 @@ void Engine::physics_thread_func()
         {
             current_time = Clock::now();
             accumulator = 0.0;
+            tick = 0;
+            step_controller_.configure(state_);
+            dt = state_.adaptive_time_step ? step_controller_.dt() : 1.0 / state_.simulation_frequency;
+            publish_pending = true;
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
             continue;
         }
@@ -154,24 +233,63 @@ void Engine::physics_thread_func()
         current_time = new_time;
 
         accumulator += frame_time.count();
+        take_inputs();
 
         // Clamp accumulator to prevent "Spiral of Death" if physics falls behind
         if (accumulator > 0.25)
             accumulator = 0.25;
 
-        // Only step physics when enough real time has accumulated
+        // Only step physics when enough real time has accumulated. While paused nothing advances,
+        // so no time is banked for when the scene resumes
+        bool stepped = false;
+        if (state_.is_paused)
+        {
+            accumulator = 0.0;
+        }
         while (accumulator >= dt)
         {
-            if (!state_.is_paused) {
-                scene->step(dt * state_.simulation_speed);
+            stepped = true;
+            const double step_dt = dt;
+            step_scene(step_dt);
+            if (state_.adaptive_time_step)
+            {
+                // The Debug panel's bounds apply from the next step, like the adaptive toggle itself
+                step_controller_.set_frequency_bounds(state_.min_simulation_frequency, state_.max_simulation_frequency);
+                dt = step_controller_.update(scene->last_step_stats());
             }
-            accumulator -= dt;
+            accumulator -= step_dt;
+            state_.current_dt = step_dt;
+            tick++;
+        }
+
+        // Only publish when the state changed, the renderer keeps drawing the last snapshot otherwise
+        if (stepped || publish_pending)
+        {
+            VECTRA_PROFILE_SCOPE("Publish snapshot");
+            // Never blocks. If the renderer is slow, the snapshots it hasn't picked up are replaced.
+            // The write buffer is a snapshot from a few ticks back, refilled without allocating
+            SceneSnapshot& snapshot = snapshots_.write_buffer();
+            scene->create_snapshot(snapshot);
+            // The state is that of the moment the last step was due, the unspent accumulator ago
+            snapshot.tick = tick;
+            snapshot.time = new_time - std::chrono::duration_cast<Clock::duration>(Duration(accumulator));
+            snapshot.dt = state_.current_dt;
+            snapshots_.publish();
+            publish_pending = false;
         }
 
-        // Push state to renderer
-        // Note: In a triple-buffer setup, this might block if the renderer is slow.
-        // That is acceptable; the accumulator ensures we catch up when we unblock.
-        render_queue_.push(scene->create_snapshot());
+        if (state_.is_paused)
+        {
+            // Only polls for the scene resuming, which needs no precise wake up
+            std::this_thread::sleep_for(Duration(dt));
+            continue;
+        }
+
+        // Sleep until the next step is due
+        VECTRA_PROFILE_SCOPE("Tick wait");
+        pacer.wait_until(new_time + std::chrono::duration_cast<Clock::duration>(Duration(dt - accumulator)));
+        state_.tick_jitter = pacer.mean_jitter();
+        state_.max_tick_jitter = pacer.max_jitter();
     }
 }
 
@@ -185,6 +303,7 @@ void Engine::rendering_thread_func()
     renderer->use_skybox();
 
     auto window = renderer->get_window();
+    VECTRA_PROFILE_THREAD("Render");
 
     while (!glfwWindowShouldClose(window)) {
         // Handle scene restart on the rendering thread (has OpenGL context)
@@ -204,9 +323,18 @@ void Engine::rendering_thread_func()
         double frame_time = new_time - currentTime;
         currentTime = new_time;
 
+        VECTRA_PROFILE_SCOPE("Frame");
 
-        SceneSnapshot scene_snapshot;
-        render_queue_.pop(scene_snapshot);
+        // Newest complete physics state, handed to the interpolator. The read slot gets the oldest
+        // snapshot back, to be refilled by the physics thread
+        {
+            VECTRA_PROFILE_SCOPE("Acquire snapshot");
+            if (snapshots_.acquire())
+            {
+                interpolator_.push(snapshots_.read_buffer());
+            }
+        }
+        SceneSnapshot& scene_snapshot = interpolator_.frame(SnapshotInterpolator::Clock::now(), state_.interpolate_rendering);
 
         // Clear the main window
         Renderer::begin_frame();
@@ -215,7 +343,7 @@ void Engine::rendering_thread_func()
         renderer->render_to_framebuffer(scene_snapshot, static_cast<linkit::real>(frame_time));
 
         // Draw UI with framebuffer texture
-        ui->draw(state_, scene_snapshot, renderer->get_scene_texture_id());
+        ui->draw(state_, force_requests_, scene_snapshot, renderer->get_scene_texture_id());
         ui->end_frame();
 
         renderer->end_frame();
@@ -223,6 +351,7 @@ void Engine::rendering_thread_func()
         double end_frame_time = glfwGetTime();
         double time_to_wait = min_frame_time - (end_frame_time - new_time);
         if (time_to_wait > 0.0) {
+            VECTRA_PROFILE_SCOPE("Frame wait");
             std::this_thread::sleep_for(std::chrono::duration<double>(time_to_wait));
         }
     }
@@ -232,6 +361,25 @@ void Engine::rendering_thread_func()
     renderer->cleanup(*scene);
 }
 
+double Engine::benchmark_physics(const int steps)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const linkit::real dt = 1.0 / state_.simulation_frequency;
+
+    const auto start = Clock::now();
+    for (int i = 0; i < steps; i++)
+    {
+        scene->step(dt);
+    }
+    const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+    state_.is_running = false;
+    ui->cleanup();
+    renderer->cleanup(*scene);
+    return elapsed.count();
+}
+
 void Engine::run()
 {
     std::thread physics_thread(&Engine::physics_thread_func, this);
@@ -240,9 +388,6 @@ void Engine::run()
     // (Event loop must run on the thread that created the window)
     rendering_thread_func();
 
-    // Signal the queue to unblock any waiting threads so we can exit cleanly
-    render_queue_.shutdown();
-
     if (physics_thread.joinable()) {
         physics_thread.join();
     }
@@ -14,6 +14,7 @@ GameObject::GameObject()
 
 GameObject::GameObject(const GameObject& other)
     : rb(other.rb),
+      body(other.body),
       name(other.name),
       model_name(other.model_name)
 {
@@ -28,6 +29,7 @@ GameObject& GameObject::operator=(const GameObject& other)
 {
     if (this == &other) return *this;
     rb = other.rb;
+    body = other.body;
     name = other.name;
     model_name = other.model_name;
     collider = other.collider ? other.collider->clone() : nullptr;
@@ -40,6 +42,7 @@ GameObject& GameObject::operator=(const GameObject& other)
 
 GameObject::GameObject(GameObject&& other) noexcept
     : rb(std::move(other.rb)),
+      body(other.body),
       name(std::move(other.name)),
       model_name(std::move(other.model_name)),
       collider(std::move(other.collider))
@@ -54,6 +57,7 @@ GameObject& GameObject::operator=(GameObject&& other) noexcept
 {
     if (this == &other) return *this;
     rb = std::move(other.rb);
+    body = other.body;
     name = std::move(other.name);
     model_name = std::move(other.model_name);
     collider = std::move(other.collider);
@@ -0,0 +1,110 @@
+#include "vectra/core/headless_engine.h"
+
+#include <chrono>
+#include <iostream>
+
+HeadlessEngine::HeadlessEngine(const EngineState& state)
+    : scene(std::make_unique<Scene>()), state_(state)
+{
+}
+
+bool HeadlessEngine::load_scene(const std::string& filename)
+{
+    auto result = serializer_.deserialize_scene(filename);
+    for (const auto& error : result.errors)
+    {
+        std::cerr << error << std::endl;
+    }
+    if (result.has_errors())
+    {
+        std::cerr << "Failed to load scene: " << filename << std::endl;
+        return false;
+    }
+    for (const auto& warning : result.warnings)
+    {
+        std::cout << warning << std::endl;
+    }
+
+    set_scene(std::move(result.scene), filename);
+    if (recorder_) recorder_->record_scene(serializer_.read_scene_file(filename), filename, state_, *scene);
+    return true;
+}
+
+void HeadlessEngine::set_scene(Scene&& loaded, const std::string& name)
+{
+    *scene = std::move(loaded);
+    state_.loaded_scene = name;
+    scene->set_from_engine_state(state_);
+    step_controller_.configure(state_);
+    tick_ = 0;
+    simulated_time_ = 0.0;
+}
+
+double HeadlessEngine::run(const int steps, const std::function<void(std::uint64_t tick)>& on_tick)
+{
+    using Clock = std::chrono::steady_clock;
+
+    linkit::real dt = state_.adaptive_time_step ? step_controller_.dt() : 1 / state_.simulation_frequency;
+    const auto start = Clock::now();
+    for (int i = 0; i < steps; i++)
+    {
+        const linkit::real step_dt = dt * state_.simulation_speed;
+        scene->step(step_dt);
+        if (recorder_) recorder_->record_step(step_dt, state_.simulation_speed, *scene);
+        if (state_.adaptive_time_step) dt = step_controller_.update(scene->last_step_stats());
+
+        tick_++;
+        simulated_time_ += step_dt;
+        state_.current_dt = step_dt;
+        if (on_tick) on_tick(tick_);
+    }
+    const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return elapsed.count();
+}
+
+void HeadlessEngine::record_to(ReplayRecorder* recorder)
+{
+    recorder_ = recorder;
+}
+
+void HeadlessEngine::save_scene(const std::string& filename)
+{
+    serializer_.serialize_scene(*scene, filename);
+}
+
+void HeadlessEngine::write_csv_header(std::ostream& out)
+{
+    out << "tick,time,name,px,py,pz,qw,qx,qy,qz,vx,vy,vz,wx,wy,wz\n";
+}
+
+void HeadlessEngine::write_csv_rows(std::ostream& out) const
+{
+    const PhysicsWorld& world = scene->physics_world;
+    for (const auto& obj : scene->game_objects)
+    {
+        const linkit::Vector3& position = world.positions[obj.body];
+        const linkit::Quaternion& orientation = world.orientations[obj.body];
+        const linkit::Vector3& velocity = world.velocities[obj.body];
+        const linkit::Vector3& angular_velocity = world.angular_velocities[obj.body];
+        out << tick_ << ',' << simulated_time_ << ',' << obj.name << ','
+            << position.x << ',' << position.y << ',' << position.z << ','
+            << orientation.w << ',' << orientation.x << ',' << orientation.y << ',' << orientation.z << ','
+            << velocity.x << ',' << velocity.y << ',' << velocity.z << ','
+            << angular_velocity.x << ',' << angular_velocity.y << ',' << angular_velocity.z << '\n';
+    }
+}
+
+std::uint64_t HeadlessEngine::tick() const
+{
+    return tick_;
+}
+
+double HeadlessEngine::simulated_time() const
+{
+    return simulated_time_;
+}
+
+const EngineState& HeadlessEngine::state() const
+{
+    return state_;
+}
@@ -0,0 +1,276 @@
+#include "vectra/core/job_system.h"
+
+#include <string>
+
+#include "vectra/core/profiler.h"
+
+namespace
+{
+    // Which pool the current thread works for, and its deque there
+    thread_local const JobSystem* current_system = nullptr;
+    thread_local std::size_t current_queue = 0;
+    // Jobs running on the current thread's stack: above 0 while a job waits on others
+    thread_local int job_depth = 0;
+
+    // Attempts to find a job before an idle worker goes to sleep, so short gaps between jobs don't pay for a wake up
+    constexpr int IDLE_SPINS = 64;
+}
+
+JobSystem& JobSystem::instance()
+{
+    static JobSystem system;
+    return system;
+}
+
+JobSystem::JobSystem(const std::size_t thread_count)
+{
+    start(thread_count);
+}
+
+JobSystem::~JobSystem()
+{
+    stop();
+}
+
+void JobSystem::set_thread_count(const std::size_t thread_count)
+{
+    stop();
+    start(thread_count);
+}
+
+std::size_t JobSystem::thread_count() const
+{
+    return thread_count_;
+}
+
+void JobSystem::start(const std::size_t thread_count)
+{
+    thread_count_ = thread_count > 0 ? thread_count : std::max(1u, std::thread::hardware_concurrency());
+    stopping_ = false;
+
+    // The thread waiting on the jobs works too, so one fewer worker than threads
+    const std::size_t worker_count = thread_count_ - 1;
+    queues_.clear();
+    for (std::size_t q = 0; q < worker_count + 1; q++) queues_.push_back(std::make_unique<WorkQueue>());
+    workers_.reserve(worker_count);
+    for (std::size_t w = 0; w < worker_count; w++)
+    {
+        workers_.emplace_back([this, w] { worker_loop(w); });
+    }
+}
+
+void JobSystem::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) worker.join();
+    workers_.clear();
+}
+
+void JobSystem::worker_loop(const std::size_t index)
+{
+    current_system = this;
+    current_queue = index;
+    VECTRA_PROFILE_THREAD("Worker " + std::to_string(index + 1));
+
+    while (true)
+    {
+        bool ran = false;
+        for (int spin = 0; spin < IDLE_SPINS && !ran; spin++)
+        {
+            ran = run_one();
+            if (!ran) std::this_thread::yield();
+        }
+        if (ran) continue;
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return queued_.load() > 0 || stopping_.load(); });
+        if (stopping_ && queued_.load() == 0) return;
+    }
+}
+
+JobHandle JobSystem::schedule(std::function<void()> function, const std::vector<JobHandle>& dependencies)
+{
+    auto job = std::make_shared<Job>();
+    job->function = std::move(function);
+    // Held at one until every dependency is registered, so one finishing meanwhile can't start the job early
+    job->unfinished.store(static_cast<int>(dependencies.size()) + 1);
+
+    for (const JobHandle& dependency : dependencies)
+    {
+        std::lock_guard<std::mutex> lock(dependency->mutex);
+        if (dependency->finished)
+        {
+            if (dependency->error && !job->error) job->error = dependency->error;
+            job->unfinished.fetch_sub(1);
+        }
+        else
+        {
+            dependency->continuations.push_back(job);
+        }
+    }
+
+    if (job->unfinished.fetch_sub(1) == 1) push(job);
+    return job;
+}
+
+JobHandle JobSystem::then(const JobHandle& job, std::function<void()> function)
+{
+    return schedule(std::move(function), {job});
+}
+
+JobHandle JobSystem::schedule_root(std::function<void()> function)
+{
+    auto job = std::make_shared<Job>();
+    job->function = std::move(function);
+    job->root = true;
+    push(job);
+    return job;
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+    while (!job->done.load(std::memory_order_acquire))
+    {
+        if (!run_one()) std::this_thread::yield();
+    }
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    if (job->error) std::rethrow_exception(job->error);
+}
+
+void JobSystem::wait(const std::vector<JobHandle>& jobs)
+{
+    std::exception_ptr error;
+    for (const JobHandle& job : jobs)
+    {
+        try
+        {
+            wait(job);
+        }
+        catch (...)
+        {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void JobSystem::push(JobHandle job)
+{
+    {
+        WorkQueue& queue = job->root ? root_queue_ : *queues_[own_queue()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    queued_.fetch_add(1);
+
+    // Taking the lock orders this push before any worker's check of queued_, so the wake up isn't lost
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+}
+
+JobHandle JobSystem::pop()
+{
+    const std::size_t own = own_queue();
+    {
+        WorkQueue& queue = *queues_[own];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            JobHandle job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            queued_.fetch_sub(1);
+            return job;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < queues_.size(); offset++)
+    {
+        WorkQueue& queue = *queues_[(own + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            JobHandle job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            queued_.fetch_sub(1);
+            return job;
+        }
+    }
+
+    if (job_depth == 0)
+    {
+        std::lock_guard<std::mutex> lock(root_queue_.mutex);
+        if (!root_queue_.jobs.empty())
+        {
+            JobHandle job = std::move(root_queue_.jobs.front());
+            root_queue_.jobs.pop_front();
+            queued_.fetch_sub(1);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool JobSystem::run_one()
+{
+    if (queued_.load(std::memory_order_relaxed) == 0) return false;
+
+    const JobHandle job = pop();
+    if (!job) return false;
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(const JobHandle& job)
+{
+    // A job whose dependency failed is skipped and passes the error on
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        error = job->error;
+    }
+    if (!error)
+    {
+        job_depth++;
+        try
+        {
+            job->function();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        job_depth--;
+    }
+    job->function = nullptr;
+
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->error = error;
+        job->finished = true;
+        continuations.swap(job->continuations);
+    }
+    job->done.store(true, std::memory_order_release);
+
+    for (const JobHandle& continuation : continuations)
+    {
+        if (error)
+        {
+            std::lock_guard<std::mutex> lock(continuation->mutex);
+            if (!continuation->error) continuation->error = error;
+        }
+        if (continuation->unfinished.fetch_sub(1) == 1) push(continuation);
+    }
+}
+
+std::size_t JobSystem::own_queue() const
+{
+    return current_system == this ? current_queue : queues_.size() - 1;
+}
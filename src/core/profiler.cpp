@@ -0,0 +1,225 @@
+#include "vectra/core/profiler.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+
+struct Profiler::ThreadBuffer
+{
+    // Written by the owning thread while readers copy it, so every field is atomic. On common hardware
+    // these loads and stores compile to plain moves
+    struct Slot
+    {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<std::int64_t> start_ticks{0};
+        std::atomic<std::int64_t> end_ticks{0};
+        std::atomic<std::uint32_t> depth{0};
+    };
+
+    std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(ZONES_PER_THREAD);
+    std::atomic<std::uint64_t> written{0}; // Zones ever closed into this buffer, slot written % ZONES_PER_THREAD is next
+    std::uint32_t open_zones = 0; // Owning thread only
+    std::uint32_t index = 0;
+    std::string name;
+    bool in_use = false;
+};
+
+// Hands the buffer of a thread back to the profiler when the thread exits
+struct Profiler::ThreadBufferOwner
+{
+    ThreadBuffer* buffer = nullptr;
+
+    ~ThreadBufferOwner()
+    {
+        if (buffer) instance().release_buffer(*buffer);
+    }
+};
+
+namespace
+{
+    void write_json_string(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+}
+
+Profiler::Profiler() : epoch_(Clock::now()), epoch_ticks_(ticks())
+{
+}
+
+void Profiler::set_enabled(const bool enabled)
+{
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::set_thread_name(const std::string& name)
+{
+    ThreadBuffer& buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer.name = name;
+}
+
+std::vector<std::string> Profiler::thread_names() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    names.reserve(buffers_.size());
+    for (const auto& buffer : buffers_) names.push_back(buffer->name);
+    return names;
+}
+
+std::int64_t Profiler::now_ns() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch_).count();
+}
+
+double Profiler::ticks_per_ns() const
+{
+#if VECTRA_PROFILER_RDTSC
+    const std::int64_t elapsed_ticks = ticks() - epoch_ticks_;
+    const std::int64_t elapsed_ns = now_ns();
+    return elapsed_ns > 0 && elapsed_ticks > 0 ? static_cast<double>(elapsed_ticks) / static_cast<double>(elapsed_ns) : 1.0;
+#else
+    using TickPeriod = Clock::period;
+    return static_cast<double>(TickPeriod::den) / (static_cast<double>(TickPeriod::num) * 1e9);
+#endif
+}
+
+Profiler::ThreadBuffer& Profiler::open_zone(std::uint32_t& depth)
+{
+    ThreadBuffer& buffer = thread_buffer();
+    depth = buffer.open_zones++;
+    return buffer;
+}
+
+void Profiler::close_zone(ThreadBuffer& buffer, const char* name, const std::int64_t start_ticks, const std::uint32_t depth)
+{
+    const std::int64_t end_ticks = ticks();
+    buffer.open_zones--;
+
+    const std::uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    ThreadBuffer::Slot& slot = buffer.slots[index % ZONES_PER_THREAD];
+
+    // The slot still holds zone index - ZONES_PER_THREAD. A reader that sees any field of the new zone must
+    // also see written at index or later, or it would keep the old zone torn. Pairs with the fence in collect
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ticks.store(start_ticks, std::memory_order_relaxed);
+    slot.end_ticks.store(end_ticks, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+
+    // Publishes the zone only once all of its fields are written
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::collect(std::vector<ProfileZone>& zones, const std::int64_t since_ns) const
+{
+    const double scale = 1.0 / ticks_per_ns();
+    const auto to_ns = [&](const std::int64_t tick) { return static_cast<std::int64_t>(static_cast<double>(tick - epoch_ticks_) * scale); };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<std::uint64_t, ProfileZone>> copied;
+    for (const auto& buffer : buffers_)
+    {
+        const std::uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const std::uint64_t first = written > ZONES_PER_THREAD ? written - ZONES_PER_THREAD : 0;
+
+        copied.clear();
+        for (std::uint64_t i = first; i < written; i++)
+        {
+            const ThreadBuffer::Slot& slot = buffer->slots[i % ZONES_PER_THREAD];
+            ProfileZone zone;
+            zone.end_ns = to_ns(slot.end_ticks.load(std::memory_order_relaxed));
+            if (zone.end_ns < since_ns) continue;
+            zone.name = slot.name.load(std::memory_order_relaxed);
+            zone.start_ns = to_ns(slot.start_ticks.load(std::memory_order_relaxed));
+            zone.depth = slot.depth.load(std::memory_order_relaxed);
+            zone.thread = buffer->index;
+            copied.emplace_back(i, zone);
+        }
+
+        // The owner may have lapped the oldest slots while they were copied. Slot i is only intact if the
+        // owner hasn't started writing zone i + ZONES_PER_THREAD, which is at most the newest count. The fence
+        // keeps the slot loads above from moving past the recount, and pairs with the one in close_zone
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t written_after = buffer->written.load(std::memory_order_acquire);
+        const std::uint64_t intact = written_after >= ZONES_PER_THREAD ? written_after - ZONES_PER_THREAD + 1 : 0;
+        for (const auto& [i, zone] : copied)
+        {
+            if (i >= intact) zones.push_back(zone);
+        }
+    }
+}
+
+bool Profiler::write_chrome_trace(const std::string& filename) const
+{
+    std::ofstream out(filename);
+    if (!out.is_open()) return false;
+
+    std::vector<ProfileZone> zones;
+    collect(zones);
+    const std::vector<std::string> names = thread_names();
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (std::size_t t = 0; t < names.size(); t++)
+    {
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+            << ",\"args\":{\"name\":";
+        write_json_string(out, names[t]);
+        out << "}}";
+        first = false;
+    }
+
+    // Complete events, timestamps in microseconds
+    out << std::fixed << std::setprecision(3);
+    for (const ProfileZone& zone : zones)
+    {
+        out << (first ? "" : ",") << "\n{\"name\":";
+        write_json_string(out, zone.name);
+        out << ",\"cat\":\"vectra\",\"ph\":\"X\",\"pid\":1,\"tid\":" << zone.thread
+            << ",\"ts\":" << static_cast<double>(zone.start_ns) / 1000.0
+            << ",\"dur\":" << static_cast<double>(zone.end_ns - zone.start_ns) / 1000.0 << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
+
+Profiler::ThreadBuffer& Profiler::thread_buffer()
+{
+    thread_local ThreadBufferOwner owner;
+    if (!owner.buffer) owner.buffer = &acquire_buffer();
+    return *owner.buffer;
+}
+
+Profiler::ThreadBuffer& Profiler::acquire_buffer()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& buffer : buffers_)
+    {
+        if (buffer->in_use) continue;
+        buffer->in_use = true;
+        buffer->name = "Thread " + std::to_string(buffer->index);
+        return *buffer;
+    }
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->index = static_cast<std::uint32_t>(buffers_.size());
+    buffer->name = "Thread " + std::to_string(buffer->index);
+    buffer->in_use = true;
+    buffers_.push_back(std::move(buffer));
+    return *buffers_.back();
+}
+
+void Profiler::release_buffer(ThreadBuffer& buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer.in_use = false;
+}
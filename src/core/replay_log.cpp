@@ -0,0 +1,497 @@
+#include "vectra/core/replay_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "vectra/core/job_system.h"
+
+namespace
+{
+    constexpr char MAGIC[4] = {'V', 'R', 'P', 'L'};
+    constexpr std::uint8_t VERSION = 1;
+
+    enum ReplayEvent : std::uint8_t
+    {
+        EVENT_END,
+        EVENT_SCENE,
+        EVENT_STEPS,
+        EVENT_DT,
+        EVENT_SPEED,
+        EVENT_PAUSE,
+        EVENT_RESUME,
+        EVENT_FORCE,
+        EVENT_CHECKSUM
+    };
+
+    // SCENE settings flags
+    constexpr std::uint8_t FLAG_SLEEPING = 1;
+    constexpr std::uint8_t FLAG_CONTINUOUS_COLLISION = 2;
+
+    using RealBits = std::conditional_t<sizeof(linkit::real) == 8, std::uint64_t, std::uint32_t>;
+    static_assert(sizeof(RealBits) == sizeof(linkit::real), "linkit::real must be a float or a double");
+
+    void write_varint(std::ostream& out, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.put(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.put(static_cast<char>(value));
+    }
+
+    bool read_varint(std::istream& in, std::uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const int byte = in.get();
+            if (byte == std::char_traits<char>::eof()) return false;
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    void write_fixed(std::ostream& out, const std::uint64_t bits, const std::size_t bytes)
+    {
+        for (std::size_t i = 0; i < bytes; i++) out.put(static_cast<char>((bits >> (8 * i)) & 0xff));
+    }
+
+    bool read_fixed(std::istream& in, std::uint64_t& bits, const std::size_t bytes)
+    {
+        bits = 0;
+        for (std::size_t i = 0; i < bytes; i++)
+        {
+            const int byte = in.get();
+            if (byte == std::char_traits<char>::eof()) return false;
+            bits |= static_cast<std::uint64_t>(byte) << (8 * i);
+        }
+        return true;
+    }
+
+    void write_real(std::ostream& out, const linkit::real value)
+    {
+        RealBits bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_fixed(out, bits, sizeof(bits));
+    }
+
+    bool read_real(std::istream& in, linkit::real& value)
+    {
+        std::uint64_t bits;
+        if (!read_fixed(in, bits, sizeof(RealBits))) return false;
+        const auto narrowed = static_cast<RealBits>(bits);
+        std::memcpy(&value, &narrowed, sizeof(value));
+        return true;
+    }
+
+    void write_vector(std::ostream& out, const linkit::Vector3& vector)
+    {
+        write_real(out, vector.x);
+        write_real(out, vector.y);
+        write_real(out, vector.z);
+    }
+
+    bool read_vector(std::istream& in, linkit::Vector3& vector)
+    {
+        return read_real(in, vector.x) && read_real(in, vector.y) && read_real(in, vector.z);
+    }
+
+    void write_string(std::ostream& out, const std::string& text)
+    {
+        write_varint(out, text.size());
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    bool read_string(std::istream& in, std::string& text)
+    {
+        std::uint64_t size;
+        if (!read_varint(in, size)) return false;
+        text.resize(size);
+        return static_cast<bool>(in.read(text.data(), static_cast<std::streamsize>(size)));
+    }
+
+    class StateHash
+    {
+        public:
+            std::uint64_t value = 14695981039346656037ull;
+
+            void add(const linkit::real real)
+            {
+                unsigned char bytes[sizeof(linkit::real)];
+                std::memcpy(bytes, &real, sizeof(bytes));
+                for (const unsigned char byte : bytes)
+                {
+                    value ^= byte;
+                    value *= 1099511628211ull;
+                }
+            }
+
+            void add(const linkit::Vector3& vector)
+            {
+                add(vector.x);
+                add(vector.y);
+                add(vector.z);
+            }
+
+            void add(const linkit::Quaternion& quaternion)
+            {
+                add(quaternion.w);
+                add(quaternion.x);
+                add(quaternion.y);
+                add(quaternion.z);
+            }
+
+            template<typename T>
+            void add(const std::vector<T>& values)
+            {
+                for (const T& item : values) add(item);
+            }
+    };
+}
+
+std::uint64_t scene_state_hash(const Scene& scene)
+{
+    const PhysicsWorld& world = scene.physics_world;
+    StateHash hash;
+    hash.add(world.positions);
+    hash.add(world.orientations);
+    hash.add(world.velocities);
+    hash.add(world.angular_velocities);
+    for (const SoftBody& soft_body : scene.soft_bodies)
+    {
+        hash.add(soft_body.positions);
+        hash.add(soft_body.velocities);
+    }
+    for (const ParticleSystem& particles : scene.particle_systems)
+    {
+        hash.add(particles.positions);
+        hash.add(particles.velocities);
+    }
+    return hash.value;
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+    close();
+}
+
+bool ReplayRecorder::open(const std::string& filename)
+{
+    std::lock_guard lock(mutex_);
+    if (out_.is_open()) out_.close();
+    out_.open(filename, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) return false;
+
+    out_.write(MAGIC, sizeof(MAGIC));
+    out_.put(static_cast<char>(VERSION));
+    out_.put(static_cast<char>(sizeof(linkit::real)));
+    write_fixed(out_, JobSystem::instance().thread_count(), 4);
+    pending_steps_ = 0;
+    steps_since_checksum_ = 0;
+    has_dt_ = false;
+    has_speed_ = false;
+    return true;
+}
+
+bool ReplayRecorder::is_open() const
+{
+    std::lock_guard lock(mutex_);
+    return out_.is_open();
+}
+
+void ReplayRecorder::close()
+{
+    std::lock_guard lock(mutex_);
+    if (!out_.is_open()) return;
+    flush_steps();
+    out_.put(EVENT_END);
+    out_.close();
+}
+
+void ReplayRecorder::record_scene(const json& scene_data, const std::string& name, const EngineState& state,
+                                  const Scene& scene)
+{
+    std::lock_guard lock(mutex_);
+    if (!out_.is_open()) return;
+    flush_steps();
+
+    out_.put(EVENT_SCENE);
+    write_string(out_, name);
+    write_varint(out_, static_cast<std::uint64_t>(std::max(0, state.max_collision_contacts)));
+    write_varint(out_, static_cast<std::uint64_t>(std::max(1, state.physics_substeps)));
+    std::uint8_t flags = 0;
+    if (state.allow_sleeping) flags |= FLAG_SLEEPING;
+    if (state.continuous_collision) flags |= FLAG_CONTINUOUS_COLLISION;
+    out_.put(static_cast<char>(flags));
+    const std::vector<std::uint8_t> cbor = json::to_cbor(scene_data);
+    write_varint(out_, cbor.size());
+    out_.write(reinterpret_cast<const char*>(cbor.data()), static_cast<std::streamsize>(cbor.size()));
+
+    // Checks that loading the scene back gives the same starting state
+    write_checksum(scene);
+}
+
+void ReplayRecorder::record_step(const linkit::real dt, const linkit::real speed, const Scene& scene)
+{
+    std::lock_guard lock(mutex_);
+    if (!out_.is_open()) return;
+
+    if (!has_dt_ || dt != dt_)
+    {
+        flush_steps();
+        out_.put(EVENT_DT);
+        write_real(out_, dt);
+        has_dt_ = true;
+        dt_ = dt;
+    }
+    if (!has_speed_ || speed != speed_)
+    {
+        flush_steps();
+        out_.put(EVENT_SPEED);
+        write_real(out_, speed);
+        has_speed_ = true;
+        speed_ = speed;
+    }
+
+    pending_steps_++;
+    if (checksum_interval > 0 && ++steps_since_checksum_ >= checksum_interval)
+    {
+        flush_steps();
+        write_checksum(scene);
+    }
+}
+
+void ReplayRecorder::record_pause(const bool paused)
+{
+    std::lock_guard lock(mutex_);
+    if (!out_.is_open()) return;
+    flush_steps();
+    out_.put(paused ? EVENT_PAUSE : EVENT_RESUME);
+}
+
+void ReplayRecorder::record_force(const std::size_t object_index, const linkit::Vector3& force)
+{
+    std::lock_guard lock(mutex_);
+    if (!out_.is_open()) return;
+    flush_steps();
+    out_.put(EVENT_FORCE);
+    write_varint(out_, object_index);
+    write_vector(out_, force);
+}
+
+void ReplayRecorder::flush_steps()
+{
+    if (pending_steps_ == 0) return;
+    out_.put(EVENT_STEPS);
+    write_varint(out_, pending_steps_);
+    pending_steps_ = 0;
+}
+
+// Also flushes the file, so a crashed run loses at most one checksum interval
+void ReplayRecorder::write_checksum(const Scene& scene)
+{
+    out_.put(EVENT_CHECKSUM);
+    write_fixed(out_, scene_state_hash(scene), 8);
+    steps_since_checksum_ = 0;
+    out_.flush();
+}
+
+bool ReplayPlayer::open(const std::string& filename)
+{
+    in_.open(filename, std::ios::binary);
+    if (!in_.is_open())
+    {
+        message_ = "Could not open " + filename;
+        return false;
+    }
+
+    char magic[sizeof(MAGIC)];
+    const int version = in_.read(magic, sizeof(magic)) ? in_.get() : -1;
+    const int real_size = in_.get();
+    std::uint64_t threads;
+    if (!read_fixed(in_, threads, 4) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        message_ = filename + " is not a replay log";
+        return false;
+    }
+    if (version != VERSION)
+    {
+        message_ = filename + " is a version " + std::to_string(version) + " replay log, this build reads version " +
+                   std::to_string(VERSION);
+        return false;
+    }
+    if (real_size != sizeof(linkit::real))
+    {
+        message_ = filename + " was recorded with " + std::to_string(real_size) + " byte reals, this build uses " +
+                   std::to_string(sizeof(linkit::real));
+        return false;
+    }
+    threads_ = static_cast<std::uint32_t>(threads);
+    return true;
+}
+
+std::uint32_t ReplayPlayer::recorded_threads() const
+{
+    return threads_;
+}
+
+const std::string& ReplayPlayer::message() const
+{
+    return message_;
+}
+
+const Scene* ReplayPlayer::scene() const
+{
+    return scene_.get();
+}
+
+ReplayResult ReplayPlayer::run(const std::function<void(const Scene& scene, std::uint64_t step)>& on_step)
+{
+    using Clock = std::chrono::steady_clock;
+
+    ReplayResult result;
+    linkit::real dt = 0.0;
+    bool has_dt = false;
+    const auto start = Clock::now();
+    const auto finish = [&](const bool succeeded, const std::string& message)
+    {
+        result.succeeded = succeeded;
+        result.message = message;
+        result.wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        return result;
+    };
+
+    if (!in_.is_open()) return finish(false, message_.empty() ? "No replay log is open" : message_);
+
+    while (true)
+    {
+        const int event = in_.get();
+        if (event == std::char_traits<char>::eof())
+        {
+            // A run that crashed leaves no END, everything up to its last checksum is still worth replaying
+            return finish(true, "The log ends without END, the recording was cut short");
+        }
+        if (event != EVENT_SCENE && event != EVENT_END && !scene_)
+        {
+            return finish(false, "The log doesn't start with a scene");
+        }
+
+        switch (event)
+        {
+            case EVENT_END:
+                return finish(true, "");
+
+            case EVENT_SCENE:
+            {
+                std::string name;
+                std::uint64_t max_contacts, substeps, cbor_size;
+                if (!read_string(in_, name) || !read_varint(in_, max_contacts) || !read_varint(in_, substeps))
+                {
+                    return finish(false, "The log is truncated in a scene");
+                }
+                const int flags = in_.get();
+                if (flags == std::char_traits<char>::eof() || !read_varint(in_, cbor_size))
+                {
+                    return finish(false, "The log is truncated in a scene");
+                }
+                std::vector<std::uint8_t> cbor(cbor_size);
+                if (!in_.read(reinterpret_cast<char*>(cbor.data()), static_cast<std::streamsize>(cbor_size)))
+                {
+                    return finish(false, "The log is truncated in a scene");
+                }
+
+                SceneLoadResult loaded;
+                try
+                {
+                    loaded = serializer_.deserialize_scene_json(json::from_cbor(cbor), name);
+                }
+                catch (const std::exception& e)
+                {
+                    return finish(false, "Invalid scene " + name + " in the log: " + e.what());
+                }
+                if (loaded.has_errors()) return finish(false, "Could not load " + name + ": " + loaded.errors.front());
+
+                EngineState state;
+                state.max_collision_contacts = static_cast<int>(max_contacts);
+                state.physics_substeps = static_cast<int>(substeps);
+                state.allow_sleeping = flags & FLAG_SLEEPING;
+                state.continuous_collision = flags & FLAG_CONTINUOUS_COLLISION;
+                state.loaded_scene = name;
+                scene_ = std::make_unique<Scene>(std::move(loaded.scene));
+                scene_->set_from_engine_state(state);
+                result.scenes++;
+                break;
+            }
+
+            case EVENT_STEPS:
+            {
+                std::uint64_t count;
+                if (!read_varint(in_, count)) return finish(false, "The log is truncated in a STEPS event");
+                if (!has_dt) return finish(false, "Steps before any DT event");
+                for (std::uint64_t i = 0; i < count; i++)
+                {
+                    scene_->step(dt);
+                    result.steps++;
+                    result.simulated_time += dt;
+                    if (on_step) on_step(*scene_, result.steps);
+                }
+                break;
+            }
+
+            case EVENT_DT:
+                if (!read_real(in_, dt)) return finish(false, "The log is truncated in a DT event");
+                has_dt = true;
+                break;
+
+            case EVENT_SPEED:
+            {
+                linkit::real speed;
+                if (!read_real(in_, speed)) return finish(false, "The log is truncated in a SPEED event");
+                break;
+            }
+
+            case EVENT_PAUSE:
+                result.pauses++;
+                break;
+
+            case EVENT_RESUME:
+                break;
+
+            case EVENT_FORCE:
+            {
+                std::uint64_t object_index;
+                linkit::Vector3 force;
+                if (!read_varint(in_, object_index) || !read_vector(in_, force))
+                {
+                    return finish(false, "The log is truncated in a FORCE event");
+                }
+                scene_->apply_force(object_index, force);
+                result.forces++;
+                break;
+            }
+
+            case EVENT_CHECKSUM:
+            {
+                std::uint64_t recorded;
+                if (!read_fixed(in_, recorded, 8)) return finish(false, "The log is truncated in a CHECKSUM event");
+                if (recorded != scene_state_hash(*scene_))
+                {
+                    result.mismatch_step = static_cast<std::int64_t>(result.steps);
+                    return finish(false, "The state differs from the recording after step " +
+                                         std::to_string(result.steps));
+                }
+                result.checksums++;
+                break;
+            }
+
+            default:
+                return finish(false, "Unknown event " + std::to_string(event) + " in the log");
+        }
+    }
+}
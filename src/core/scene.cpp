@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cassert>
 #include <vector>
 #include <deque>
 #include <unordered_map>
@@ -8,9 +10,16 @@
 #include "vectra/rendering/camera.h"
 
 
+#include "vectra/core/job_system.h"
+#include "vectra/core/profiler.h"
 #include "vectra/physics/BVHNode.h"
-#include "vectra/physics/forces/anchored_spring.h"
-#include "vectra/physics/forces/object_anchored_spring.h"
+#include "vectra/physics/parallel.h"
+
+namespace
+{
+    // Copying a pose takes a few nanoseconds
+    constexpr std::size_t MIN_OBJECTS_PER_THREAD = 16384;
+}
 
 Scene::Scene()
 {
@@ -18,9 +27,7 @@ Scene::Scene()
 
     camera = Camera();
     force_registry = ForceRegistry();
-    skybox = Skybox();
     bvh_root = nullptr;
-    bvh_node_map = std::unordered_map<GameObject*, BVHNode<BoundingSphere>*>();
     collision_handler = CollisionHandler();
     name_counters_ = std::unordered_map<std::string, int>();
     name = "New Scene";
@@ -29,7 +36,7 @@ Scene::Scene()
 // In Scene class (private):
 void Scene::rebuild_bvh_node_map()
 {
-    bvh_node_map.clear();
+    bvh_leaves_.assign(physics_world.size(), nullptr);
     if (!bvh_root) return;
     std::vector<BVHNode<BoundingSphere>*> stack{ bvh_root.get() };
     while (!stack.empty())
@@ -37,7 +44,7 @@ void Scene::rebuild_bvh_node_map()
         auto* n = stack.back(); stack.pop_back();
         if (!n) continue;
         if (n->is_leaf() && n->object)
-            bvh_node_map[n->object] = n;
+            bvh_leaves_[n->object->body] = n;
         else
         {
             stack.push_back(n->children[0]);
@@ -49,6 +56,8 @@ void Scene::rebuild_bvh_node_map()
 // add_game_object
 void Scene::add_game_object(GameObject obj)
 {
+    object_table_.reset();
+
     // Auto-generate name if isn't set
     if (obj.name.empty())
     {
@@ -70,6 +79,9 @@ void Scene::add_game_object(GameObject obj)
         obj.rb.set_inverse_inertia_tensor(obj.rb.cuboid_inertia_tensor());
     }
 
+    obj.body = physics_world.add_body(obj.rb);
+    body_core_radii_.push_back(CollisionHandler::core_radius(obj.get_collider()));
+
     // Compute bounding info before moving the object
     linkit::real radius = obj.rb.transform.scale.magnitude();
     auto position = obj.rb.transform.position;
@@ -94,25 +106,44 @@ void Scene::add_game_object(GameObject obj)
         leaf = bvh_root->insert(new_obj_ptr, new_volume); // now returns the leaf
     }
 
-    // Rebuild map so the old object (split into children[0]) is re-mapped correctly
-    rebuild_bvh_node_map();
+    // Inserting split a leaf, whose object moved into children[0]. Only those two leaves need re-mapping,
+    // rebuilding the whole map made adding N objects O(N^2)
+    assert(!leaf->parent || leaf->parent->children[1] == leaf);
+    bvh_leaves_.resize(physics_world.size(), nullptr);
+    bvh_leaves_[new_obj_ptr->body] = leaf;
+    if (leaf->parent)
+    {
+        BVHNode<BoundingSphere>* sibling = leaf->parent->children[0];
+        bvh_leaves_[sibling->object->body] = sibling;
+    }
 }
 
 // update_bvh
 void Scene::update_bvh()
 {
     if (!bvh_root) return;
+    VECTRA_PROFILE_SCOPE("Update BVH");
 
     for (auto& obj : game_objects)
     {
-        if (!obj.rb.has_moved) continue;
+        if (!physics_world.has_moved[obj.body]) continue;
 
-        auto it = bvh_node_map.find(&obj);
-        if (it == bvh_node_map.end() || !it->second) continue;
-
-        auto* node = it->second; // this is the leaf
+        auto* node = bvh_leaves_[obj.body]; // this is the leaf
+        if (!node) continue;
         // Update leaf’s volume and refit upwards
-        node->bounding_volume->center = obj.rb.transform.position;
+        if (collision_handler.continuous_collision)
+        {
+            // Cover the whole path travelled this step so bodies that crossed each other still pair up
+            const linkit::real radius = obj.rb.transform.scale.magnitude();
+            *node->bounding_volume = BoundingSphere(
+                BoundingSphere(physics_world.previous_positions[obj.body], radius),
+                BoundingSphere(physics_world.positions[obj.body], radius)
+            );
+        }
+        else
+        {
+            node->bounding_volume->center = physics_world.positions[obj.body];
+        }
         // node->bounding_volume->radius = ...; // if radius may change
         node->recalc_upwards();
     }
@@ -135,71 +166,280 @@ void Scene::add_spot_light(const SpotLight& light)
 }
 
 
+void Scene::apply_force(const std::size_t object_index, const linkit::Vector3& force)
+{
+    if (object_index >= game_objects.size()) return;
+    const BodyHandle body = game_objects[object_index].body;
+    if (physics_world.has_finite_mass(body)) physics_world.set_awake(body, true);
+    external_forces_.emplace_back(body, force);
+}
+
+// Before the spring network, which folds every force already accumulated into its solve
+void Scene::add_external_forces()
+{
+    for (const auto& [body, force] : external_forces_) physics_world.add_force(body, force);
+}
+
+// Colliders and rendering read the GameObject transform, so mirror the simulated pose into it
+void Scene::sync_transforms()
+{
+    parallel_for(game_objects.size(), MIN_OBJECTS_PER_THREAD, [&](const std::size_t i)
+    {
+        GameObject& obj = game_objects[i];
+        physics_world.write_pose(obj.body, obj.rb.transform);
+    });
+}
+
 void Scene::step(const linkit::real dt)
 {
-    update_bvh();
+    VECTRA_PROFILE_SCOPE("Scene::step");
+    if (substeps_ > 1)
+    {
+        step_substepped(dt);
+        return;
+    }
+
+    // Swept volumes span this step's motion, so with continuous collision the tree is refit after integrating
+    const bool swept = collision_handler.continuous_collision;
+    if (!swept) update_bvh();
 
-    for (auto& obj : game_objects)
     {
-        obj.rb.clear_accumulators();
+        VECTRA_PROFILE_SCOPE("Forces");
+        physics_world.clear_accumulators();
+        force_registry.update_forces(physics_world, dt);
+        add_external_forces();
+        spring_network.solve(physics_world, dt);
+    }
+    {
+        VECTRA_PROFILE_SCOPE("Integrate");
+        physics_world.integrate(dt);
+        sync_transforms();
     }
 
-    force_registry.update_forces(dt);
+    if (swept) update_bvh();
 
-    for (auto& obj : game_objects)
+    std::vector<PotentialContact> possible_contacts;
+    {
+        VECTRA_PROFILE_SCOPE("Broad phase");
+        possible_contacts = bvh_root->potential_contacts_inside(std::move(possible_contacts), max_collision_contacts_);
+    }
+    {
+        VECTRA_PROFILE_SCOPE("Narrow phase");
+        collision_handler.narrow_phase(possible_contacts, physics_world);
+        if (swept) collision_handler.continuous_phase(physics_world);
+    }
+    {
+        VECTRA_PROFILE_SCOPE("Solve contacts");
+        collision_handler.solve_contacts(physics_world);
+        collision_handler.resolve_interpretations(physics_world);
+    }
     {
-        obj.rb.step(dt);
+        VECTRA_PROFILE_SCOPE("Sleep");
+        physics_world.update_sleep_states(dt);
+        sync_transforms();
     }
+    finish_step(dt);
+}
 
+// Broad and narrow phase run once per tick; the cached contacts are then advanced from body
+// motion through several cheap integrate + relax sub-steps
+void Scene::step_substepped(const linkit::real dt)
+{
+    update_bvh();
 
     std::vector<PotentialContact> possible_contacts;
-    possible_contacts = bvh_root->potential_contacts_inside(possible_contacts, max_collision_contacts_);
-    collision_handler.narrow_phase(possible_contacts);
-    collision_handler.solve_contacts();
-    collision_handler.resolve_interpretations();
+    {
+        VECTRA_PROFILE_SCOPE("Broad phase");
+        possible_contacts = bvh_root->potential_contacts_inside(std::move(possible_contacts), max_collision_contacts_);
+    }
+    {
+        VECTRA_PROFILE_SCOPE("Narrow phase");
+        // No continuous phase runs here, so fast pairs are tested discretely rather than left for one
+        collision_handler.narrow_phase(possible_contacts, physics_world, false);
+        collision_handler.cache_contact_state(physics_world);
+    }
 
+    const linkit::real sub_dt = dt / substeps_;
+    for (int i = 0; i < substeps_; i++)
+    {
+        VECTRA_PROFILE_SCOPE("Substep");
+        physics_world.clear_accumulators();
+        force_registry.update_forces(physics_world, sub_dt);
+        add_external_forces();
+        spring_network.solve(physics_world, sub_dt);
+        physics_world.integrate(sub_dt);
+
+        collision_handler.update_contact_separation(physics_world);
+        collision_handler.solve_contacts(physics_world);
+        collision_handler.resolve_interpretations(physics_world);
+    }
+    {
+        VECTRA_PROFILE_SCOPE("Sleep");
+        physics_world.update_sleep_states(dt);
+        sync_transforms();
+    }
+    finish_step(dt);
+}
 
-    collision_handler.clear_contacts();
+// Soft bodies, particle systems and the step measures only read the rigid bodies, so they run side by side.
+// The contacts are cleared once the measures have read them
+void Scene::finish_step(const linkit::real dt)
+{
+    VECTRA_PROFILE_SCOPE("Finish step");
+    JobSystem& jobs = JobSystem::instance();
+    const JobHandle soft_bodies_job = jobs.schedule([this, dt] { step_soft_bodies(dt); });
+    const JobHandle particles_job = jobs.schedule([this, dt] { step_particle_systems(dt); });
+    const JobHandle measure_job = jobs.schedule([this, dt] { measure_step(dt); });
+    const JobHandle clear_job = jobs.then(measure_job, [this] { collision_handler.clear_contacts(); });
+    jobs.wait({soft_bodies_job, particles_job, clear_job});
+    external_forces_.clear();
+}
+
+// Soft bodies collide with the rigid bodies where they ended up this step
+void Scene::step_soft_bodies(const linkit::real dt)
+{
+    VECTRA_PROFILE_SCOPE("Soft bodies");
+    for (auto& soft_body : soft_bodies)
+    {
+        overlapping_objects_.clear();
+        if (bvh_root) bvh_root->query(soft_body.swept_bounds(dt), overlapping_objects_);
+        soft_body.step(dt, overlapping_objects_);
+    }
+}
+
+void Scene::step_particle_systems(const linkit::real dt)
+{
+    VECTRA_PROFILE_SCOPE("Particle systems");
+    for (auto& particle_system : particle_systems)
+    {
+        particle_system.advance(dt);
+
+        // Collisions are only resolved at the particles' new positions, so their bounds need no sweep
+        particle_overlaps_.clear();
+        if (bvh_root && particle_system.size() > 0) bvh_root->query(particle_system.bounds(), particle_overlaps_);
+        particle_system.collide(particle_overlaps_);
+    }
+}
+
+// Error measures for the adaptive step controller, taken while this step's contacts are still around
+void Scene::measure_step(const linkit::real dt)
+{
+    VECTRA_PROFILE_SCOPE("Measure step");
+    StepStats stats;
+    stats.dt = dt;
+
+    // Work the applied forces (gravity, springs, pushes) did this step. That change of kinetic energy is the
+    // simulation working, not error. The accumulators still hold the forces of the last integrate
+    linkit::real applied_work = 0;
+    for (const BodyHandle body : physics_world.active_bodies)
+    {
+        const linkit::real speed_squared = physics_world.velocities[body].magnitude_squared();
+        stats.kinetic_energy += static_cast<linkit::real>(0.5) * physics_world.masses[body] * speed_squared;
+        applied_work += physics_world.accumulated_forces[body] * physics_world.velocities[body] * dt;
+        if (body_core_radii_[body] > linkit::REAL_EPSILON)
+        {
+            stats.max_motion_ratio = std::max(stats.max_motion_ratio, linkit::real_sqrt(speed_squared) * dt / body_core_radii_[body]);
+        }
+    }
+
+    for (const auto& collision : collision_handler.collisions)
+    {
+        stats.contacts += collision.contacts.size();
+        for (const auto& contact : collision.contacts)
+        {
+            stats.max_penetration = std::max(stats.max_penetration, contact.penetration_depth);
+        }
+    }
+
+    // Measured against the recent peak (half-life of one second) rather than the current energy, so an
+    // oscillation passing through rest or bodies starting from rest don't read as a huge relative change
+    energy_scale_ = std::max({stats.kinetic_energy, energy_scale_ * linkit::real_pow(0.5, dt), static_cast<linkit::real>(1)});
+    stats.energy_drift = linkit::real_abs(stats.kinetic_energy - last_step_stats_.kinetic_energy - applied_work) / energy_scale_;
+
+    last_step_stats_ = stats;
+}
+
+const StepStats& Scene::last_step_stats() const
+{
+    return last_step_stats_;
 }
 
 void Scene::set_from_engine_state(const EngineState& state)
 {
     max_collision_contacts_ = state.max_collision_contacts;
+    physics_world.allow_sleeping = state.allow_sleeping;
+    substeps_ = state.physics_substeps;
+    collision_handler.continuous_collision = state.continuous_collision;
 }
 
-SceneSnapshot Scene::create_snapshot() const
+const std::shared_ptr<const SnapshotObjectTable>& Scene::object_table() const
 {
-    SceneSnapshot snapshot;
+    if (object_table_ && object_table_->names.size() == game_objects.size()) return object_table_;
+
+    auto table = std::make_shared<SnapshotObjectTable>();
+    std::unordered_map<std::string, std::uint32_t> model_ids;
+    table->names.reserve(game_objects.size());
+    table->model_ids.reserve(game_objects.size());
     for (const auto& obj : game_objects)
     {
-        GameObjectSnapshot obj_snapshot;
-        obj_snapshot.name = obj.name;
-        obj_snapshot.model_name = obj.model_name;
-        obj_snapshot.transform = obj.rb.transform;
-        obj_snapshot.force = obj.rb.accumulated_force;
-        obj_snapshot.has_spring = false;
-        std::vector<std::shared_ptr<ForceGenerator>> object_forces = force_registry.object_forces(const_cast<GameObject*>(&obj));
-        for (const auto& fg : object_forces)
-        {
-            if (auto spring = std::dynamic_pointer_cast<AnchoredSpring>(fg))
-            {
-                obj_snapshot.has_spring = true;
-                obj_snapshot.spring_anchor = spring->get_anchor_point();
-                break;
-            }
-            else if (auto obj_spring = std::dynamic_pointer_cast<ObjectAnchoredSpring>(fg))
-            {
-                obj_snapshot.has_spring = true;
-                obj_snapshot.spring_anchor = obj_spring->get_anchor_point();
-                break;
-            }
-        }
+        const auto found = model_ids.try_emplace(obj.model_name, static_cast<std::uint32_t>(table->model_names.size()));
+        if (found.second) table->model_names.push_back(obj.model_name);
+        table->names.push_back(obj.name);
+        table->model_ids.push_back(found.first->second);
+    }
+    object_table_ = std::move(table);
+    return object_table_;
+}
 
-        snapshot.object_snapshots.push_back(obj_snapshot);
+void Scene::create_snapshot(SceneSnapshot& snapshot) const
+{
+    VECTRA_PROFILE_SCOPE("Scene::create_snapshot");
+    // Only grows the buffers, a reused snapshot keeps its capacity
+    const std::size_t count = game_objects.size();
+    snapshot.object_table = object_table();
+    snapshot.model_matrices.resize(16 * count);
+    snapshot.transforms.resize(count);
+    snapshot.forces.resize(count);
+    snapshot.has_spring.resize(count);
+    snapshot.spring_anchors.resize(count);
+
+    std::size_t id = 0;
+    for (const auto& obj : game_objects)
+    {
+        snapshot.transforms[id] = obj.rb.transform;
+        write_model_matrix(obj.rb.transform, &snapshot.model_matrices[16 * id]);
+        snapshot.forces[id] = physics_world.accumulated_forces[obj.body];
+        snapshot.has_spring[id] = force_registry.spring_anchor(obj.body, snapshot.spring_anchors[id]);
+        id++;
     }
     snapshot.bvh_root = bvh_root.get();
 
+    snapshot.soft_body_snapshots.resize(soft_bodies.size());
+    for (std::size_t s = 0; s < soft_bodies.size(); s++)
+    {
+        snapshot.soft_body_snapshots[s].positions.assign(soft_bodies[s].positions.begin(), soft_bodies[s].positions.end());
+        snapshot.soft_body_snapshots[s].triangles = soft_bodies[s].triangles;
+    }
 
+    snapshot.particle_snapshots.resize(particle_systems.size());
+    for (std::size_t s = 0; s < particle_systems.size(); s++)
+    {
+        const ParticleSystem& particle_system = particle_systems[s];
+        std::vector<float>& instances = snapshot.particle_snapshots[s].instances;
+        instances.resize(4 * particle_system.size());
+        for (std::size_t i = 0; i < particle_system.size(); i++)
+        {
+            instances[4 * i] = static_cast<float>(particle_system.positions[i].x);
+            instances[4 * i + 1] = static_cast<float>(particle_system.positions[i].y);
+            instances[4 * i + 2] = static_cast<float>(particle_system.positions[i].z);
+            instances[4 * i + 3] = static_cast<float>(particle_system.radii[i]);
+        }
+    }
+}
 
+SceneSnapshot Scene::create_snapshot() const
+{
+    SceneSnapshot snapshot;
+    create_snapshot(snapshot);
     return snapshot;
 }
@@ -2,13 +2,19 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <memory>
+#include <optional>
+#include <tuple>
 
 #include "linkit/linkit.h"
 
 #include "vectra/core/gameobject.h"
+#include "vectra/core/job_system.h"
 
+#include "vectra/physics/particle_system.h"
 #include "vectra/physics/rigidbody.h"
+#include "vectra/physics/soft_body.h"
 #include "vectra/physics/forces/simple_gravity.h"
 #include "vectra/physics/forces/newtonian_gravity.h"
 #include "vectra/physics/forces/anchored_spring.h"
@@ -550,6 +556,12 @@ void simple_gravity_from_json(const json &j, SimpleGravity &gravity)
 }
 
 // NewtonianGravity
+NLOHMANN_JSON_SERIALIZE_ENUM(GravityMethod, {
+    {GravityMethod::PER_BODY, "per_body"},
+    {GravityMethod::ALL_PAIRS, "all_pairs"},
+    {GravityMethod::BARNES_HUT, "barnes_hut"},
+})
+
 void newtonian_gravity_to_json(json &j, const NewtonianGravity &gravity, const Scene &scene)
 {
     std::vector<int> affect_object_indices;
@@ -568,7 +580,10 @@ void newtonian_gravity_to_json(json &j, const NewtonianGravity &gravity, const S
     j = json{
         {"type", "newtonian_gravity"},
         {"gravitational_constant", gravity.gravitational_constant},
-        {"affected_object_indices", affect_object_indices}
+        {"affected_object_indices", affect_object_indices},
+        {"method", gravity.method},
+        {"opening_angle", gravity.opening_angle},
+        {"softening", gravity.softening}
     };
 }
 
@@ -584,6 +599,14 @@ bool newtonian_gravity_from_json(const json &j, NewtonianGravity &gravity, Scene
     else
         gravity.gravitational_constant = 0;
 
+    // Per-body direct summation by default
+    if (j.contains("method"))
+        j.at("method").get_to(gravity.method);
+    if (j.contains("opening_angle"))
+        j.at("opening_angle").get_to(gravity.opening_angle);
+    if (j.contains("softening"))
+        j.at("softening").get_to(gravity.softening);
+
     if (!j.contains("affected_object_indices"))
     {
         emit_warning("Warning: newtonian_gravity on object '" + object_name + "' has no affected_object_indices, skipping");
@@ -721,6 +744,243 @@ bool object_anchored_spring_from_json(const json &j, ObjectAnchoredSpring &sprin
     return true;
 }
 
+// NetworkSpring, stored on its first object
+void network_spring_to_json(json &j, const NetworkSpring &spring, const Scene &scene)
+{
+    int object_index = -1;
+    for (int i = 0; i < scene.game_objects.size(); ++i)
+    {
+        if (&scene.game_objects[i] == spring.second)
+        {
+            object_index = i;
+            break;
+        }
+    }
+    j = json{
+        {"type", "implicit_spring"},
+        {"object_index", object_index},
+        {"spring_constant", spring.spring_constant},
+        {"rest_length", spring.rest_length},
+        {"damping", spring.damping}
+    };
+}
+
+/**
+ * Deserialize the second object and parameters of a NetworkSpring from JSON.
+ * Returns false if the spring should be skipped (invalid object).
+ */
+bool network_spring_from_json(const json &j, NetworkSpring &spring, const Scene &scene, const std::string& object_name)
+{
+    // object_index is required
+    if (!j.contains("object_index"))
+    {
+        emit_warning("Warning: implicit_spring on object '" + object_name + "' has no object_index, skipping");
+        return false;
+    }
+
+    int object_index;
+    j.at("object_index").get_to(object_index);
+    if (object_index >= 0 && object_index < static_cast<int>(scene.game_objects.size()) &&
+        &scene.game_objects[object_index] != spring.first)
+    {
+        spring.second = const_cast<GameObject*>(&scene.game_objects[object_index]);
+    }
+    else
+    {
+        emit_warning("Warning: implicit_spring on object '" + object_name + "' has invalid object index " + std::to_string(object_index) + ", skipping");
+        return false;
+    }
+
+    // Default spring_constant is 0
+    if (j.contains("spring_constant"))
+        j.at("spring_constant").get_to(spring.spring_constant);
+    else
+        spring.spring_constant = 0;
+
+    // Default rest_length is 0
+    if (j.contains("rest_length"))
+        j.at("rest_length").get_to(spring.rest_length);
+    else
+        spring.rest_length = 0;
+
+    // Default damping is 0
+    if (j.contains("damping"))
+        j.at("damping").get_to(spring.damping);
+    else
+        spring.damping = 0;
+
+    return true;
+}
+
+// SoftBody, saved as the shape it was built from and its material, not the particles' current state
+NLOHMANN_JSON_SERIALIZE_ENUM(SoftBodyShape, {
+    {SoftBodyShape::CLOTH, "cloth"},
+    {SoftBodyShape::BLOCK, "block"},
+})
+
+inline void to_json(json &j, const SoftBody &soft_body)
+{
+    const SoftBodyDescription& description = soft_body.description;
+    std::vector<int> resolution(description.resolution.begin(), description.resolution.end());
+    if (description.shape == SoftBodyShape::CLOTH) resolution.pop_back();
+
+    j = json{
+        {"name", soft_body.name},
+        {"shape", description.shape},
+        {"origin", description.origin},
+        {"resolution", resolution},
+        {"spacing", description.spacing},
+        {"particle_mass", description.particle_mass},
+        {"pinned", description.pinned},
+        {"stretch_compliance", soft_body.stretch_compliance},
+        {"bending_compliance", soft_body.bending_compliance},
+        {"volume_compliance", soft_body.volume_compliance},
+        {"damping", soft_body.damping},
+        {"friction", soft_body.friction},
+        {"particle_radius", soft_body.particle_radius},
+        {"gravity", soft_body.gravity},
+        {"substeps", soft_body.substeps}
+    };
+}
+
+SoftBody soft_body_from_json(const json &j)
+{
+    // Default shape is a 16 x 16 cloth
+    SoftBodyDescription description;
+    if (j.contains("shape"))
+        j.at("shape").get_to(description.shape);
+    if (description.shape == SoftBodyShape::BLOCK)
+        description.resolution = {4, 4, 4};
+
+    if (j.contains("origin"))
+        j.at("origin").get_to(description.origin);
+
+    if (j.contains("resolution"))
+    {
+        const auto resolution = j.at("resolution").get<std::vector<int>>();
+        for (std::size_t i = 0; i < resolution.size() && i < description.resolution.size(); i++)
+            description.resolution[i] = resolution[i];
+    }
+
+    if (j.contains("spacing"))
+        j.at("spacing").get_to(description.spacing);
+
+    if (j.contains("particle_mass"))
+        j.at("particle_mass").get_to(description.particle_mass);
+
+    if (j.contains("pinned"))
+        j.at("pinned").get_to(description.pinned);
+
+    SoftBody soft_body(description);
+    if (j.contains("name"))
+        j.at("name").get_to(soft_body.name);
+    else
+        soft_body.name = description.shape == SoftBodyShape::BLOCK ? "Soft Block" : "Cloth";
+
+    // Material parameters keep the SoftBody defaults when missing
+    if (j.contains("stretch_compliance"))
+        j.at("stretch_compliance").get_to(soft_body.stretch_compliance);
+    if (j.contains("bending_compliance"))
+        j.at("bending_compliance").get_to(soft_body.bending_compliance);
+    if (j.contains("volume_compliance"))
+        j.at("volume_compliance").get_to(soft_body.volume_compliance);
+    if (j.contains("damping"))
+        j.at("damping").get_to(soft_body.damping);
+    if (j.contains("friction"))
+        j.at("friction").get_to(soft_body.friction);
+    if (j.contains("particle_radius"))
+        j.at("particle_radius").get_to(soft_body.particle_radius);
+    if (j.contains("gravity"))
+        j.at("gravity").get_to(soft_body.gravity);
+    if (j.contains("substeps"))
+        j.at("substeps").get_to(soft_body.substeps);
+
+    return soft_body;
+}
+
+// ParticleEmitter
+inline void to_json(json &j, const ParticleEmitter &emitter)
+{
+    j = json{
+        {"position", emitter.position},
+        {"direction", emitter.direction},
+        {"spread", emitter.spread},
+        {"speed", emitter.speed},
+        {"rate", emitter.rate},
+        {"burst", emitter.burst},
+        {"lifetime", emitter.lifetime},
+        {"radius", emitter.radius},
+        {"mass", emitter.mass}
+    };
+}
+
+inline void from_json(const json &j, ParticleEmitter &emitter)
+{
+    // Missing fields keep the ParticleEmitter defaults
+    if (j.contains("position"))
+        j.at("position").get_to(emitter.position);
+    if (j.contains("direction"))
+        j.at("direction").get_to(emitter.direction);
+    if (j.contains("spread"))
+        j.at("spread").get_to(emitter.spread);
+    if (j.contains("speed"))
+        j.at("speed").get_to(emitter.speed);
+    if (j.contains("rate"))
+        j.at("rate").get_to(emitter.rate);
+    if (j.contains("burst"))
+        j.at("burst").get_to(emitter.burst);
+    if (j.contains("lifetime"))
+        j.at("lifetime").get_to(emitter.lifetime);
+    if (j.contains("radius"))
+        j.at("radius").get_to(emitter.radius);
+    if (j.contains("mass"))
+        j.at("mass").get_to(emitter.mass);
+}
+
+// ParticleSystem, saved as its emitters and settings. Live particles are not saved
+inline void to_json(json &j, const ParticleSystem &particle_system)
+{
+    j = json{
+        {"name", particle_system.name},
+        {"max_particles", particle_system.max_particles},
+        {"gravity", particle_system.gravity},
+        {"drag", particle_system.drag},
+        {"restitution", particle_system.restitution},
+        {"friction", particle_system.friction},
+        {"collide_particles", particle_system.collide_particles},
+        {"seed", particle_system.seed},
+        {"emitters", particle_system.emitters}
+    };
+}
+
+ParticleSystem particle_system_from_json(const json &j)
+{
+    // Default seed is 0
+    ParticleSystem particle_system(j.contains("seed") ? j.at("seed").get<std::uint32_t>() : 0);
+
+    if (j.contains("name"))
+        j.at("name").get_to(particle_system.name);
+    else
+        particle_system.name = "Particles";
+
+    // Settings keep the ParticleSystem defaults when missing
+    if (j.contains("max_particles"))
+        j.at("max_particles").get_to(particle_system.max_particles);
+    if (j.contains("gravity"))
+        j.at("gravity").get_to(particle_system.gravity);
+    if (j.contains("drag"))
+        j.at("drag").get_to(particle_system.drag);
+    if (j.contains("restitution"))
+        j.at("restitution").get_to(particle_system.restitution);
+    if (j.contains("friction"))
+        j.at("friction").get_to(particle_system.friction);
+    if (j.contains("collide_particles"))
+        j.at("collide_particles").get_to(particle_system.collide_particles);
+    if (j.contains("emitters"))
+        j.at("emitters").get_to(particle_system.emitters);
+
+    return particle_system;
+}
 
 
 // Scene
@@ -735,8 +995,13 @@ inline void to_json(json &j, const Scene &scene)
     };
     for (const auto& obj : scene.game_objects)
     {
+        // The rigidbody only holds the initial description, take the live state from the physics world
+        GameObject saved_obj = obj;
+        if (obj.body != INVALID_BODY_HANDLE)
+            scene.physics_world.read_body(obj.body, saved_obj.rb);
+
         json obj_json;
-        to_json(obj_json, obj);
+        to_json(obj_json, saved_obj);
 
         // Serialize force generators
         obj_json["force_generators"] = json::array();
@@ -764,10 +1029,24 @@ inline void to_json(json &j, const Scene &scene)
                 obj_json["force_generators"].push_back(fg_json);
             }
         }
+        for (const auto& spring : scene.spring_network.springs)
+        {
+            if (spring.first == &obj)
+            {
+                json fg_json;
+                network_spring_to_json(fg_json, spring, scene);
+                obj_json["force_generators"].push_back(fg_json);
+            }
+        }
 
         j["objects"].push_back(obj_json);
     }
 
+    if (!scene.soft_bodies.empty())
+        j["soft_bodies"] = scene.soft_bodies;
+    if (!scene.particle_systems.empty())
+        j["particle_systems"] = scene.particle_systems;
+
     // lights already serialized as scene.scene_lights in the initializer above
 }
 
@@ -787,6 +1066,10 @@ inline void from_json(const json &j, Scene &scene)
     // Objects array (empty by default)
     if (j.contains("objects"))
     {
+        std::vector<std::pair<std::size_t, const json*>> pending_gravities;
+        std::vector<std::pair<std::size_t, const json*>> pending_network_springs;
+        // Bodies under the same field share one generator, so the registry applies it as a single batch
+        std::map<std::tuple<linkit::real, linkit::real, linkit::real>, std::shared_ptr<SimpleGravity>> shared_simple_gravities;
         const auto& objects_json = j.at("objects");
         for (const auto& obj_json : objects_json)
         {
@@ -816,15 +1099,14 @@ inline void from_json(const json &j, Scene &scene)
                         // Set the default value to be overridden by json
                         auto gravity = std::make_shared<SimpleGravity>(0);
                         simple_gravity_from_json(fg_json, *gravity);
-                        scene.force_registry.add(&scene.game_objects.back(), gravity);
+                        const linkit::Vector3& field = gravity->gravitational_field;
+                        auto [it, inserted] = shared_simple_gravities.try_emplace(std::make_tuple(field.x, field.y, field.z), gravity);
+                        scene.force_registry.add(&scene.game_objects.back(), it->second);
                     }
                     else if (type == "newtonian_gravity")
                     {
-                        auto gravity = std::make_shared<NewtonianGravity>();
-                        if (newtonian_gravity_from_json(fg_json, *gravity, scene, obj_name))
-                        {
-                            scene.force_registry.add(&scene.game_objects.back(), gravity);
-                        }
+                        // Resolved once every object is loaded, so indices can refer to any object in the scene
+                        pending_gravities.emplace_back(scene.game_objects.size() - 1, &fg_json);
                     }
                     else if (type == "anchored_spring")
                     {
@@ -832,6 +1114,11 @@ inline void from_json(const json &j, Scene &scene)
                         anchored_spring_from_json(fg_json, *spring);
                         scene.force_registry.add(&scene.game_objects.back(), spring);
                     }
+                    else if (type == "implicit_spring")
+                    {
+                        // May join a later object, so resolved once every object is loaded
+                        pending_network_springs.emplace_back(scene.game_objects.size() - 1, &fg_json);
+                    }
                     else if (type == "object_anchored_spring")
                     {
                         auto spring = std::make_shared<ObjectAnchoredSpring>(nullptr, 0, 0, 0);
@@ -847,6 +1134,59 @@ inline void from_json(const json &j, Scene &scene)
                 }
             }
         }
+
+        // Bodies with identical gravity settings share one generator, so per-step work such as the
+        // Barnes-Hut octree is done once rather than once per body
+        std::map<std::tuple<linkit::real, GravityMethod, linkit::real, linkit::real, std::vector<GameObject*>>, std::shared_ptr<NewtonianGravity>> shared_gravities;
+        for (const auto& [object_index, fg_json] : pending_gravities)
+        {
+            GameObject* obj = &scene.game_objects[object_index];
+            auto gravity = std::make_shared<NewtonianGravity>();
+            if (!newtonian_gravity_from_json(*fg_json, *gravity, scene, obj->name)) continue;
+
+            auto key = std::make_tuple(gravity->gravitational_constant, gravity->method, gravity->opening_angle,
+                                       gravity->softening, gravity->affected_objects);
+            auto [it, inserted] = shared_gravities.try_emplace(std::move(key), gravity);
+            scene.force_registry.add(obj, it->second);
+        }
+
+        for (const auto& [object_index, fg_json] : pending_network_springs)
+        {
+            NetworkSpring spring{&scene.game_objects[object_index], nullptr, 0, 0, 0};
+            if (!network_spring_from_json(*fg_json, spring, scene, spring.first->name)) continue;
+            scene.spring_network.add(spring.first, spring.second, spring.spring_constant, spring.rest_length, spring.damping);
+        }
+    }
+
+    // Soft bodies (none by default). Building their meshes and constraints dominates loading large cloths,
+    // so they are built side by side on the job system, then added in file order
+    if (j.contains("soft_bodies"))
+    {
+        const auto& soft_bodies_json = j.at("soft_bodies");
+        std::vector<std::optional<SoftBody>> soft_bodies(soft_bodies_json.size());
+        JobSystem::instance().parallel_for(soft_bodies.size(), 1, [&](const std::size_t i)
+        {
+            soft_bodies[i].emplace(soft_body_from_json(soft_bodies_json.at(i)));
+        });
+        for (auto& soft_body : soft_bodies)
+        {
+            scene.soft_bodies.push_back(std::move(*soft_body));
+        }
+    }
+
+    // Particle systems (none by default)
+    if (j.contains("particle_systems"))
+    {
+        const auto& particle_systems_json = j.at("particle_systems");
+        std::vector<std::optional<ParticleSystem>> particle_systems(particle_systems_json.size());
+        JobSystem::instance().parallel_for(particle_systems.size(), 1, [&](const std::size_t i)
+        {
+            particle_systems[i].emplace(particle_system_from_json(particle_systems_json.at(i)));
+        });
+        for (auto& particle_system : particle_systems)
+        {
+            scene.particle_systems.push_back(std::move(*particle_system));
+        }
     }
 
     // Lights array (SceneLights only)
@@ -895,35 +1235,56 @@ inline void from_json(const json &j, Scene &scene)
 // Public wrappers
 void SceneSerializer::serialize_scene(const Scene& scene, const std::string& filename)
 {
-
-    std::filesystem::path scenes_dir = get_scenes_directory();
-    std::filesystem::path file_path = scenes_dir / filename;
     json scene_json = scene;
-    write_json(file_path.string(), scene_json);
-
+    write_json(filename, scene_json);
 }
 
 SceneLoadResult SceneSerializer::deserialize_scene(const std::string& filename)
+{
+    json scene_data;
+    try
+    {
+        scene_data = read_json(filename);
+    }
+    catch (const json::parse_error& e)
+    {
+        SceneLoadResult result;
+        result.errors.push_back("Error: JSON parse error in file '" + filename + "': " + e.what());
+        return result;
+    }
+    catch (const std::exception& e)
+    {
+        SceneLoadResult result;
+        result.errors.push_back("Error: " + std::string(e.what()));
+        return result;
+    }
+    return deserialize_scene_json(scene_data, filename);
+}
+
+json SceneSerializer::read_scene_file(const std::string& filename)
+{
+    return read_json(filename);
+}
+
+SceneLoadResult SceneSerializer::deserialize_scene_json(const json& scene_data, const std::string& source_name)
 {
     SceneLoadResult result;
 
-    // Set up thread-local storage for warnings and name counters
+    // Set up thread-local storage for warnings and name counters. The previous pointers are kept so a load
+    // that runs inside another one on the same thread hands the outer load its storage back when it finishes
+    std::vector<std::string>* const outer_warnings = g_scene_load_warnings;
+    std::unordered_map<std::string, int>* const outer_name_counters = g_name_counters;
     g_scene_load_warnings = &result.warnings;
     std::unordered_map<std::string, int> name_counters;
     g_name_counters = &name_counters;
 
     try
     {
-        auto scene_data = read_json(filename);
         result.scene = scene_data.get<Scene>();
     }
-    catch (const json::parse_error& e)
-    {
-        result.errors.push_back("Error: JSON parse error in file '" + filename + "': " + e.what());
-    }
     catch (const json::type_error& e)
     {
-        result.errors.push_back("Error: JSON type error in file '" + filename + "': " + e.what());
+        result.errors.push_back("Error: JSON type error in file '" + source_name + "': " + e.what());
     }
     catch (const std::runtime_error& e)
     {
@@ -931,12 +1292,12 @@ SceneLoadResult SceneSerializer::deserialize_scene(const std::string& filename)
     }
     catch (const std::exception& e)
     {
-        result.errors.push_back("Error: Unexpected error loading '" + filename + "': " + e.what());
+        result.errors.push_back("Error: Unexpected error loading '" + source_name + "': " + e.what());
     }
 
-    // Clear thread-local storage
-    g_scene_load_warnings = nullptr;
-    g_name_counters = nullptr;
+    // Restore thread-local storage
+    g_scene_load_warnings = outer_warnings;
+    g_name_counters = outer_name_counters;
 
     return result;
 }
@@ -961,6 +1322,14 @@ std::filesystem::path SceneSerializer::get_scenes_directory()
     throw std::runtime_error("Could not locate scenes directory");
 }
 
+std::filesystem::path SceneSerializer::resolve_scene_path(const std::string& filename)
+{
+    // Absolute paths are used as given, so scenes outside the resources directory can be run headless
+    const std::filesystem::path path(filename);
+    if (path.is_absolute()) return path;
+    return get_scenes_directory() / path;
+}
+
 void SceneSerializer::print_json(const json& j) const
 {
     std::cout << j.dump(indentation_level_) << std::endl;
@@ -968,8 +1337,7 @@ void SceneSerializer::print_json(const json& j) const
 
 json SceneSerializer::read_json(const std::string& filename)
 {
-    std::filesystem::path scenes_dir = get_scenes_directory();
-    std::filesystem::path file_path = scenes_dir / filename;
+    std::filesystem::path file_path = resolve_scene_path(filename);
     std::ifstream f(file_path);
     if (!f.is_open())
     {
@@ -981,8 +1349,7 @@ json SceneSerializer::read_json(const std::string& filename)
 
 void SceneSerializer::write_json(const std::string& filename, const json& j)
 {
-    std::filesystem::path scenes_dir = get_scenes_directory();
-    std::filesystem::path file_path = scenes_dir / filename;
+    std::filesystem::path file_path = resolve_scene_path(filename);
     std::ofstream f(file_path);
     if (!f.is_open())
     {
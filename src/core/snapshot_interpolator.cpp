@@ -0,0 +1,132 @@
+#include "vectra/core/snapshot_interpolator.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    using Seconds = std::chrono::duration<double>;
+
+    linkit::Vector3 lerp(const linkit::Vector3& from, const linkit::Vector3& to, const linkit::real t)
+    {
+        return from + (to - from) * t;
+    }
+
+    // Normalised lerp along the shorter arc. Close to slerp for the small rotations of one tick
+    linkit::Quaternion nlerp(const linkit::Quaternion& from, const linkit::Quaternion& to, const linkit::real t)
+    {
+        const linkit::real dot = from.w * to.w + from.x * to.x + from.y * to.y + from.z * to.z;
+        const linkit::real sign = dot < 0 ? -1 : 1;
+
+        linkit::Quaternion result = from;
+        result.w += (sign * to.w - from.w) * t;
+        result.x += (sign * to.x - from.x) * t;
+        result.y += (sign * to.y - from.y) * t;
+        result.z += (sign * to.z - from.z) * t;
+        result.normalize();
+        return result;
+    }
+}
+
+void SnapshotInterpolator::push(SceneSnapshot& newest)
+{
+    return_to_current();
+    std::swap(previous_, current_);
+    std::swap(current_, newest);
+}
+
+SceneSnapshot& SnapshotInterpolator::frame(const Clock::time_point now, const bool interpolate)
+{
+    const double alpha = interpolate ? blend_factor(now) : 1.0;
+    if (alpha >= 1.0)
+    {
+        return_to_current();
+        return current_;
+    }
+
+    borrow_for_frame();
+    const auto t = static_cast<linkit::real>(alpha);
+
+    for (std::size_t id = 0; id < current_.object_count(); id++)
+    {
+        const Transform& from = previous_.transforms[id];
+        const Transform& to = current_.transforms[id];
+        Transform& transform = frame_.transforms[id];
+        transform.position = lerp(from.position, to.position, t);
+        transform.rotation = nlerp(from.rotation, to.rotation, t);
+        transform.scale = lerp(from.scale, to.scale, t);
+        write_model_matrix(transform, &frame_.model_matrices[16 * id]);
+    }
+
+    for (std::size_t s = 0; s < current_.soft_body_snapshots.size(); s++)
+    {
+        const auto& from = previous_.soft_body_snapshots[s].positions;
+        const auto& to = current_.soft_body_snapshots[s].positions;
+        auto& positions = frame_.soft_body_snapshots[s].positions;
+        if (from.size() != to.size()) continue;
+        for (std::size_t i = 0; i < to.size(); i++)
+        {
+            positions[i] = lerp(from[i], to[i], t);
+        }
+    }
+    return frame_;
+}
+
+double SnapshotInterpolator::blend_factor(const Clock::time_point now) const
+{
+    // Only snapshots of the same objects, in order, can be blended
+    if (previous_.object_table != current_.object_table || previous_.tick >= current_.tick ||
+        previous_.object_count() != current_.object_count() ||
+        previous_.soft_body_snapshots.size() != current_.soft_body_snapshots.size())
+    {
+        return 1.0;
+    }
+
+    // The real time between two snapshots also counts time spent paused, so it is capped at the steps between them
+    const double interval = std::min(Seconds(current_.time - previous_.time).count(),
+                                     static_cast<double>(current_.tick - previous_.tick) * current_.dt);
+    if (interval <= 0.0) return 1.0;
+    return std::clamp(Seconds(now - current_.time).count() / interval, 0.0, 1.0);
+}
+
+void SnapshotInterpolator::swap_unblended()
+{
+    std::swap(frame_.forces, current_.forces);
+    std::swap(frame_.has_spring, current_.has_spring);
+    std::swap(frame_.spring_anchors, current_.spring_anchors);
+    std::swap(frame_.particle_snapshots, current_.particle_snapshots);
+    frame_borrowed_ = !frame_borrowed_;
+}
+
+void SnapshotInterpolator::borrow_for_frame()
+{
+    if (frame_borrowed_) return;
+    swap_unblended();
+
+    // The rest is either small or overwritten by every blend, so it is only sized here
+    frame_.object_table = current_.object_table;
+    frame_.model_matrices.resize(current_.model_matrices.size());
+    frame_.transforms.resize(current_.transforms.size());
+    frame_.bvh_root = current_.bvh_root;
+    frame_.tick = current_.tick;
+    frame_.time = current_.time;
+    frame_.dt = current_.dt;
+
+    frame_.soft_body_snapshots.resize(current_.soft_body_snapshots.size());
+    for (std::size_t s = 0; s < current_.soft_body_snapshots.size(); s++)
+    {
+        const SoftBodySnapshot& to = current_.soft_body_snapshots[s];
+        SoftBodySnapshot& body = frame_.soft_body_snapshots[s];
+        body.triangles = to.triangles;
+        // Bodies whose vertex count changed are drawn unblended, so only they need the positions copied
+        if (previous_.soft_body_snapshots[s].positions.size() != to.positions.size())
+            body.positions = to.positions;
+        else
+            body.positions.resize(to.positions.size());
+    }
+}
+
+void SnapshotInterpolator::return_to_current()
+{
+    if (frame_borrowed_) swap_unblended();
+}
@@ -0,0 +1,59 @@
+#include "vectra/core/tick_pacer.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    using Seconds = std::chrono::duration<double>;
+
+    // Bounds on the spin margin. Oversleeps beyond the upper bound are left as jitter rather than
+    // spinning away most of the tick
+    constexpr double MIN_SPIN_MARGIN = 0.0002;
+    constexpr double MAX_SPIN_MARGIN = 0.002;
+    // How quickly the margin shrinks back after a late wake up, per sleep
+    constexpr double SPIN_MARGIN_DECAY = 0.99;
+
+    // Weight of the newest tick in the mean jitter, and ticks per window of the max jitter
+    constexpr double JITTER_SMOOTHING = 0.05;
+    constexpr int JITTER_WINDOW = 256;
+}
+
+void TickPacer::wait_until(const Clock::time_point deadline)
+{
+    const auto sleep_until = deadline - std::chrono::duration_cast<Clock::duration>(Seconds(spin_margin_));
+    if (Clock::now() < sleep_until)
+    {
+        std::this_thread::sleep_until(sleep_until);
+
+        // Widen the margin at once when a sleep overshoots, then let it shrink slowly
+        const double overshoot = Seconds(Clock::now() - sleep_until).count();
+        spin_margin_ = std::clamp(std::max(overshoot * 1.25, spin_margin_ * SPIN_MARGIN_DECAY),
+                                  MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+    }
+
+    while (Clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+
+    const double lateness = Seconds(Clock::now() - deadline).count();
+    mean_jitter_ += JITTER_SMOOTHING * (lateness - mean_jitter_);
+    window_max_jitter_ = std::max(window_max_jitter_, lateness);
+    if (++window_ticks_ == JITTER_WINDOW)
+    {
+        max_jitter_ = window_max_jitter_;
+        window_max_jitter_ = 0.0;
+        window_ticks_ = 0;
+    }
+}
+
+double TickPacer::mean_jitter() const
+{
+    return mean_jitter_;
+}
+
+double TickPacer::max_jitter() const
+{
+    return max_jitter_;
+}
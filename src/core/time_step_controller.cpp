@@ -0,0 +1,40 @@
+#include "vectra/core/time_step_controller.h"
+
+#include <algorithm>
+
+void TimeStepController::configure(const EngineState& state)
+{
+    dt_ = static_cast<linkit::real>(1.0 / state.simulation_frequency);
+    set_frequency_bounds(state.min_simulation_frequency, state.max_simulation_frequency);
+}
+
+void TimeStepController::set_frequency_bounds(const linkit::real min_frequency, const linkit::real max_frequency)
+{
+    min_dt = 1 / max_frequency;
+    max_dt = std::max(min_dt, 1 / min_frequency);
+    dt_ = std::clamp(dt_, min_dt, max_dt);
+}
+
+linkit::real TimeStepController::dt() const
+{
+    return dt_;
+}
+
+linkit::real TimeStepController::update(const StepStats& stats)
+{
+    const linkit::real error = std::max({
+        stats.max_motion_ratio / motion_tolerance,
+        stats.max_penetration / penetration_tolerance,
+        stats.energy_drift / energy_tolerance
+    });
+
+    // Aim slightly under the tolerance so the step doesn't oscillate around it
+    linkit::real factor = max_growth;
+    if (error > linkit::REAL_EPSILON)
+    {
+        factor = std::clamp(static_cast<linkit::real>(0.9) / error, max_shrink, max_growth);
+    }
+
+    dt_ = std::clamp(dt_ * factor, min_dt, max_dt);
+    return dt_;
+}
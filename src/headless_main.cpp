@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "vectra/core/batch_runner.h"
+#include "vectra/core/headless_engine.h"
+#include "vectra/core/job_system.h"
+#include "vectra/core/profiler.h"
+#include "vectra/core/replay_log.h"
+#include "vectra/physics/precision.h"
+
+namespace
+{
+    void print_usage()
+    {
+        std::cout << "Usage: vectra_headless <scene.json> [options]\n"
+                  << "       vectra_headless --batch <batch.json> [options]\n"
+                  << "       vectra_headless --replay <run.vrpl> [--threads N] [--save FILE] [--trace FILE]\n"
+                  << "  --steps N         Physics steps to run (default 1000)\n"
+                  << "  --frequency HZ    Physics frequency (default 144)\n"
+                  << "  --adaptive        Adaptive time stepping\n"
+                  << "  --substeps N      Physics substeps per step\n"
+                  << "  --ccd             Continuous collision\n"
+                  << "  --no-sleep        Keep resting bodies awake\n"
+                  << "  --threads N       Job system threads (default one per hardware thread)\n"
+                  << "  --csv FILE        Write every object's state to FILE\n"
+                  << "  --every N         Steps between CSV rows (default 1)\n"
+                  << "  --save FILE       Save the final state as a scene file\n"
+                  << "  --record FILE     Record the run as a replay log\n"
+                  << "  --trace FILE      Write the profiler's zones as a Chrome trace (VECTRA_ENABLE_PROFILER builds)\n"
+                  << "In batch mode the steps, CSV files and output directory come from the batch file.\n"
+                  << "A replay runs on the thread count it was recorded with unless --threads is given.\n";
+    }
+
+    // std::stoi and std::stod stop at the first character they can't read, so "12abc" would pass as 12.
+    // These throw invalid_argument unless the whole text is a number in range
+    int parse_int(const std::string& text, const int min)
+    {
+        std::size_t end = 0;
+        const int value = std::stoi(text, &end);
+        if (end != text.size() || value < min) throw std::invalid_argument(text);
+        return value;
+    }
+
+    double parse_positive(const std::string& text)
+    {
+        std::size_t end = 0;
+        const double value = std::stod(text, &end);
+        if (end != text.size() || !(value > 0)) throw std::invalid_argument(text);
+        return value;
+    }
+
+    int run_scene(const std::string& scene_file, const EngineState& state, const int steps, const int every,
+                  const std::string& csv_file, const std::string& save_file, const std::string& record_file)
+    {
+        ReplayRecorder recorder;
+        HeadlessEngine engine(state);
+        if (!record_file.empty())
+        {
+            if (!recorder.open(record_file))
+            {
+                std::cerr << "Could not open " << record_file << std::endl;
+                return 1;
+            }
+            engine.record_to(&recorder);
+        }
+        if (!engine.load_scene(scene_file)) return 1;
+
+        std::ofstream csv;
+        if (!csv_file.empty())
+        {
+            csv.open(csv_file);
+            if (!csv.is_open())
+            {
+                std::cerr << "Could not open " << csv_file << std::endl;
+                return 1;
+            }
+            HeadlessEngine::write_csv_header(csv);
+            engine.write_csv_rows(csv);
+        }
+
+        const double elapsed_ms = engine.run(steps, [&](const std::uint64_t tick)
+        {
+            if (csv.is_open() && tick % every == 0) engine.write_csv_rows(csv);
+        });
+
+        if (!save_file.empty()) engine.save_scene(save_file);
+
+        std::cout << "[" << REAL_PRECISION_NAME << "] " << scene_file << ": " << steps << " steps, "
+                  << engine.simulated_time() << " s simulated in " << elapsed_ms << " ms ("
+                  << (elapsed_ms * 1000.0 / steps) << " us/step)" << std::endl;
+        return 0;
+    }
+
+    int run_replay(ReplayPlayer& player, const std::string& log_file, const std::string& save_file)
+    {
+        const ReplayResult result = player.run();
+        if (!result.succeeded)
+        {
+            std::cerr << log_file << ": " << result.message << std::endl;
+            return 1;
+        }
+        if (!result.message.empty()) std::cout << log_file << ": " << result.message << std::endl;
+        if (!save_file.empty() && player.scene())
+        {
+            SceneSerializer().serialize_scene(*player.scene(), save_file);
+        }
+
+        std::cout << "[" << REAL_PRECISION_NAME << "] " << log_file << ": " << result.steps << " steps, "
+                  << result.scenes << " scenes, " << result.forces << " forces, " << result.checksums
+                  << " checksums matched, " << result.simulated_time << " s simulated in " << result.wall_ms
+                  << " ms on " << JobSystem::instance().thread_count() << " threads" << std::endl;
+        return 0;
+    }
+
+    int run_batch(const std::string& batch_file, const EngineState& state)
+    {
+        std::ifstream file(batch_file);
+        if (!file.is_open())
+        {
+            std::cerr << "Could not open " << batch_file << std::endl;
+            return 1;
+        }
+
+        BatchDescription description;
+        try
+        {
+            description = batch_description_from_json(json::parse(file));
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Invalid batch file " << batch_file << ": " << e.what() << std::endl;
+            return 1;
+        }
+
+        BatchRunner runner(description, state);
+        const auto start = std::chrono::steady_clock::now();
+        const bool succeeded = runner.run();
+        const double elapsed_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::size_t finished = 0;
+        for (const BatchInstanceResult& result : runner.results())
+        {
+            if (result.succeeded) finished++;
+        }
+        std::cout << "[" << REAL_PRECISION_NAME << "] " << description.scene << ": " << finished << "/"
+                  << runner.results().size() << " instances of " << description.steps << " steps in " << elapsed_ms
+                  << " ms on " << JobSystem::instance().thread_count() << " threads, results in "
+                  << description.output_directory << std::endl;
+        return succeeded ? 0 : 1;
+    }
+}
+
+// vectra_headless <scene.json> [options]. Runs a scene with no window, steps back to back and dumps the results.
+// vectra_headless --batch <batch.json> [options] runs every instance of a batch on the job system instead.
+// vectra_headless --replay <run.vrpl> steps a recorded run again and checks it against the recording
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || std::string(argv[1]) == "--help")
+    {
+        print_usage();
+        return argc < 2 ? 1 : 0;
+    }
+
+    const bool batch = std::string(argv[1]) == "--batch";
+    const bool replay = std::string(argv[1]) == "--replay";
+    if ((batch || replay) && argc < 3)
+    {
+        print_usage();
+        return 1;
+    }
+
+    EngineState state;
+    int steps = 1000;
+    int every = 1;
+    std::string csv_file;
+    std::string save_file;
+    std::string trace_file;
+    std::string record_file;
+    bool threads_given = false;
+    for (int i = batch || replay ? 3 : 2; i < argc; i++)
+    {
+        const std::string option = argv[i];
+        const bool has_value = i + 1 < argc;
+        try
+        {
+            if (option == "--steps" && has_value) steps = parse_int(argv[++i], 1);
+            else if (option == "--frequency" && has_value) state.simulation_frequency = parse_positive(argv[++i]);
+            else if (option == "--adaptive") state.adaptive_time_step = true;
+            else if (option == "--substeps" && has_value) state.physics_substeps = parse_int(argv[++i], 1);
+            else if (option == "--ccd") state.continuous_collision = true;
+            else if (option == "--no-sleep") state.allow_sleeping = false;
+            else if (option == "--threads" && has_value)
+            {
+                state.worker_threads = parse_int(argv[++i], 1);
+                threads_given = true;
+            }
+            else if (option == "--csv" && has_value) csv_file = argv[++i];
+            else if (option == "--every" && has_value) every = parse_int(argv[++i], 1);
+            else if (option == "--save" && has_value) save_file = argv[++i];
+            else if (option == "--trace" && has_value) trace_file = argv[++i];
+            else if (option == "--record" && has_value && !batch && !replay) record_file = argv[++i];
+            else
+            {
+                std::cerr << "Unknown option: " << option << std::endl;
+                print_usage();
+                return 1;
+            }
+        }
+        catch (const std::logic_error&)
+        {
+            // std::stoi and std::stod throw invalid_argument or out_of_range, both logic_errors, as do the range checks
+            std::cerr << "Invalid value for " << option << ": " << argv[i] << std::endl;
+            print_usage();
+            return 1;
+        }
+    }
+
+    ReplayPlayer player;
+    if (replay)
+    {
+        if (!player.open(argv[2]))
+        {
+            std::cerr << player.message() << std::endl;
+            return 1;
+        }
+        // Parallel stages split their work by thread count, so only the recorded count replays bit for bit
+        if (!threads_given) state.worker_threads = static_cast<int>(player.recorded_threads());
+    }
+
+    VECTRA_PROFILE_THREAD("Main");
+    JobSystem::instance().set_thread_count(static_cast<std::size_t>(std::max(0, state.worker_threads)));
+    int result;
+    if (batch) result = run_batch(argv[2], state);
+    else if (replay) result = run_replay(player, argv[2], save_file);
+    else result = run_scene(argv[1], state, steps, every, csv_file, save_file, record_file);
+
+    if (!trace_file.empty() && !Profiler::instance().write_chrome_trace(trace_file))
+    {
+        std::cerr << "Could not write " << trace_file << std::endl;
+        return 1;
+    }
+    return result;
+}
+
@@ -1,13 +1,48 @@
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 #include "vectra/core/engine.h"
 #include "vectra/core/scene_serializer.h"
+#include "vectra/physics/precision.h"
 
-int main()
+int main(int argc, char* argv[])
 {
     const auto engine = std::make_unique<Engine>();
+
+    // vectra --benchmark <scene.json> [steps]
+    if (argc >= 3 && std::string(argv[1]) == "--benchmark")
+    {
+        int steps = 2000;
+        if (argc >= 4)
+        {
+            try
+            {
+                std::size_t end = 0;
+                steps = std::stoi(argv[3], &end);
+                if (end != std::string(argv[3]).size() || steps < 1) throw std::invalid_argument(argv[3]);
+            }
+            catch (const std::logic_error&)
+            {
+                // std::stoi throws invalid_argument or out_of_range, both logic_errors
+                std::cerr << "Invalid step count: " << argv[3] << std::endl;
+                return 1;
+            }
+        }
+        engine->load_scene(argv[2]);
+        const double elapsed_ms = engine->benchmark_physics(steps);
+        std::cout << "[" << REAL_PRECISION_NAME << "] " << argv[2] << ": " << steps << " steps in "
+                  << elapsed_ms << " ms (" << (elapsed_ms * 1000.0 / steps) << " us/step)" << std::endl;
+        return 0;
+    }
+
+    // vectra --record <run.vrpl> records the session, to be replayed with vectra_headless --replay
+    if (argc >= 3 && std::string(argv[1]) == "--record" && !engine->record_to(argv[2]))
+    {
+        return 1;
+    }
+
     engine->load_scene("default_scene.json");
     engine->run();
     return 0;
 }
-
@@ -46,7 +46,7 @@ CollisionData ColliderBox::collide_with_sphere(ColliderSphere& sphere, Collision
     // but the caller expects normal from box (this) to sphere
     for (auto& contact : result.contacts)
     {
-        contact.collision_normal = contact.collision_normal * -1.0f;
+        contact.collision_normal = contact.collision_normal * -1;
     }
     return result;
 }
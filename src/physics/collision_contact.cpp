@@ -74,16 +74,16 @@ void CollisionContact::calculate_desired_delta_velocity(linkit::real restitution
     }
 
     // If the velocity is very slow, limit the restitution to avoid jitter
-    constexpr linkit::real velocity_limit = 0.25f;
+    constexpr linkit::real velocity_limit = static_cast<linkit::real>(0.25);
     linkit::real effective_restitution = restitution;
     if (real_abs(contact_velocity.x) < velocity_limit)
     {
-        effective_restitution = 0.0f;
+        effective_restitution = 0;
     }
 
     // We want to reverse the closing velocity and add bounce
     // current velocity is negative (closing), we want positive (separating)
     // desired = -current * (1 + restitution)
-    desired_delta_velocity = -contact_velocity.x * (1.0f + effective_restitution);
+    desired_delta_velocity = -contact_velocity.x * (1 + effective_restitution);
 }
 
@@ -1,4 +1,5 @@
 #include "vectra/physics/collision_data.h"
+#include "vectra/core/gameobject.h"
 
 CollisionData::CollisionData() = default;
 
@@ -9,7 +10,7 @@ void CollisionData::add_contact(const CollisionContact& contact)
     {
         return;
     }
-    restitution = 0.3f;
+    restitution = static_cast<linkit::real>(0.3);
     contacts.push_back(contact);
     valid = true;
 }
@@ -34,6 +35,8 @@ void CollisionData::set_objects(GameObject* obj1, GameObject* obj2)
 {
     objects[0] = obj1;
     objects[1] = obj2;
+    bodies[0] = obj1->body;
+    bodies[1] = obj2->body;
 }
 
 void CollisionData::set_restitution(linkit::real restitution_value)
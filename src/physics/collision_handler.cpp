@@ -1,4 +1,5 @@
 #include "vectra/physics/collision_handler.h"
+#include "vectra/physics/precision.h"
 #include <cmath>
 #include <iostream>
 #include <ostream>
@@ -6,40 +7,89 @@
 #include <algorithm>
 #include <array>
 
+#include "vectra/physics/parallel.h"
+
+namespace
+{
+    // A shape test costs from a few hundred nanoseconds (spheres) to a few microseconds (boxes)
+    constexpr std::size_t MIN_PAIRS_PER_THREAD = 256;
+
+    enum PairOutcome : std::uint8_t { PAIR_SKIPPED, PAIR_SWEPT, PAIR_TESTED };
+
+    // Fraction of the smaller core radius at which a swept pair counts as touching
+    constexpr linkit::real CCD_CONTACT_TOLERANCE = static_cast<linkit::real>(0.01);
+}
+
 CollisionHandler::CollisionHandler() = default;
 
 void CollisionHandler::add_collision(const CollisionData& collision) {
     collisions.push_back(collision);
 }
 
-void CollisionHandler::narrow_phase(const std::vector<PotentialContact>& potential_contacts) {
-    for (const auto& [objects] : potential_contacts)
+void CollisionHandler::narrow_phase(const std::vector<PotentialContact>& potential_contacts, const PhysicsWorld& world,
+                                    const bool sweep_fast_pairs) {
+    // Pairs are tested in parallel, each into its own slot, then recorded in broad phase order so the
+    // contacts don't depend on how the pairs were scheduled
+    const std::size_t count = potential_contacts.size();
+    pair_outcomes_.resize(count);
+    pair_results_.resize(count);
+    parallel_for(count, MIN_PAIRS_PER_THREAD, [&](const std::size_t i)
     {
+        const auto& objects = potential_contacts[i].objects;
+        pair_outcomes_[i] = PAIR_SKIPPED;
         if (!objects[0] || !objects[1])
         {
-            continue;
+            return;
         }
 
-        ColliderPrimitive& collider_one = objects[0]->get_collider();
-        ColliderPrimitive& collider_two = objects[1]->get_collider();
+        // Fast pairs can end the step deep inside, or past, each other, so they are only tested along their path
+        if (sweep_fast_pairs && continuous_collision && is_fast_pair({{objects[0], objects[1]}}, world))
+        {
+            pair_outcomes_[i] = PAIR_SWEPT;
+            return;
+        }
+
+        pair_results_[i] = test_discrete(objects[0], objects[1], world);
+        pair_outcomes_[i] = PAIR_TESTED;
+    });
 
-        CollisionData collision_data = solve_collision(collider_one, collider_two);
-        if (collision_data.valid)
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (pair_outcomes_[i] == PAIR_SWEPT)
         {
-            for (auto &contact : collision_data.contacts)
-            {
-                // Relative position is FROM body center TO contact point
-                contact.relative_positions = {
-                    (contact.collision_point - objects[0]->rb.transform.position),
-                    (contact.collision_point - objects[1]->rb.transform.position)
-                };
+            ccd_candidates_.push_back(potential_contacts[i]);
+        }
+        else if (pair_outcomes_[i] == PAIR_TESTED && pair_results_[i].valid)
+        {
+            collisions.push_back(std::move(pair_results_[i]));
+        }
+    }
+}
+
+CollisionData CollisionHandler::test_discrete(GameObject* first, GameObject* second, const PhysicsWorld& world) {
+    CollisionData collision_data = solve_collision(first->get_collider(), second->get_collider());
+    if (collision_data.valid)
+    {
+        for (auto &contact : collision_data.contacts)
+        {
+            // Relative position is FROM body center TO contact point
+            contact.relative_positions = {
+                (contact.collision_point - world.positions[first->body]),
+                (contact.collision_point - world.positions[second->body])
+            };
 
-            }
-            collision_data.set_objects(objects[0], objects[1]);
-            add_collision(collision_data);
         }
+        collision_data.set_objects(first, second);
     }
+    return collision_data;
+}
 
+void CollisionHandler::detect_discrete(GameObject* first, GameObject* second, const PhysicsWorld& world) {
+    CollisionData collision_data = test_discrete(first, second, world);
+    if (collision_data.valid)
+    {
+        add_collision(collision_data);
+    }
 }
 
 CollisionData CollisionHandler::solve_collision(ColliderPrimitive& first, ColliderPrimitive& second) {
@@ -71,7 +121,7 @@ CollisionData CollisionHandler::solve_sphere_sphere(const ColliderSphere& first,
 
     const linkit::Vector3 normal = delta / distance;
     const linkit::real penetration = radius_sum - distance;
-    const linkit::Vector3 contact_point = transform_one.position + normal * (first.radius - 0.5f * penetration);
+    const linkit::Vector3 contact_point = transform_one.position + normal * (first.radius - static_cast<linkit::real>(0.5) * penetration);
 
     CollisionContact contact(contact_point, normal, penetration);
     collision_data.add_contact(contact);
@@ -87,14 +137,14 @@ CollisionData CollisionHandler::solve_box_box(ColliderBox& first, ColliderBox& s
 
     linkit::Vector3 to_center = axes2.center - axes1.center;
 
-    linkit::real min_overlap = 1e20f;
+    linkit::real min_overlap = REAL_MAX;
     int best_case = -1;
     linkit::Vector3 best_axis;
 
     // Track overlaps for each axis type to determine the contact type
-    linkit::real face_overlap_1 = 1e20f;
-    linkit::real face_overlap_2 = 1e20f;
-    linkit::real edge_overlap = 1e20f;
+    linkit::real face_overlap_1 = REAL_MAX;
+    linkit::real face_overlap_2 = REAL_MAX;
+    linkit::real edge_overlap = REAL_MAX;
     int best_face_1 = -1;
     int best_face_2 = -1;
     int best_edge_1 = -1;
@@ -103,7 +153,7 @@ CollisionData CollisionHandler::solve_box_box(ColliderBox& first, ColliderBox& s
     // Helper to test a separating axis
     auto test_axis = [&](const linkit::Vector3& axis, int case_index) -> bool {
         linkit::real axis_mag_sq = axis.magnitude_squared();
-        if (axis_mag_sq < 1e-6f) return true; // Skip degenerate axes
+        if (axis_mag_sq < static_cast<linkit::real>(1e-6)) return true; // Skip near-parallel edge pairs
 
         linkit::Vector3 n = axis;
         n.normalize();
@@ -165,7 +215,7 @@ CollisionData CollisionHandler::solve_box_box(ColliderBox& first, ColliderBox& s
 
     // 3. Test cross-products of edges (cases 6-14)
     // Add bias to prefer face contacts over edge contacts for stability
-    constexpr linkit::real edge_bias = 0.95f;
+    constexpr linkit::real edge_bias = static_cast<linkit::real>(0.95);
     linkit::real face_min = std::min(face_overlap_1, face_overlap_2);
 
     int case_idx = 6;
@@ -183,7 +233,7 @@ CollisionData CollisionHandler::solve_box_box(ColliderBox& first, ColliderBox& s
 
     // Ensure normal points from box 1 to box 2
     if (best_axis * to_center < 0) {
-        best_axis = best_axis * -1.0f;
+        best_axis = best_axis * -1;
     }
 
     // Determine contact type and generate appropriate contacts
@@ -197,7 +247,7 @@ CollisionData CollisionHandler::solve_box_box(ColliderBox& first, ColliderBox& s
     }
     else {
         // Edge-edge contact - prefer face contact if penetrations are close (stability bias)
-        if (edge_overlap > face_min * edge_bias && face_min < 1e19f) {
+        if (edge_overlap > face_min * edge_bias && face_min < REAL_MAX) {
             // Use face contact instead for better stability
             if (face_overlap_1 <= face_overlap_2) {
                 generate_face_contacts(first, second, axes1, axes2, best_face_1, false, face_overlap_1, collision_data);
@@ -260,19 +310,19 @@ CollisionData CollisionHandler::solve_sphere_box(ColliderSphere& sphere, Collide
         if (dist_x < dist_y && dist_x < dist_z)
         {
             // Closest to X face
-            normal = (local_center.x >= 0) ? axis_x : axis_x * -1.0;
+            normal = (local_center.x >= 0) ? axis_x : axis_x * -1;
             penetration = dist_x + sphere.radius;
         }
         else if (dist_y < dist_x && dist_y < dist_z)
         {
             // Closest to Y face
-            normal = (local_center.y >= 0) ? axis_y : axis_y * -1.0;
+            normal = (local_center.y >= 0) ? axis_y : axis_y * -1;
             penetration = dist_y + sphere.radius;
         }
         else if (dist_z < dist_x && dist_z < dist_y)
         {
             // Closest to Z face
-            normal = (local_center.z >= 0) ? axis_z : axis_z * -1.0;
+            normal = (local_center.z >= 0) ? axis_z : axis_z * -1;
             penetration = dist_z + sphere.radius;
         }
         else
@@ -285,25 +335,25 @@ CollisionData CollisionHandler::solve_sphere_box(ColliderSphere& sphere, Collide
 
             if (abs_x >= abs_y && abs_x >= abs_z)
             {
-                normal = (local_center.x >= 0) ? axis_x : axis_x * -1.0;
+                normal = (local_center.x >= 0) ? axis_x : axis_x * -1;
                 penetration = dist_x + sphere.radius;
             }
             else if (abs_y >= abs_x && abs_y >= abs_z)
             {
-                normal = (local_center.y >= 0) ? axis_y : axis_y * -1.0;
+                normal = (local_center.y >= 0) ? axis_y : axis_y * -1;
                 penetration = dist_y + sphere.radius;
             }
             else
             {
-                normal = (local_center.z >= 0) ? axis_z : axis_z * -1.0;
+                normal = (local_center.z >= 0) ? axis_z : axis_z * -1;
                 penetration = dist_z + sphere.radius;
             }
         }
 
         // Flip normal to point from sphere to box (convention: normal from first to second object)
-        normal = normal * -1.0;
+        normal = normal * -1;
 
-        linkit::Vector3 contact_point = sphere_transform.position - normal * (sphere.radius - penetration * 0.5);
+        linkit::Vector3 contact_point = sphere_transform.position - normal * (sphere.radius - penetration * static_cast<linkit::real>(0.5));
         CollisionContact contact(contact_point, normal, penetration);
         collision_data.add_contact(contact);
         return collision_data;
@@ -344,11 +394,11 @@ CollisionData CollisionHandler::solve_sphere_box(ColliderSphere& sphere, Collide
 
         // Normal points from sphere toward box center (inward)
         if (dx <= dy && dx <= dz)
-            normal = (local_center.x >= 0) ? axis_x * -1.0 : axis_x;
+            normal = (local_center.x >= 0) ? axis_x * -1 : axis_x;
         else if (dy <= dx && dy <= dz)
-            normal = (local_center.y >= 0) ? axis_y * -1.0 : axis_y;
+            normal = (local_center.y >= 0) ? axis_y * -1 : axis_y;
         else
-            normal = (local_center.z >= 0) ? axis_z * -1.0 : axis_z;
+            normal = (local_center.z >= 0) ? axis_z * -1 : axis_z;
     }
     else
     {
@@ -356,7 +406,7 @@ CollisionData CollisionHandler::solve_sphere_box(ColliderSphere& sphere, Collide
     }
 
     const linkit::real penetration = sphere.radius - distance;
-    const linkit::Vector3 contact_point = sphere_transform.position + normal * (sphere.radius - penetration * 0.5);
+    const linkit::Vector3 contact_point = sphere_transform.position + normal * (sphere.radius - penetration * static_cast<linkit::real>(0.5));
 
     const CollisionContact contact(contact_point, normal, penetration);
     collision_data.add_contact(contact);
@@ -364,28 +414,41 @@ CollisionData CollisionHandler::solve_sphere_box(ColliderSphere& sphere, Collide
 }
 
 
-void CollisionHandler::solve_contacts() {
+void CollisionHandler::solve_contacts(PhysicsWorld& world) {
     if (collisions.empty()) return;
     for (auto &collision : collisions)
     {
+        // A moving body touching a sleeping one wakes it up; static bodies never do
+        for (int i=0; i<2; i++)
+        {
+            const BodyHandle body = collision.bodies[i];
+            const BodyHandle other = collision.bodies[1 - i];
+            if (!world.is_awake[body] && world.is_awake[other] && world.has_finite_mass(other))
+            {
+                world.set_awake(body, true);
+            }
+        }
 
         for (auto& contact : collision.get_contacts())
         {
+            // Cached contacts can separate between sub-steps
+            if (contact.penetration_depth < 0) continue;
+
             linkit::real delta_velocity = 0;
             linkit::Vector3 closing_velocity = linkit::Vector3(0, 0, 0);
 
             for (int i=0; i<2; i++)
             {
-                linkit::Matrix3 inverse_inertia_tensor = collision.objects[i]->rb._local_inverse_inertia_tensor;
+                linkit::Matrix3 inverse_inertia_tensor = world.inverse_inertia_tensors[collision.bodies[i]];
 
                 linkit::Vector3 torque = contact.relative_positions[i] % contact.collision_normal;
                 linkit::Vector3 delta_angular_velocity = inverse_inertia_tensor * torque;
                 delta_velocity += (delta_angular_velocity % contact.relative_positions[i]) * contact.collision_normal;
-                delta_velocity += collision.objects[i]->rb.inverse_mass;
+                delta_velocity += world.inverse_masses[collision.bodies[i]];
 
                 // Calculate velocity at contact point for this body
-                linkit::Vector3 velocity_at_contact = collision.objects[i]->rb.velocity +
-                    collision.objects[i]->rb.angular_velocity % contact.relative_positions[i];
+                linkit::Vector3 velocity_at_contact = world.velocities[collision.bodies[i]] +
+                    world.angular_velocities[collision.bodies[i]] % contact.relative_positions[i];
 
                 // First object adds, second object subtracts (closing velocity)
                 if (i == 0) {
@@ -418,33 +481,33 @@ void CollisionHandler::solve_contacts() {
 
             // Apply impulse to first object (pushed away from object 1, opposite to normal)
             {
-                linkit::Vector3 velocity_change = impulse * collision.objects[0]->rb.inverse_mass;
+                linkit::Vector3 velocity_change = impulse * world.inverse_masses[collision.bodies[0]];
                 linkit::Vector3 impulse_torque = contact.relative_positions[0] % impulse;
-                linkit::Vector3 rotation_change = collision.objects[0]->rb._local_inverse_inertia_tensor * impulse_torque;
+                linkit::Vector3 rotation_change = world.inverse_inertia_tensors[collision.bodies[0]] * impulse_torque;
 
                 if (std::isfinite(velocity_change.x) && std::isfinite(velocity_change.y) && std::isfinite(velocity_change.z))
                 {
-                    collision.objects[0]->rb.velocity -= velocity_change;
+                    world.velocities[collision.bodies[0]] -= velocity_change;
                 }
                 if (std::isfinite(rotation_change.x) && std::isfinite(rotation_change.y) && std::isfinite(rotation_change.z))
                 {
-                    collision.objects[0]->rb.angular_velocity -= rotation_change;
+                    world.angular_velocities[collision.bodies[0]] -= rotation_change;
                 }
             }
 
             // Apply impulse to the second object (pushed away from object 0, along normal)
             {
-                linkit::Vector3 velocity_change = impulse * collision.objects[1]->rb.inverse_mass;
+                linkit::Vector3 velocity_change = impulse * world.inverse_masses[collision.bodies[1]];
                 linkit::Vector3 impulse_torque = contact.relative_positions[1] % impulse;
-                linkit::Vector3 rotation_change = collision.objects[1]->rb._local_inverse_inertia_tensor * impulse_torque;
+                linkit::Vector3 rotation_change = world.inverse_inertia_tensors[collision.bodies[1]] * impulse_torque;
 
                 if (std::isfinite(velocity_change.x) && std::isfinite(velocity_change.y) && std::isfinite(velocity_change.z))
                 {
-                    collision.objects[1]->rb.velocity += velocity_change;
+                    world.velocities[collision.bodies[1]] += velocity_change;
                 }
                 if (std::isfinite(rotation_change.x) && std::isfinite(rotation_change.y) && std::isfinite(rotation_change.z))
                 {
-                    collision.objects[1]->rb.angular_velocity += rotation_change;
+                    world.angular_velocities[collision.bodies[1]] += rotation_change;
                 }
             }
         }
@@ -452,96 +515,458 @@ void CollisionHandler::solve_contacts() {
 
 }
 
-void CollisionHandler::resolve_interpretations() {
-    // Non-linear interpretation resolution -> might implement relaxation in the future
+void CollisionHandler::resolve_interpretations(PhysicsWorld& world) {
+    // Iterative resolution: always fix the deepest contact next, then update the penetration of
+    // every other contact that shares one of the moved bodies
     if (collisions.empty()) return;
-    for (auto &collision : collisions)
+
+    contact_refs_.clear();
+    for (std::size_t c = 0; c < collisions.size(); c++)
     {
-        for (auto& contact : collision.get_contacts())
+        for (std::size_t k = 0; k < collisions[c].contacts.size(); k++)
         {
-            linkit::real angular_inertia_contact[2];
-            linkit::real angular_move[2];
+            contact_refs_.push_back({c, k});
+        }
+    }
 
-            linkit::real linear_inertia_contact[2];
-            linkit::real linear_move[2];
+    // Contacts grouped by body (CSR layout) so only the affected ones are revisited
+    body_contact_offsets_.assign(world.size() + 1, 0);
+    for (const auto& ref : contact_refs_)
+    {
+        for (const BodyHandle body : collisions[ref.collision].bodies)
+        {
+            body_contact_offsets_[body + 1]++;
+        }
+    }
+    for (std::size_t b = 0; b < world.size(); b++)
+    {
+        body_contact_offsets_[b + 1] += body_contact_offsets_[b];
+    }
+    body_contact_cursor_.assign(body_contact_offsets_.begin(), body_contact_offsets_.end() - 1);
+    body_contacts_.resize(body_contact_offsets_.back());
+    for (std::size_t k = 0; k < contact_refs_.size(); k++)
+    {
+        for (const BodyHandle body : collisions[contact_refs_[k].collision].bodies)
+        {
+            body_contacts_[body_contact_cursor_[body]++] = k;
+        }
+    }
 
-            linkit::real total_inertia = 0;
-            for (int i=0; i<2;i++)
+    // Picking the deepest contact by scanning them all made the resolution quadratic in the contacts.
+    // The heap gets a fresh entry whenever a penetration changes and skips entries that no longer match
+    const auto shallower = [](const QueuedPenetration& a, const QueuedPenetration& b)
+    {
+        return a.penetration < b.penetration || (a.penetration == b.penetration && a.contact > b.contact);
+    };
+    const auto penetration_of = [this](const std::size_t k) -> linkit::real&
+    {
+        return collisions[contact_refs_[k].collision].contacts[contact_refs_[k].contact].penetration_depth;
+    };
+    const auto queue = [&](const std::size_t k)
+    {
+        const linkit::real penetration = penetration_of(k);
+        if (!(penetration > position_epsilon)) return;
+        deepest_contacts_.push_back({penetration, k});
+        std::push_heap(deepest_contacts_.begin(), deepest_contacts_.end(), shallower);
+    };
+
+    deepest_contacts_.clear();
+    for (std::size_t k = 0; k < contact_refs_.size(); k++) queue(k);
+
+    const std::size_t max_iterations = contact_refs_.size() * position_iterations_per_contact;
+    for (std::size_t iteration = 0; iteration < max_iterations; iteration++)
+    {
+        // Find the deepest remaining contact
+        std::size_t worst = contact_refs_.size();
+        while (!deepest_contacts_.empty())
+        {
+            const QueuedPenetration top = deepest_contacts_.front();
+            std::pop_heap(deepest_contacts_.begin(), deepest_contacts_.end(), shallower);
+            deepest_contacts_.pop_back();
+            if (penetration_of(top.contact) == top.penetration)
             {
-                GameObject* body = collision.objects[i];
-                linkit::Matrix3 inverse_inertia_tensor = body->rb._local_inverse_inertia_tensor;
+                worst = top.contact;
+                break;
+            }
+        }
+        if (worst == contact_refs_.size()) break;
 
-                linkit::Vector3 torque = contact.relative_positions[i] % contact.collision_normal;
-                linkit::Vector3 delta_angular_velocity = inverse_inertia_tensor * torque;
-                linkit::Vector3 angular_inertia_world = (delta_angular_velocity % contact.relative_positions[i]);
-                angular_inertia_contact[i] = angular_inertia_world * contact.collision_normal;
-                linear_inertia_contact[i] = body->rb.inverse_mass;
-                total_inertia += angular_inertia_contact[i] + linear_inertia_contact[i];
+        CollisionData& collision = collisions[contact_refs_[worst].collision];
+        CollisionContact& contact = collision.contacts[contact_refs_[worst].contact];
+
+        linkit::Vector3 linear_change[2];
+        linkit::Vector3 angular_change[2];
+        if (!apply_position_change(world, collision, contact, linear_change, angular_change))
+        {
+            // Neither body can move, don't pick this contact again
+            contact.penetration_depth = 0;
+            continue;
+        }
+
+        for (int i=0; i<2; i++)
+        {
+            const BodyHandle moved = collision.bodies[i];
+            for (std::size_t idx = body_contact_offsets_[moved]; idx < body_contact_offsets_[moved + 1]; idx++)
+            {
+                const ContactRef& ref = contact_refs_[body_contacts_[idx]];
+                CollisionData& other = collisions[ref.collision];
+                CollisionContact& other_contact = other.contacts[ref.contact];
+
+                for (int j=0; j<2; j++)
+                {
+                    if (other.bodies[j] != moved) continue;
+
+                    linkit::Vector3 delta_position = linear_change[i] + angular_change[i] % other_contact.relative_positions[j];
+                    // Body 0 moving along the normal deepens the contact, body 1 moving along it separates
+                    linkit::real delta_penetration = delta_position * other_contact.collision_normal;
+                    other_contact.penetration_depth += (j == 0) ? delta_penetration : -delta_penetration;
+                }
+                queue(body_contacts_[idx]);
             }
+        }
+    }
+}
 
-            // Avoid division by zero
-            if (total_inertia < linkit::REAL_EPSILON) continue;
+bool CollisionHandler::apply_position_change(PhysicsWorld& world, const CollisionData& collision, const CollisionContact& contact,
+                                             linkit::Vector3 linear_change[2], linkit::Vector3 angular_change[2]) {
+    linkit::real angular_inertia_contact[2];
+    linkit::real angular_move[2];
 
-            const linkit::real inverse_total_inertia = 1.0f / total_inertia;
+    linkit::real linear_inertia_contact[2];
+    linkit::real linear_move[2];
 
+    linkit::real total_inertia = 0;
+    for (int i=0; i<2;i++)
+    {
+        const BodyHandle body = collision.bodies[i];
+        linkit::Matrix3 inverse_inertia_tensor = world.inverse_inertia_tensors[body];
+
+        linkit::Vector3 torque = contact.relative_positions[i] % contact.collision_normal;
+        linkit::Vector3 delta_angular_velocity = inverse_inertia_tensor * torque;
+        linkit::Vector3 angular_inertia_world = (delta_angular_velocity % contact.relative_positions[i]);
+        angular_inertia_contact[i] = angular_inertia_world * contact.collision_normal;
+        linear_inertia_contact[i] = world.inverse_masses[body];
+        total_inertia += angular_inertia_contact[i] + linear_inertia_contact[i];
+
+        linear_change[i] = linkit::Vector3(0, 0, 0);
+        angular_change[i] = linkit::Vector3(0, 0, 0);
+    }
 
-            angular_move[0] = -contact.penetration_depth * angular_inertia_contact[0] * inverse_total_inertia;
-            angular_move[1] = contact.penetration_depth * angular_inertia_contact[1] * inverse_total_inertia;
+    // Avoid division by zero
+    if (total_inertia < linkit::REAL_EPSILON) return false;
 
-            linear_move[0] = -contact.penetration_depth * linear_inertia_contact[0] * inverse_total_inertia;
-            linear_move[1] = contact.penetration_depth * linear_inertia_contact[1] * inverse_total_inertia;
+    const linkit::real inverse_total_inertia = 1 / total_inertia;
 
-            for (int i=0; i<2;i++)
-            {
-                GameObject* body = collision.objects[i];
 
-                // Angular resolution
-                linkit::real limit = 0.2 * contact.relative_positions[i].magnitude();
-                if (linkit::real_abs(angular_move[i]) > limit)
-                {
-                    linkit::real total_move = linear_move[i] + angular_move[i];
-                    if (angular_move[i] >= 0)
-                    {
-                        angular_move[i] = limit;
-                    } else
-                    {
-                        angular_move[i] = -limit;
-                    }
-                    linear_move[i] = total_move - angular_move[i];
-                }
+    angular_move[0] = -contact.penetration_depth * angular_inertia_contact[0] * inverse_total_inertia;
+    angular_move[1] = contact.penetration_depth * angular_inertia_contact[1] * inverse_total_inertia;
 
-                // Only apply angular resolution if there's angular inertia
-                if (linkit::real_abs(angular_inertia_contact[i]) > linkit::REAL_EPSILON)
-                {
-                    linkit::Matrix3 inverse_inertia_tensor = body->rb._local_inverse_inertia_tensor;
-                    linkit::Vector3 impulsive_torque = contact.relative_positions[i] % contact.collision_normal;
-                    linkit::Vector3 impulse_per_move = inverse_inertia_tensor * impulsive_torque;
-                    linkit::Vector3 rotation_per_move = impulse_per_move * (1.0/angular_inertia_contact[i]);
-                    linkit::Vector3 rotation = rotation_per_move * angular_move[i];
-
-                    // Safety check for NaN/Inf
-                    if (std::isfinite(rotation.x) && std::isfinite(rotation.y) && std::isfinite(rotation.z))
-                    {
-                        body->rb.transform.rotation.add_scaled_vector(rotation, 1);
-                        body->rb.transform.rotation.normalize();
-                    }
-                }
+    linear_move[0] = -contact.penetration_depth * linear_inertia_contact[0] * inverse_total_inertia;
+    linear_move[1] = contact.penetration_depth * linear_inertia_contact[1] * inverse_total_inertia;
 
-                // Linear resolution
-                linkit::Vector3 linear_displacement = contact.collision_normal * linear_move[i];
-                if (std::isfinite(linear_displacement.x) && std::isfinite(linear_displacement.y) && std::isfinite(linear_displacement.z))
-                {
-                    body->rb.transform.translate(linear_displacement);
-                }
+    for (int i=0; i<2;i++)
+    {
+        const BodyHandle body = collision.bodies[i];
 
+        // Angular resolution
+        linkit::real limit = static_cast<linkit::real>(0.2) * contact.relative_positions[i].magnitude();
+        if (linkit::real_abs(angular_move[i]) > limit)
+        {
+            linkit::real total_move = linear_move[i] + angular_move[i];
+            if (angular_move[i] >= 0)
+            {
+                angular_move[i] = limit;
+            } else
+            {
+                angular_move[i] = -limit;
             }
+            linear_move[i] = total_move - angular_move[i];
         }
-    }
 
+        // Only apply angular resolution if there's angular inertia
+        if (linkit::real_abs(angular_inertia_contact[i]) > linkit::REAL_EPSILON)
+        {
+            linkit::Matrix3 inverse_inertia_tensor = world.inverse_inertia_tensors[body];
+            linkit::Vector3 impulsive_torque = contact.relative_positions[i] % contact.collision_normal;
+            linkit::Vector3 impulse_per_move = inverse_inertia_tensor * impulsive_torque;
+            linkit::Vector3 rotation_per_move = impulse_per_move * (1 / angular_inertia_contact[i]);
+            linkit::Vector3 rotation = rotation_per_move * angular_move[i];
+
+            // Safety check for NaN/Inf
+            if (std::isfinite(rotation.x) && std::isfinite(rotation.y) && std::isfinite(rotation.z))
+            {
+                world.orientations[body].add_scaled_vector(rotation, 1);
+                world.orientations[body].normalize();
+                angular_change[i] = rotation;
+            }
+        }
+
+        // Linear resolution
+        linkit::Vector3 linear_displacement = contact.collision_normal * linear_move[i];
+        if (std::isfinite(linear_displacement.x) && std::isfinite(linear_displacement.y) && std::isfinite(linear_displacement.z))
+        {
+            world.positions[body] += linear_displacement;
+            linear_change[i] = linear_displacement;
+        }
+
+    }
+    return true;
 }
 
 void CollisionHandler::clear_contacts() {
     collisions.clear();
+    ccd_candidates_.clear();
+}
+
+void CollisionHandler::continuous_phase(PhysicsWorld& world) {
+    // Every time of impact is found from the poses integration left, before any body is moved back
+    const std::size_t count = ccd_candidates_.size();
+    ccd_pair_hits_.resize(count);
+    ccd_body_toi_.assign(world.size(), 1);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        linkit::real toi;
+        ShapeDistance hit{};
+        ccd_pair_hits_[i] = time_of_impact(ccd_candidates_[i], world, toi, hit);
+        if (!ccd_pair_hits_[i]) continue;
+        for (const GameObject* obj : ccd_candidates_[i].objects)
+        {
+            ccd_body_toi_[obj->body] = std::min(ccd_body_toi_[obj->body], toi);
+        }
+    }
+
+    // A body in several fast pairs moves back once, to the earliest of its impacts. The rest of its motion
+    // this step is dropped
+    ccd_rewound_.assign(world.size(), 0);
+    for (const auto& pair : ccd_candidates_)
+    {
+        for (GameObject* obj : pair.objects)
+        {
+            const BodyHandle body = obj->body;
+            if (ccd_rewound_[body] || ccd_body_toi_[body] >= 1 || !world.has_finite_mass(body)) continue;
+            const linkit::real toi = ccd_body_toi_[body];
+            world.positions[body] = world.previous_positions[body] + (world.positions[body] - world.previous_positions[body]) * toi;
+            world.write_pose(body, obj->rb.transform);
+            ccd_rewound_[body] = 1;
+        }
+    }
+
+    // Contacts the narrow phase found for a body that has since moved back describe where it no longer is
+    for (auto& collision : collisions)
+    {
+        if (ccd_rewound_[collision.bodies[0]] || ccd_rewound_[collision.bodies[1]])
+        {
+            collision = test_discrete(collision.objects[0], collision.objects[1], world);
+        }
+    }
+    collisions.erase(std::remove_if(collisions.begin(), collisions.end(),
+                                    [](const CollisionData& collision) { return !collision.valid; }),
+                     collisions.end());
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        GameObject* const first = ccd_candidates_[i].objects[0];
+        GameObject* const second = ccd_candidates_[i].objects[1];
+        if (!ccd_pair_hits_[i])
+        {
+            // No approach along the path, but the pair may still be resting in or moving out of contact
+            detect_discrete(first, second, world);
+            continue;
+        }
+
+        // Measured where the bodies now are: a body stopped at an earlier impact may no longer reach this one
+        const ShapeDistance hit = shape_distance(first->get_collider(), world.positions[first->body],
+                                                 second->get_collider(), world.positions[second->body]);
+        const linkit::real core = std::min(core_radius(first->get_collider()), core_radius(second->get_collider()));
+        if (hit.distance > CCD_CONTACT_TOLERANCE * core) continue;
+
+        CollisionContact contact(hit.point, hit.normal, std::max(static_cast<linkit::real>(0), -hit.distance));
+        contact.relative_positions = {
+            (contact.collision_point - world.positions[first->body]),
+            (contact.collision_point - world.positions[second->body])
+        };
+
+        CollisionData collision_data;
+        collision_data.add_contact(contact);
+        collision_data.set_objects(first, second);
+        add_collision(collision_data);
+    }
+    ccd_candidates_.clear();
+}
+
+bool CollisionHandler::time_of_impact(const PotentialContact& pair, const PhysicsWorld& world,
+                                      linkit::real& toi, ShapeDistance& hit) const {
+    constexpr int MAX_ADVANCEMENT_STEPS = 16;
+
+    const ColliderPrimitive& first = pair.objects[0]->get_collider();
+    const ColliderPrimitive& second = pair.objects[1]->get_collider();
+    const BodyHandle bodies[2] = {pair.objects[0]->body, pair.objects[1]->body};
+
+    linkit::Vector3 motion[2];
+    for (int i=0; i<2; i++)
+    {
+        motion[i] = world.positions[bodies[i]] - world.previous_positions[bodies[i]];
+    }
+
+    // Only translation is swept, so the separation shrinks by at most this much over the step
+    const linkit::real relative_motion = (motion[1] - motion[0]).magnitude();
+    const linkit::real core = std::min(core_radius(first), core_radius(second));
+    if (relative_motion < linkit::REAL_EPSILON) return false;
+
+    linkit::real t = 0;
+    for (int i=0; i<MAX_ADVANCEMENT_STEPS; i++)
+    {
+        hit = shape_distance(first, world.previous_positions[bodies[0]] + motion[0] * t,
+                             second, world.previous_positions[bodies[1]] + motion[1] * t);
+        if (hit.distance <= CCD_CONTACT_TOLERANCE * core)
+        {
+            // Touching but already moving apart, e.g. right after a bounce
+            if ((motion[1] - motion[0]) * hit.normal >= 0) return false;
+            toi = t;
+            return true;
+        }
+
+        t += hit.distance / relative_motion;
+        if (t >= 1) return false;
+    }
+    return false;
+}
+
+bool CollisionHandler::is_fast_pair(const PotentialContact& pair, const PhysicsWorld& world) const {
+    const BodyHandle first = pair.objects[0]->body;
+    const BodyHandle second = pair.objects[1]->body;
+    const linkit::Vector3 relative_motion = (world.positions[second] - world.previous_positions[second]) -
+                                            (world.positions[first] - world.previous_positions[first]);
+    const linkit::real core = std::min(core_radius(pair.objects[0]->get_collider()), core_radius(pair.objects[1]->get_collider()));
+    const linkit::real limit = ccd_motion_threshold * core;
+    return relative_motion.magnitude_squared() > limit * limit;
+}
+
+linkit::real CollisionHandler::core_radius(const ColliderPrimitive& collider) {
+    if (collider.tag == "ColliderSphere")
+    {
+        return dynamic_cast<const ColliderSphere&>(collider).radius;
+    }
+    const linkit::Vector3& half_sizes = dynamic_cast<const ColliderBox&>(collider).half_sizes;
+    return std::min({half_sizes.x, half_sizes.y, half_sizes.z});
+}
+
+CollisionHandler::ShapeDistance CollisionHandler::sphere_box_distance(const linkit::Vector3& center, const linkit::real radius,
+                                                                      const ColliderBox& box, const linkit::Vector3& box_position) {
+    BoxAxes box_axes = get_box_axes(box.get_transform());
+    box_axes.center = box_position;
+    return sphere_box_distance(center, radius, box_axes, box.half_sizes);
+}
+
+CollisionHandler::ShapeDistance CollisionHandler::sphere_box_distance(const linkit::Vector3& center, const linkit::real radius,
+                                                                      const BoxAxes& box_axes, const linkit::Vector3& box_half_sizes) {
+    const linkit::real half_sizes[3] = {box_half_sizes.x, box_half_sizes.y, box_half_sizes.z};
+
+    // Closest point on the box to the sphere center
+    const linkit::Vector3 box_position = box_axes.center;
+    const linkit::Vector3 relative_center = center - box_position;
+    linkit::Vector3 closest = box_position;
+    for (int i=0; i<3; i++)
+    {
+        closest += box_axes.axes[i] * std::clamp(relative_center * box_axes.axes[i], -half_sizes[i], half_sizes[i]);
+    }
+
+    const linkit::Vector3 delta = closest - center;
+    const linkit::real distance = delta.magnitude();
+    if (distance < linkit::REAL_EPSILON)
+    {
+        // Center inside the box: the way out is through the nearest face
+        int face_axis = 0;
+        linkit::real face_depth = half_sizes[0] - linkit::real_abs(relative_center * box_axes.axes[0]);
+        for (int i=1; i<3; i++)
+        {
+            const linkit::real depth = half_sizes[i] - linkit::real_abs(relative_center * box_axes.axes[i]);
+            if (depth < face_depth)
+            {
+                face_depth = depth;
+                face_axis = i;
+            }
+        }
+        const linkit::real side = relative_center * box_axes.axes[face_axis] < 0 ? 1 : -1;
+        return {-radius - face_depth, box_axes.axes[face_axis] * side, center};
+    }
+    return {distance - radius, delta / distance, closest};
+}
+
+CollisionHandler::ShapeDistance CollisionHandler::shape_distance(const ColliderPrimitive& first, const linkit::Vector3& first_position,
+                                                                 const ColliderPrimitive& second, const linkit::Vector3& second_position) {
+    const bool first_is_sphere = first.tag == "ColliderSphere";
+    const bool second_is_sphere = second.tag == "ColliderSphere";
+
+    if (first_is_sphere && second_is_sphere)
+    {
+        const linkit::real radius_sum = dynamic_cast<const ColliderSphere&>(first).radius + dynamic_cast<const ColliderSphere&>(second).radius;
+        linkit::Vector3 normal = second_position - first_position;
+        const linkit::real distance = normal.magnitude();
+        if (distance > linkit::REAL_EPSILON) normal = normal / distance;
+        return {distance - radius_sum, normal, first_position + normal * dynamic_cast<const ColliderSphere&>(first).radius};
+    }
+
+    // Box against box: the box with the thinner core is swept as its inscribed sphere
+    const bool sweep_first = first_is_sphere || (!second_is_sphere && core_radius(first) <= core_radius(second));
+    if (sweep_first)
+    {
+        return sphere_box_distance(first_position, core_radius(first), dynamic_cast<const ColliderBox&>(second), second_position);
+    }
+
+    ShapeDistance result = sphere_box_distance(second_position, core_radius(second), dynamic_cast<const ColliderBox&>(first), first_position);
+    result.normal = result.normal * -1;
+    return result;
+}
+
+void CollisionHandler::cache_contact_state(const PhysicsWorld& world) {
+    cached_positions_ = world.positions;
+    cached_orientations_ = world.orientations;
+
+    for (auto& collision : collisions)
+    {
+        for (auto& contact : collision.contacts)
+        {
+            contact.initial_penetration_depth = contact.penetration_depth;
+            contact.initial_relative_positions = contact.relative_positions;
+        }
+    }
+}
+
+void CollisionHandler::update_contact_separation(const PhysicsWorld& world) {
+    for (auto& collision : collisions)
+    {
+        // Rotation of each body since the contacts were cached: q_now * conjugate(q_cached)
+        linkit::Quaternion delta_rotation[2];
+        for (int i=0; i<2; i++)
+        {
+            const linkit::Quaternion& a = world.orientations[collision.bodies[i]];
+            const linkit::Quaternion& b = cached_orientations_[collision.bodies[i]];
+            delta_rotation[i] = linkit::Quaternion(
+                a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z,
+                -a.w * b.x + a.x * b.w - a.y * b.z + a.z * b.y,
+                -a.w * b.y + a.x * b.z + a.y * b.w - a.z * b.x,
+                -a.w * b.z - a.x * b.y + a.y * b.x + a.z * b.w
+            );
+        }
+
+        for (auto& contact : collision.contacts)
+        {
+            // Displacement of the contact point attached to each body
+            linkit::Vector3 displacement[2];
+            for (int i=0; i<2; i++)
+            {
+                const BodyHandle body = collision.bodies[i];
+                contact.relative_positions[i] = delta_rotation[i].rotate(contact.initial_relative_positions[i]);
+                displacement[i] = (world.positions[body] - cached_positions_[body]) +
+                    (contact.relative_positions[i] - contact.initial_relative_positions[i]);
+            }
+
+            // Body 1 moving along the normal relative to body 0 separates the pair
+            contact.penetration_depth = contact.initial_penetration_depth -
+                (displacement[1] - displacement[0]) * contact.collision_normal;
+        }
+    }
 }
 
 // ============================================================================
@@ -653,12 +1078,12 @@ void CollisionHandler::generate_face_contacts(
     // Make sure normal points toward incident box
     if (ref_normal * to_incident < 0)
     {
-        ref_normal = ref_normal * -1.0f;
+        ref_normal = ref_normal * -1;
     }
 
     // Find the incident face (most anti-parallel to reference normal)
     int incident_face_index = 0;
-    linkit::real min_dot = 1e20f;
+    linkit::real min_dot = REAL_MAX;
 
     for (int i = 0; i < 3; ++i)
     {
@@ -690,7 +1115,7 @@ void CollisionHandler::generate_face_contacts(
     linkit::Vector3 face_offset = inc_axes.axes[incident_face_index] * inc_half_sizes[incident_face_index];
     if (dot_check > 0)
     {
-        face_offset = face_offset * -1.0f;
+        face_offset = face_offset * -1;
     }
 
     linkit::Vector3 face_center = inc_axes.center + face_offset;
@@ -717,7 +1142,7 @@ void CollisionHandler::generate_face_contacts(
 
     // Plane 2: -ref_axis1
     plane_offset = -(ref_axes.center * ref_axes.axes[ref_axis1]) + ref_half_sizes[ref_axis1];
-    clipped = clip_polygon_against_plane(clipped, ref_axes.axes[ref_axis1] * -1.0f, plane_offset);
+    clipped = clip_polygon_against_plane(clipped, ref_axes.axes[ref_axis1] * -1, plane_offset);
 
     // Plane 3: +ref_axis2
     plane_offset = (ref_axes.center * ref_axes.axes[ref_axis2]) + ref_half_sizes[ref_axis2];
@@ -725,7 +1150,7 @@ void CollisionHandler::generate_face_contacts(
 
     // Plane 4: -ref_axis2
     plane_offset = -(ref_axes.center * ref_axes.axes[ref_axis2]) + ref_half_sizes[ref_axis2];
-    clipped = clip_polygon_against_plane(clipped, ref_axes.axes[ref_axis2] * -1.0f, plane_offset);
+    clipped = clip_polygon_against_plane(clipped, ref_axes.axes[ref_axis2] * -1, plane_offset);
 
     if (clipped.empty()) return;
 
@@ -738,7 +1163,7 @@ void CollisionHandler::generate_face_contacts(
     }
 
     // Determine the correct contact normal direction
-    linkit::Vector3 contact_normal = flip_normal ? (ref_normal * -1.0f) : ref_normal;
+    linkit::Vector3 contact_normal = flip_normal ? (ref_normal * -1) : ref_normal;
 
     // Create contacts for each clipped vertex that penetrates
     ContactFeature feature;
@@ -754,7 +1179,7 @@ void CollisionHandler::generate_face_contacts(
         if (depth > 0)
         {
             // Move the contact point to the reference face
-            linkit::Vector3 contact_point = point + ref_normal * depth * 0.5f;
+            linkit::Vector3 contact_point = point + ref_normal * depth * static_cast<linkit::real>(0.5);
 
             CollisionContact contact(contact_point, contact_normal, depth, feature);
             collision_data.add_contact(contact);
@@ -769,7 +1194,7 @@ linkit::Vector3 CollisionHandler::closest_point_on_edge(
     linkit::Vector3 to_point = point - edge_start;
     linkit::real edge_length_sq = edge_dir.magnitude_squared();
 
-    if (edge_length_sq < 1e-10)
+    if (edge_length_sq < PARALLEL_TOLERANCE)
     {
         return edge_start;
     }
@@ -811,16 +1236,16 @@ void CollisionHandler::generate_edge_edge_contact(
     linkit::Vector3 to_center = axes2.center - axes1.center;
 
     // For box 1, pick corner based on direction to box 2
-    linkit::real sign1_a = (to_center * axes1.axes[other1_a]) > 0 ? 1.0f : -1.0f;
-    linkit::real sign1_b = (to_center * axes1.axes[other1_b]) > 0 ? 1.0f : -1.0f;
+    linkit::real sign1_a = (to_center * axes1.axes[other1_a]) > 0 ? 1 : -1;
+    linkit::real sign1_b = (to_center * axes1.axes[other1_b]) > 0 ? 1 : -1;
 
     linkit::Vector3 edge1_mid = axes1.center +
                                 axes1.axes[other1_a] * (half1_arr[other1_a] * sign1_a) +
                                 axes1.axes[other1_b] * (half1_arr[other1_b] * sign1_b);
 
     // For box 2, pick corner based on direction from box 1
-    linkit::real sign2_a = (to_center * axes2.axes[other2_a]) < 0 ? 1.0f : -1.0f;
-    linkit::real sign2_b = (to_center * axes2.axes[other2_b]) < 0 ? 1.0f : -1.0f;
+    linkit::real sign2_a = (to_center * axes2.axes[other2_a]) < 0 ? 1 : -1;
+    linkit::real sign2_b = (to_center * axes2.axes[other2_b]) < 0 ? 1 : -1;
 
     linkit::Vector3 edge2_mid = axes2.center +
                                 axes2.axes[other2_a] * (half2_arr[other2_a] * sign2_a) +
@@ -841,7 +1266,7 @@ void CollisionHandler::generate_edge_edge_contact(
 
     linkit::real s, t;
 
-    if (std::abs(denom) < 1e-10f)
+    if (std::abs(denom) < PARALLEL_TOLERANCE)
     {
         // Edges are nearly parallel - this shouldn't happen often due to SAT checks
         s = 0;
@@ -862,13 +1287,13 @@ void CollisionHandler::generate_edge_edge_contact(
     linkit::Vector3 point2 = edge2_mid + edge_dir_2 * t;
 
     // Contact point is the midpoint
-    linkit::Vector3 contact_point = (point1 + point2) * 0.5f;
+    linkit::Vector3 contact_point = (point1 + point2) * static_cast<linkit::real>(0.5);
 
     // Ensure normal points from first to second
     linkit::Vector3 contact_normal = best_axis;
     if (contact_normal * to_center < 0)
     {
-        contact_normal = contact_normal * -1.0f;
+        contact_normal = contact_normal * -1;
     }
 
     ContactFeature feature;
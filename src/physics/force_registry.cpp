@@ -1,10 +1,44 @@
 #include "vectra/physics/force_registry.h"
 #include <algorithm>
 #include <iostream>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "vectra/physics/parallel.h"
+
+#include "vectra/physics/forces/anchored_spring.h"
+#include "vectra/physics/forces/object_anchored_spring.h"
+#include "vectra/physics/forces/simple_gravity.h"
+
+namespace
+{
+    // A binding costs tens of nanoseconds, so a thread only pays for itself with thousands of them
+    constexpr std::size_t MIN_BINDINGS_PER_THREAD = 4096;
+    constexpr std::size_t MIN_BODIES_PER_REDUCTION_THREAD = 16384;
+
+    // Share thread_index of thread_count of a batch, as [first, first + count)
+    std::pair<std::size_t, std::size_t> share(const std::size_t size, const std::size_t thread_index, const std::size_t thread_count)
+    {
+        const std::size_t first = size * thread_index / thread_count;
+        const std::size_t last = size * (thread_index + 1) / thread_count;
+        return {first, last - first};
+    }
+}
 
 void ForceRegistry::add(GameObject* obj, std::shared_ptr<ForceGenerator> fg)
 {
-    registered_forces.push_back({obj, fg});
+    registered_forces.push_back({obj, obj->body, fg});
+    batches_dirty_ = true;
+
+    if (obj->body == INVALID_BODY_HANDLE) return;
+    if (obj->body >= body_forces_.size())
+    {
+        body_forces_.resize(obj->body + 1);
+        spring_slots_.resize(obj->body + 1, nullptr);
+    }
+    body_forces_[obj->body].push_back(fg);
+    if (spring_slots_[obj->body] == nullptr) refresh_spring_slot(obj->body);
 }
 
 void ForceRegistry::remove(GameObject* obj, std::shared_ptr<ForceGenerator> fg)
@@ -15,30 +49,156 @@ void ForceRegistry::remove(GameObject* obj, std::shared_ptr<ForceGenerator> fg)
                 return reg.obj == obj && reg.force_generator == fg;
             }),
         registered_forces.end());
+    batches_dirty_ = true;
+
+    if (obj->body >= body_forces_.size()) return;
+    auto& forces = body_forces_[obj->body];
+    forces.erase(std::remove(forces.begin(), forces.end(), fg), forces.end());
+    refresh_spring_slot(obj->body);
 }
 
 std::vector<std::shared_ptr<ForceGenerator>> ForceRegistry::object_forces(GameObject* obj) const
 {
-    std::vector<std::shared_ptr<ForceGenerator>> forces;
-    for (const auto& reg : registered_forces)
+    if (obj->body >= body_forces_.size()) return {};
+    return body_forces_[obj->body];
+}
+
+bool ForceRegistry::spring_anchor(const BodyHandle body, linkit::Vector3& anchor) const
+{
+    if (body >= spring_slots_.size() || spring_slots_[body] == nullptr) return false;
+
+    const ForceGenerator* spring = spring_slots_[body];
+    if (spring->kind() == ForceGeneratorKind::ANCHORED_SPRING)
+        anchor = static_cast<const AnchoredSpring*>(spring)->get_anchor_point();
+    else
+        anchor = static_cast<const ObjectAnchoredSpring*>(spring)->get_anchor_point();
+    return true;
+}
+
+void ForceRegistry::refresh_spring_slot(const BodyHandle body)
+{
+    spring_slots_[body] = nullptr;
+    for (const auto& fg : body_forces_[body])
     {
-        if (reg.obj == obj)
+        const ForceGeneratorKind kind = fg->kind();
+        if (kind == ForceGeneratorKind::ANCHORED_SPRING || kind == ForceGeneratorKind::OBJECT_ANCHORED_SPRING)
         {
-            forces.push_back(reg.force_generator);
+            spring_slots_[body] = fg.get();
+            return;
         }
     }
-    return forces;
 }
 
 void ForceRegistry::clear()
 {
     registered_forces.clear();
+    batches_dirty_ = true;
+    body_forces_.clear();
+    spring_slots_.clear();
 }
 
-void ForceRegistry::update_forces(const linkit::real dt)
+void ForceRegistry::rebuild_batches()
 {
-    for (auto& reg : registered_forces)
+    unique_generators_.clear();
+    simple_gravity_batch_.clear();
+    anchored_spring_batch_.clear();
+    object_anchored_spring_batch_.clear();
+    custom_batch_.clear();
+
+    std::unordered_map<const ForceGenerator*, std::size_t> first_registration;
+    for (const auto& reg : registered_forces)
     {
-        reg.force_generator->update_force(*reg.obj, dt);
+        ForceGenerator* generator = reg.force_generator.get();
+        if (first_registration.try_emplace(generator, unique_generators_.size()).second)
+        {
+            unique_generators_.push_back(generator);
+        }
+
+        const ForceBinding binding{generator, reg.body};
+        switch (generator->kind())
+        {
+            case ForceGeneratorKind::SIMPLE_GRAVITY:
+                simple_gravity_batch_.push_back(binding);
+                break;
+            case ForceGeneratorKind::ANCHORED_SPRING:
+                anchored_spring_batch_.push_back(binding);
+                break;
+            case ForceGeneratorKind::OBJECT_ANCHORED_SPRING:
+                object_anchored_spring_batch_.push_back(binding);
+                break;
+            case ForceGeneratorKind::CUSTOM:
+                custom_batch_.push_back(binding);
+                break;
+        }
     }
-}
\ No newline at end of file
+
+    // A field shared by many bodies is then loaded once and applied down a contiguous body list
+    std::stable_sort(simple_gravity_batch_.begin(), simple_gravity_batch_.end(),
+        [&](const ForceBinding& a, const ForceBinding& b) {
+            return first_registration[a.generator] < first_registration[b.generator];
+        });
+
+    batches_dirty_ = false;
+}
+
+void ForceRegistry::evaluate_share(const PhysicsWorld& world, ForceAccumulator& accumulator,
+                                   const std::size_t thread_index, const std::size_t thread_count, const linkit::real dt) const
+{
+    auto [first, count] = share(simple_gravity_batch_.size(), thread_index, thread_count);
+    SimpleGravity::update_batch(world, accumulator, simple_gravity_batch_.data() + first, count);
+
+    std::tie(first, count) = share(anchored_spring_batch_.size(), thread_index, thread_count);
+    AnchoredSpring::update_batch(world, accumulator, anchored_spring_batch_.data() + first, count);
+
+    std::tie(first, count) = share(object_anchored_spring_batch_.size(), thread_index, thread_count);
+    ObjectAnchoredSpring::update_batch(world, accumulator, object_anchored_spring_batch_.data() + first, count);
+
+    std::tie(first, count) = share(custom_batch_.size(), thread_index, thread_count);
+    for (std::size_t i = first; i < first + count; i++)
+    {
+        custom_batch_[i].generator->update_force(world, accumulator, custom_batch_[i].body, dt);
+    }
+}
+
+void ForceRegistry::update_forces(PhysicsWorld& world, const linkit::real dt)
+{
+    if (batches_dirty_) rebuild_batches();
+
+    // Generators shared between bodies are prepared once
+    for (ForceGenerator* generator : unique_generators_)
+    {
+        generator->prepare(world, dt);
+    }
+
+    const std::size_t bindings = simple_gravity_batch_.size() + anchored_spring_batch_.size() +
+                                 object_anchored_spring_batch_.size() + custom_batch_.size();
+    const std::size_t thread_count = worker_count(bindings, MIN_BINDINGS_PER_THREAD);
+    const std::size_t n = world.size();
+
+    // Every thread reads the same frozen world and writes only its own accumulator
+    thread_forces_.resize(thread_count);
+    thread_torques_.resize(thread_count);
+    run_on_threads(thread_count, [&](const std::size_t t)
+    {
+        ForceAccumulator accumulator{world.accumulated_forces.data(), world.accumulated_torques.data(), world.positions.data()};
+        if (t > 0)
+        {
+            thread_forces_[t].assign(n, linkit::Vector3(0, 0, 0));
+            thread_torques_[t].assign(n, linkit::Vector3(0, 0, 0));
+            accumulator.forces = thread_forces_[t].data();
+            accumulator.torques = thread_torques_[t].data();
+        }
+        evaluate_share(world, accumulator, t, thread_count, dt);
+    });
+    if (thread_count == 1) return;
+
+    // Reduce in thread order so the result doesn't depend on scheduling
+    parallel_for(n, MIN_BODIES_PER_REDUCTION_THREAD, [&](const std::size_t i)
+    {
+        for (std::size_t t = 1; t < thread_count; t++)
+        {
+            world.accumulated_forces[i] += thread_forces_[t][i];
+            world.accumulated_torques[i] += thread_torques_[t][i];
+        }
+    });
+}
@@ -7,17 +7,20 @@ rest_length(rest_length),
 damping(damping)
 {}
 
-void AnchoredSpring::update_force(GameObject& obj, linkit::real dt)
+void AnchoredSpring::update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, const BodyHandle body, linkit::real dt) const
 {
-    linkit::Vector3 force = obj.rb.transform.position;
-    force -= anchor_point;
-
-    linkit::real magnitude = force.magnitude();
-    magnitude = (rest_length - magnitude) * spring_constant;
+    accumulator.add_force(body, spring_force(world.positions[body], anchor_point, spring_constant, rest_length));
+}
 
-    force.normalize();
-    force *= magnitude;
-    obj.rb.add_force(force);
+void AnchoredSpring::update_batch(const PhysicsWorld& world, ForceAccumulator& accumulator, const ForceBinding* bindings, const std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const auto* spring = static_cast<const AnchoredSpring*>(bindings[i].generator);
+        const BodyHandle body = bindings[i].body;
+        accumulator.forces[body] += spring_force(world.positions[body], spring->anchor_point,
+                                                 spring->spring_constant, spring->rest_length);
+    }
 }
 
 linkit::Vector3 AnchoredSpring::get_anchor_point() const
@@ -1,7 +1,54 @@
 #include "vectra/physics/forces/newtonian_gravity.h"
+#include "vectra/physics/parallel.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <ostream>
+#include <type_traits>
+
+#if defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Cells with this many bodies or fewer are summed directly
+    constexpr std::uint32_t LEAF_CAPACITY = 8;
+    // Stops splitting bodies that sit on (almost) the same point
+    constexpr int MAX_OCTREE_DEPTH = 32;
+    // Below this many bodies per thread, spawning threads costs more than it saves
+    constexpr std::size_t MIN_BODIES_PER_THREAD = 256;
+    // The all-pairs inner loop handles this many partner bodies at a time in contiguous lanes
+    constexpr std::size_t PAIR_LANES = 8;
+
+    // 1 / sqrt(x) for PAIR_LANES values. Single precision uses the hardware estimate refined by one
+    // Newton step (about 23 correct bits); double precision has no estimate instruction to start from
+    template <class T>
+    void inverse_sqrt_lanes(const T* x, T* out)
+    {
+#if defined(__SSE__)
+        if constexpr (std::is_same_v<T, float>)
+        {
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 three_halves = _mm_set1_ps(1.5f);
+            for (std::size_t l = 0; l < PAIR_LANES; l += 4)
+            {
+                const __m128 v = _mm_load_ps(x + l);
+                __m128 y = _mm_rsqrt_ps(v);
+                // y *= 1.5 - 0.5 * v * y^2
+                y = _mm_mul_ps(y, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, v), _mm_mul_ps(y, y))));
+                _mm_store_ps(out + l, y);
+            }
+            return;
+        }
+#endif
+        for (std::size_t l = 0; l < PAIR_LANES; l++)
+        {
+            out[l] = 1 / std::sqrt(x[l]);
+        }
+    }
+}
 
 
 NewtonianGravity::NewtonianGravity(const linkit::real g_const)
@@ -14,19 +61,335 @@ NewtonianGravity::NewtonianGravity(std::vector<GameObject*> game_objects, const
 {
 }
 
-void NewtonianGravity::update_force(GameObject& obj, linkit::real dt)
+void NewtonianGravity::prepare(const PhysicsWorld& world, linkit::real dt)
+{
+    switch (method)
+    {
+        case GravityMethod::ALL_PAIRS:
+            prepare_all_pairs(world);
+            break;
+        case GravityMethod::BARNES_HUT:
+            prepare_barnes_hut(world);
+            break;
+        case GravityMethod::PER_BODY:
+            break;
+    }
+}
+
+void NewtonianGravity::prepare_all_pairs(const PhysicsWorld& world)
+{
+    sources_.clear();
+    pair_x_.clear();
+    pair_y_.clear();
+    pair_z_.clear();
+    pair_source_mass_.clear();
+    for (const auto* other : affected_objects)
+    {
+        if (other == nullptr) continue;
+
+        // Zero-mass bodies still feel the pull of the others, they just exert the substitute mass
+        linkit::real mass = world.masses[other->body];
+        if (mass == 0) mass = cero_mass_substitute;
+
+        const linkit::Vector3& position = world.positions[other->body];
+        sources_.push_back({position, mass, other->body});
+        pair_x_.push_back(position.x);
+        pair_y_.push_back(position.y);
+        pair_z_.push_back(position.z);
+        pair_source_mass_.push_back(mass);
+    }
+
+    const std::size_t n = sources_.size();
+    cached_index_.assign(world.size(), -1);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        cached_index_[sources_[i].body] = static_cast<std::int32_t>(i);
+    }
+    cached_forces_.resize(n);
+    if (n == 0) return;
+
+    // Rows are dealt out cyclically, so every thread gets a similar share of the triangle of pairs
+    const std::size_t thread_count = worker_count(n, MIN_BODIES_PER_THREAD);
+    thread_accelerations_.resize(thread_count);
+    run_on_threads(thread_count, [&](const std::size_t t)
+    {
+        auto& accelerations = thread_accelerations_[t];
+        accelerations.assign(3 * n, 0);
+        all_pairs_rows(t, thread_count, accelerations.data());
+    });
+
+    // Reduce in thread order so the result doesn't depend on scheduling
+    parallel_for(n, MIN_BODIES_PER_THREAD, [&](const std::size_t i)
+    {
+        linkit::Vector3 acceleration(0, 0, 0);
+        for (std::size_t t = 0; t < thread_count; t++)
+        {
+            const linkit::real* accelerations = thread_accelerations_[t].data();
+            acceleration += linkit::Vector3(accelerations[i], accelerations[n + i], accelerations[2 * n + i]);
+        }
+        cached_forces_[i] = acceleration * (gravitational_constant * world.masses[sources_[i].body]);
+    });
+}
+
+void NewtonianGravity::all_pairs_rows(const std::size_t first_row, const std::size_t stride, linkit::real* accelerations) const
+{
+    using linkit::real;
+    constexpr std::size_t L = PAIR_LANES;
+
+    const std::size_t n = pair_x_.size();
+    const real softening_sq = softening * softening;
+    real* ax_out = accelerations;
+    real* ay_out = accelerations + n;
+    real* az_out = accelerations + 2 * n;
+
+    alignas(64) real dx[L], dy[L], dz[L], r2[L], inverse_r[L], weight[L];
+
+    for (std::size_t i = first_row; i < n; i += stride)
+    {
+        const real xi = pair_x_[i];
+        const real yi = pair_y_[i];
+        const real zi = pair_z_[i];
+        const real mass_i = pair_source_mass_[i];
+
+        real ax = 0, ay = 0, az = 0;
+        for (std::size_t first = i + 1; first < n; first += L)
+        {
+            const std::size_t count = std::min(L, n - first);
+
+            for (std::size_t l = 0; l < L; l++)
+            {
+                const bool used = l < count;
+                dx[l] = used ? pair_x_[first + l] - xi : 0;
+                dy[l] = used ? pair_y_[first + l] - yi : 0;
+                dz[l] = used ? pair_z_[first + l] - zi : 0;
+
+                // Avoid division by zero or huge forces at close distances, same as the per-body sum
+                const real distance_sq = dx[l] * dx[l] + dy[l] * dy[l] + dz[l] * dz[l];
+                const bool valid = used && distance_sq >= linkit::REAL_EPSILON;
+                r2[l] = valid ? distance_sq + softening_sq : 1;
+                weight[l] = valid ? 1 : 0;
+            }
+
+            inverse_sqrt_lanes(r2, inverse_r);
+
+            for (std::size_t l = 0; l < count; l++)
+            {
+                const real k = weight[l] * inverse_r[l] * inverse_r[l] * inverse_r[l];
+                const real toward_j = k * pair_source_mass_[first + l];
+                const real toward_i = k * mass_i;
+
+                ax += toward_j * dx[l];
+                ay += toward_j * dy[l];
+                az += toward_j * dz[l];
+
+                ax_out[first + l] -= toward_i * dx[l];
+                ay_out[first + l] -= toward_i * dy[l];
+                az_out[first + l] -= toward_i * dz[l];
+            }
+        }
+
+        ax_out[i] += ax;
+        ay_out[i] += ay;
+        az_out[i] += az;
+    }
+}
+
+void NewtonianGravity::prepare_barnes_hut(const PhysicsWorld& world)
+{
+    sources_.clear();
+    nodes_.clear();
+    for (const auto* other : affected_objects)
+    {
+        if (other == nullptr) continue;
+
+        linkit::real mass = world.masses[other->body];
+        if (mass == 0) mass = cero_mass_substitute;
+        if (mass == 0) continue; // Pulls on nothing
+
+        sources_.push_back({world.positions[other->body], mass, other->body});
+    }
+    if (sources_.empty()) return;
+
+    // Root cell: cube around all sources
+    linkit::Vector3 min_corner = sources_[0].position;
+    linkit::Vector3 max_corner = sources_[0].position;
+    for (const auto& source : sources_)
+    {
+        min_corner.x = std::min(min_corner.x, source.position.x);
+        min_corner.y = std::min(min_corner.y, source.position.y);
+        min_corner.z = std::min(min_corner.z, source.position.z);
+        max_corner.x = std::max(max_corner.x, source.position.x);
+        max_corner.y = std::max(max_corner.y, source.position.y);
+        max_corner.z = std::max(max_corner.z, source.position.z);
+    }
+    const linkit::Vector3 extent = max_corner - min_corner;
+    const linkit::real half_size = static_cast<linkit::real>(0.5) * std::max({extent.x, extent.y, extent.z, linkit::REAL_EPSILON});
+    build_node(0, static_cast<std::uint32_t>(sources_.size()), (min_corner + max_corner) * static_cast<linkit::real>(0.5), half_size, 0);
+
+    cached_index_.assign(world.size(), -1);
+    for (std::size_t i = 0; i < sources_.size(); i++)
+    {
+        cached_index_[sources_[i].body] = static_cast<std::int32_t>(i);
+    }
+
+    cached_forces_.resize(sources_.size());
+    parallel_for(sources_.size(), MIN_BODIES_PER_THREAD, [&](const std::size_t i)
+    {
+        const BodyHandle body = sources_[i].body;
+        if (!world.has_finite_mass(body))
+        {
+            cached_forces_[i] = linkit::Vector3(0, 0, 0);
+            return;
+        }
+        cached_forces_[i] = barnes_hut_field(sources_[i].position, body) * world.masses[body];
+    });
+}
+
+std::int32_t NewtonianGravity::build_node(const std::uint32_t first, const std::uint32_t count, const linkit::Vector3& center,
+                                          const linkit::real half_size, const int depth)
+{
+    const auto index = static_cast<std::int32_t>(nodes_.size());
+    nodes_.emplace_back();
+
+    OctreeNode node{};
+    node.center = center;
+    node.half_size = half_size;
+    node.first = first;
+    node.count = count;
+    std::fill(std::begin(node.children), std::end(node.children), -1);
+
+    for (std::uint32_t i = first; i < first + count; i++)
+    {
+        node.mass += sources_[i].mass;
+        node.center_of_mass += sources_[i].position * sources_[i].mass;
+    }
+    node.center_of_mass = node.center_of_mass * (1 / node.mass);
+
+    if (count > LEAF_CAPACITY && depth < MAX_OCTREE_DEPTH)
+    {
+        // Split the range into octants: by x, then each half by y, then each quarter by z
+        const auto begin = sources_.begin() + first;
+        const auto end = begin + count;
+        const auto split_x = std::partition(begin, end, [&](const Source& s) { return s.position.x < center.x; });
+        decltype(sources_.begin()) bounds[9];
+        bounds[0] = begin;
+        bounds[8] = end;
+        bounds[4] = split_x;
+        bounds[2] = std::partition(begin, split_x, [&](const Source& s) { return s.position.y < center.y; });
+        bounds[6] = std::partition(split_x, end, [&](const Source& s) { return s.position.y < center.y; });
+        for (int q = 0; q < 4; q++)
+        {
+            bounds[2 * q + 1] = std::partition(bounds[2 * q], bounds[2 * q + 2], [&](const Source& s) { return s.position.z < center.z; });
+        }
+
+        // Octant o has bit 2 set for +x, bit 1 for +y and bit 0 for +z
+        const linkit::real child_half = static_cast<linkit::real>(0.5) * half_size;
+        for (int octant = 0; octant < 8; octant++)
+        {
+            const auto child_count = static_cast<std::uint32_t>(bounds[octant + 1] - bounds[octant]);
+            if (child_count == 0) continue;
+
+            const linkit::Vector3 child_center(
+                center.x + ((octant & 4) ? child_half : -child_half),
+                center.y + ((octant & 2) ? child_half : -child_half),
+                center.z + ((octant & 1) ? child_half : -child_half)
+            );
+            const auto child_first = static_cast<std::uint32_t>(bounds[octant] - sources_.begin());
+            node.children[octant] = build_node(child_first, child_count, child_center, child_half, depth + 1);
+        }
+    }
+
+    nodes_[index] = node;
+    return index;
+}
+
+linkit::Vector3 NewtonianGravity::barnes_hut_field(const linkit::Vector3& position, const BodyHandle body) const
+{
+    linkit::Vector3 field(0, 0, 0);
+    if (nodes_.empty()) return field;
+
+    const linkit::real opening_angle_sq = opening_angle * opening_angle;
+    const linkit::real softening_sq = softening * softening;
+
+    std::int32_t stack[8 * (MAX_OCTREE_DEPTH + 1)];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0)
+    {
+        const OctreeNode& node = nodes_[stack[--stack_size]];
+
+        const linkit::Vector3 to_mass = node.center_of_mass - position;
+        const linkit::real distance_sq = to_mass * to_mass;
+        const linkit::real size = 2 * node.half_size;
+
+        const linkit::Vector3 from_center = position - node.center;
+        const bool inside = linkit::real_abs(from_center.x) <= node.half_size &&
+                            linkit::real_abs(from_center.y) <= node.half_size &&
+                            linkit::real_abs(from_center.z) <= node.half_size;
+
+        // Far enough away: the whole cell acts through its centre of mass
+        if (!inside && size * size < opening_angle_sq * distance_sq)
+        {
+            const linkit::real inverse_distance = 1 / linkit::real_sqrt(distance_sq + softening_sq);
+            field += to_mass * (node.mass * inverse_distance * inverse_distance * inverse_distance);
+            continue;
+        }
+
+        bool has_children = false;
+        for (const std::int32_t child : node.children)
+        {
+            if (child < 0) continue;
+            stack[stack_size++] = child;
+            has_children = true;
+        }
+        if (has_children) continue;
+
+        // Leaf: sum its bodies directly
+        for (std::uint32_t i = node.first; i < node.first + node.count; i++)
+        {
+            if (sources_[i].body == body) continue;
+
+            const linkit::Vector3 to_other = sources_[i].position - position;
+            const linkit::real other_distance_sq = to_other * to_other;
+
+            // Avoid division by zero or huge forces at close distances
+            if (other_distance_sq < linkit::REAL_EPSILON) continue;
+
+            const linkit::real inverse_distance = 1 / linkit::real_sqrt(other_distance_sq + softening_sq);
+            field += to_other * (sources_[i].mass * inverse_distance * inverse_distance * inverse_distance);
+        }
+    }
+
+    return field * gravitational_constant;
+}
+
+void NewtonianGravity::update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, const BodyHandle body, linkit::real dt) const
 {
-    if (!obj.rb.has_finite_mass()) return;
+    if (!world.has_finite_mass(body)) return;
+
+    if (method != GravityMethod::PER_BODY && body < cached_index_.size() && cached_index_[body] >= 0)
+    {
+        accumulator.add_force(body, cached_forces_[cached_index_[body]]);
+        return;
+    }
+
+    // A registered body that isn't one of the affected objects isn't covered by prepare
+    if (method == GravityMethod::BARNES_HUT)
+    {
+        accumulator.add_force(body, barnes_hut_field(world.positions[body], body) * world.masses[body]);
+        return;
+    }
 
     for (auto* other : affected_objects)
     {
         if (other == nullptr) continue;
-        if (other == &obj) continue;
+        if (other->body == body) continue;
 
-        linkit::real other_mass = other->rb.mass;
+        linkit::real other_mass = world.masses[other->body];
         if (other_mass == 0) other_mass = cero_mass_substitute;
 
-        linkit::Vector3 obj_to_other = other->rb.transform.position - obj.rb.transform.position;
+        linkit::Vector3 obj_to_other = world.positions[other->body] - world.positions[body];
         linkit::real distance_sq = obj_to_other*obj_to_other;
 
         // Avoid division by zero or huge forces at close distances
@@ -34,7 +397,7 @@ void NewtonianGravity::update_force(GameObject& obj, linkit::real dt)
 
         linkit::Vector3 force_dir = obj_to_other.normalized();
 
-        linkit::real force_magnitude = (gravitational_constant * obj.rb.mass * other_mass) / distance_sq;
-        obj.rb.add_force(force_magnitude * force_dir);
+        linkit::real force_magnitude = (gravitational_constant * world.masses[body] * other_mass) / distance_sq;
+        accumulator.add_force(body, force_magnitude * force_dir);
     }
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 #include "vectra/physics/forces/object_anchored_spring.h"
+#include "vectra/physics/forces/anchored_spring.h"
 
 /**
  *
@@ -16,17 +17,21 @@ ObjectAnchoredSpring::ObjectAnchoredSpring(GameObject* anchor_object, const link
 {
 }
 
-void ObjectAnchoredSpring::update_force(GameObject& obj, linkit::real dt)
+void ObjectAnchoredSpring::update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, const BodyHandle body, linkit::real dt) const
 {
-    linkit::Vector3 force = obj.rb.transform.position;
-    force -= anchor_object->rb.transform.position;
-
-    linkit::real magnitude = force.magnitude();
-    magnitude = (rest_length - magnitude) * spring_constant;
+    accumulator.add_force(body, spring_force(world.positions[body], world.positions[anchor_object->body],
+                                             spring_constant, rest_length));
+}
 
-    force.normalize();
-    force *= magnitude;
-    obj.rb.add_force(force);
+void ObjectAnchoredSpring::update_batch(const PhysicsWorld& world, ForceAccumulator& accumulator, const ForceBinding* bindings, const std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const auto* spring = static_cast<const ObjectAnchoredSpring*>(bindings[i].generator);
+        const BodyHandle body = bindings[i].body;
+        accumulator.forces[body] += spring_force(world.positions[body], world.positions[spring->anchor_object->body],
+                                                 spring->spring_constant, spring->rest_length);
+    }
 }
 
 linkit::Vector3 ObjectAnchoredSpring::get_anchor_point() const
@@ -11,8 +11,24 @@ SimpleGravity::SimpleGravity(const linkit::real acceleration)
 
 SimpleGravity::SimpleGravity(const linkit::Vector3& field) : gravitational_field(field) {};
 
-void SimpleGravity::update_force(GameObject& obj, linkit::real dt)
+void SimpleGravity::update_force(const PhysicsWorld& world, ForceAccumulator& accumulator, const BodyHandle body, linkit::real dt) const
 {
-    obj.rb.add_force(gravitational_field * obj.rb.mass);
+    accumulator.add_force(body, gravitational_field * world.masses[body]);
 
 }
+
+void SimpleGravity::update_batch(const PhysicsWorld& world, ForceAccumulator& accumulator, const ForceBinding* bindings, const std::size_t count)
+{
+    const ForceGenerator* current = nullptr;
+    linkit::Vector3 field;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (bindings[i].generator != current)
+        {
+            current = bindings[i].generator;
+            field = static_cast<const SimpleGravity*>(current)->gravitational_field;
+        }
+        const BodyHandle body = bindings[i].body;
+        accumulator.forces[body] += field * world.masses[body];
+    }
+}
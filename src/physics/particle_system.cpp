@@ -0,0 +1,407 @@
+#include "vectra/physics/particle_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "vectra/physics/colliders/collider_box.h"
+#include "vectra/physics/colliders/collider_sphere.h"
+#include "vectra/physics/parallel.h"
+
+namespace
+{
+    // A particle update is a handful of flops, so threads need large ranges to pay off
+    constexpr std::size_t MIN_PARTICLES_PER_THREAD = 16384;
+    constexpr std::size_t MIN_BUCKETS_PER_THREAD = 1024;
+
+    // Rigid collision hashes particles into cells at most this many across the system's bounds, and never
+    // narrower than a few particles, so each bucket's collider list is short and cheap to build.
+    // The bucket count is capped so the per-bucket boxes stay in cache
+    constexpr linkit::real RIGID_CELLS_ACROSS = 32;
+    constexpr linkit::real RIGID_CELL_PARTICLE_WIDTHS = 2;
+    constexpr std::size_t MAX_RIGID_BUCKETS = 16384;
+
+    bool sphere_overlaps_box(const linkit::Vector3& center, const linkit::real radius, const linkit::Vector3& low,
+                             const linkit::Vector3& high)
+    {
+        const linkit::Vector3 closest(std::clamp(center.x, low.x, high.x), std::clamp(center.y, low.y, high.y),
+                                      std::clamp(center.z, low.z, high.z));
+        return (center - closest).magnitude_squared() < radius * radius;
+    }
+
+    std::int64_t cell_coordinate(const linkit::real value, const linkit::real inverse_cell_size)
+    {
+        return static_cast<std::int64_t>(std::floor(value * inverse_cell_size));
+    }
+
+    // Calls update(i) for every particle across threads, then returns a sphere around the particles
+    template <class Function>
+    BoundingSphere update_and_bound(const std::vector<linkit::Vector3>& positions, const std::vector<linkit::real>& radii,
+                                    const Function& update)
+    {
+        struct Extent
+        {
+            linkit::Vector3 low;
+            linkit::Vector3 high;
+            linkit::real max_radius;
+        };
+        const linkit::real far = std::numeric_limits<linkit::real>::max();
+        const std::size_t count = positions.size();
+        const std::size_t thread_count = worker_count(count, MIN_PARTICLES_PER_THREAD);
+        std::vector<Extent> extents(thread_count, {linkit::Vector3(far, far, far), linkit::Vector3(-far, -far, -far), 0});
+
+        run_on_threads(thread_count, [&](const std::size_t t)
+        {
+            Extent& extent = extents[t];
+            const std::size_t last = count * (t + 1) / thread_count;
+            for (std::size_t i = count * t / thread_count; i < last; i++)
+            {
+                update(i);
+                const linkit::Vector3& p = positions[i];
+                extent.low = linkit::Vector3(std::min(extent.low.x, p.x), std::min(extent.low.y, p.y), std::min(extent.low.z, p.z));
+                extent.high = linkit::Vector3(std::max(extent.high.x, p.x), std::max(extent.high.y, p.y), std::max(extent.high.z, p.z));
+                extent.max_radius = std::max(extent.max_radius, radii[i]);
+            }
+        });
+
+        Extent total = extents[0];
+        for (std::size_t t = 1; t < thread_count; t++)
+        {
+            const Extent& extent = extents[t];
+            total.low = linkit::Vector3(std::min(total.low.x, extent.low.x), std::min(total.low.y, extent.low.y), std::min(total.low.z, extent.low.z));
+            total.high = linkit::Vector3(std::max(total.high.x, extent.high.x), std::max(total.high.y, extent.high.y), std::max(total.high.z, extent.high.z));
+            total.max_radius = std::max(total.max_radius, extent.max_radius);
+        }
+        if (count == 0) return BoundingSphere(linkit::Vector3(0, 0, 0), 0);
+
+        const linkit::Vector3 center = (total.low + total.high) * static_cast<linkit::real>(0.5);
+        return BoundingSphere(center, (total.high - center).magnitude() + total.max_radius);
+    }
+
+    // mt19937's sequence is fixed by the standard but the std distributions are not, so draws are scaled
+    // by hand for a seed to launch the same particles with every standard library. In [-1, 1)
+    linkit::real signed_unit(std::mt19937& engine)
+    {
+        return static_cast<linkit::real>(engine() / 2147483648.0 - 1.0);
+    }
+
+    std::uint32_t bucket(const std::int64_t x, const std::int64_t y, const std::int64_t z, const std::uint32_t bucket_count)
+    {
+        const std::uint64_t hash = static_cast<std::uint64_t>(x) * 73856093u
+                                 ^ static_cast<std::uint64_t>(y) * 19349663u
+                                 ^ static_cast<std::uint64_t>(z) * 83492791u;
+        return static_cast<std::uint32_t>(hash % bucket_count);
+    }
+}
+
+ParticleSystem::ParticleSystem(const std::uint32_t seed) : seed(seed), random_(seed)
+{
+}
+
+std::size_t ParticleSystem::size() const
+{
+    return positions.size();
+}
+
+void ParticleSystem::emit(const linkit::Vector3& position, const linkit::Vector3& velocity, const linkit::real radius,
+                          const linkit::real mass, const linkit::real lifetime)
+{
+    if (positions.size() >= max_particles) return;
+    positions.push_back(position);
+    velocities.push_back(velocity);
+    radii.push_back(radius);
+    masses.push_back(mass);
+    lifetimes.push_back(lifetime > 0 ? lifetime : std::numeric_limits<linkit::real>::infinity());
+}
+
+void ParticleSystem::run_emitters(const linkit::real dt)
+{
+    for (auto& emitter : emitters)
+    {
+        emitter.pending += emitter.rate * dt;
+        std::size_t count = static_cast<std::size_t>(emitter.pending);
+        emitter.pending -= static_cast<linkit::real>(count);
+        if (!emitter.burst_done)
+        {
+            count += std::max(0, emitter.burst);
+            emitter.burst_done = true;
+        }
+
+        count = std::min(count, max_particles - std::min(max_particles, positions.size()));
+        if (count == 0) continue;
+
+        linkit::Vector3 direction = emitter.direction;
+        direction.normalize();
+
+        positions.reserve(positions.size() + count);
+        velocities.reserve(velocities.size() + count);
+        radii.reserve(radii.size() + count);
+        masses.reserve(masses.size() + count);
+        lifetimes.reserve(lifetimes.size() + count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            // Drawn one by one, the order of evaluating constructor arguments is up to the compiler
+            const linkit::real x = signed_unit(random_);
+            const linkit::real y = signed_unit(random_);
+            const linkit::real z = signed_unit(random_);
+            linkit::Vector3 launch = direction + linkit::Vector3(x, y, z) * emitter.spread;
+            launch.normalize();
+            emit(emitter.position, launch * emitter.speed, emitter.radius, emitter.mass, emitter.lifetime);
+        }
+    }
+}
+
+void ParticleSystem::remove_dead(const linkit::real dt)
+{
+    std::size_t i = 0;
+    while (i < positions.size())
+    {
+        lifetimes[i] -= dt;
+        if (lifetimes[i] > 0)
+        {
+            i++;
+            continue;
+        }
+
+        // Swap in the last particle, which is aged when the loop reaches it
+        const std::size_t last = positions.size() - 1;
+        positions[i] = positions[last];
+        velocities[i] = velocities[last];
+        radii[i] = radii[last];
+        masses[i] = masses[last];
+        lifetimes[i] = lifetimes[last] + dt;
+        positions.pop_back();
+        velocities.pop_back();
+        radii.pop_back();
+        masses.pop_back();
+        lifetimes.pop_back();
+    }
+}
+
+void ParticleSystem::integrate(const linkit::real dt)
+{
+    const linkit::Vector3 gravity_change = gravity * dt;
+    const linkit::real velocity_scale = std::max(static_cast<linkit::real>(0), 1 - drag * dt);
+    bounds_ = update_and_bound(positions, radii, [&](const std::size_t i)
+    {
+        velocities[i] = (velocities[i] + gravity_change) * velocity_scale;
+        positions[i] += velocities[i] * dt;
+    });
+}
+
+void ParticleSystem::collide_with_particles()
+{
+    const std::size_t count = positions.size();
+    if (count < 2) return;
+
+    // Cells as wide as the largest particle, so touching particles are at most one cell apart
+    const linkit::real cell_size = 2 * *std::max_element(radii.begin(), radii.end());
+    if (cell_size <= linkit::REAL_EPSILON) return;
+    const linkit::real inverse_cell_size = 1 / cell_size;
+
+    // Counting sort of the particles by bucket
+    const std::uint32_t bucket_count = static_cast<std::uint32_t>(2 * count);
+    bucket_of_.resize(count);
+    bucket_start_.assign(bucket_count + 1, 0);
+    sorted_.resize(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        bucket_of_[i] = bucket(cell_coordinate(positions[i].x, inverse_cell_size), cell_coordinate(positions[i].y, inverse_cell_size),
+                               cell_coordinate(positions[i].z, inverse_cell_size), bucket_count);
+        bucket_start_[bucket_of_[i] + 1]++;
+    }
+    for (std::uint32_t b = 1; b <= bucket_count; b++) bucket_start_[b] += bucket_start_[b - 1];
+    {
+        std::vector<std::uint32_t> next(bucket_start_.begin(), bucket_start_.end() - 1);
+        for (std::size_t i = 0; i < count; i++) sorted_[next[bucket_of_[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    // Every particle gathers its own response from the state before this pass, so the result
+    // doesn't depend on order or thread count
+    position_changes_.assign(count, linkit::Vector3(0, 0, 0));
+    velocity_changes_.assign(count, linkit::Vector3(0, 0, 0));
+    parallel_for(count, MIN_PARTICLES_PER_THREAD, [&](const std::size_t i)
+    {
+        const std::int64_t cx = cell_coordinate(positions[i].x, inverse_cell_size);
+        const std::int64_t cy = cell_coordinate(positions[i].y, inverse_cell_size);
+        const std::int64_t cz = cell_coordinate(positions[i].z, inverse_cell_size);
+
+        std::uint32_t visited[27];
+        int visited_count = 0;
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dz = -1; dz <= 1; dz++)
+                {
+                    // Different cells can share a bucket, which must only be searched once
+                    const std::uint32_t b = bucket(cx + dx, cy + dy, cz + dz, bucket_count);
+                    if (std::find(visited, visited + visited_count, b) != visited + visited_count) continue;
+                    visited[visited_count++] = b;
+
+                    for (std::uint32_t k = bucket_start_[b]; k < bucket_start_[b + 1]; k++)
+                    {
+                        const std::uint32_t j = sorted_[k];
+                        if (j == i) continue;
+
+                        const linkit::Vector3 offset = positions[i] - positions[j];
+                        const linkit::real reach = radii[i] + radii[j];
+                        const linkit::real distance_squared = offset.magnitude_squared();
+                        if (distance_squared >= reach * reach || distance_squared < linkit::REAL_EPSILON) continue;
+
+                        const linkit::real distance = linkit::real_sqrt(distance_squared);
+                        const linkit::Vector3 normal = offset * (1 / distance);
+                        const linkit::real total_mass = masses[i] + masses[j];
+                        const linkit::real share = total_mass > 0 ? masses[j] / total_mass : static_cast<linkit::real>(0.5);
+                        position_changes_[i] += normal * ((reach - distance) * share);
+
+                        const linkit::real approach = (velocities[i] - velocities[j]) * normal;
+                        if (approach < 0) velocity_changes_[i] -= normal * ((1 + restitution) * approach * share);
+                    }
+                }
+            }
+        }
+    });
+
+    bounds_ = update_and_bound(positions, radii, [&](const std::size_t i)
+    {
+        positions[i] += position_changes_[i];
+        velocities[i] += velocity_changes_[i];
+    });
+}
+
+void ParticleSystem::collide_with_rigid_bodies()
+{
+    const std::size_t count = positions.size();
+    if (colliders_.empty() || count == 0) return;
+
+    // Particles are hashed into coarse cells, and each bucket keeps the colliders overlapping the box around
+    // its particles, so a particle is only tested against colliders near it rather than every one in bounds()
+    const linkit::real max_radius = *std::max_element(radii.begin(), radii.end());
+    const linkit::real cell_size = std::max({2 * max_radius * RIGID_CELL_PARTICLE_WIDTHS, 2 * bounds_.radius / RIGID_CELLS_ACROSS,
+                                             linkit::REAL_EPSILON});
+    const linkit::real inverse_cell_size = 1 / cell_size;
+    const std::uint32_t bucket_count = static_cast<std::uint32_t>(std::min<std::size_t>(2 * count, MAX_RIGID_BUCKETS));
+
+    // Empty buckets are left inside out, with low above high
+    const linkit::real infinity = std::numeric_limits<linkit::real>::infinity();
+    bucket_of_.resize(count);
+    bucket_low_.assign(bucket_count, linkit::Vector3(infinity, infinity, infinity));
+    bucket_high_.assign(bucket_count, linkit::Vector3(-infinity, -infinity, -infinity));
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const linkit::Vector3& p = positions[i];
+        bucket_of_[i] = bucket(cell_coordinate(p.x, inverse_cell_size), cell_coordinate(p.y, inverse_cell_size),
+                               cell_coordinate(p.z, inverse_cell_size), bucket_count);
+        linkit::Vector3& low = bucket_low_[bucket_of_[i]];
+        linkit::Vector3& high = bucket_high_[bucket_of_[i]];
+        low = linkit::Vector3(std::min(low.x, p.x), std::min(low.y, p.y), std::min(low.z, p.z));
+        high = linkit::Vector3(std::max(high.x, p.x), std::max(high.y, p.y), std::max(high.z, p.z));
+    }
+
+    const auto overlaps = [&](const RigidCollider& collider, const std::size_t b)
+    {
+        if (bucket_low_[b].x > bucket_high_[b].x) return false;
+        return sphere_overlaps_box(collider.frame.center, collider.radius + max_radius, bucket_low_[b], bucket_high_[b]);
+    };
+    bucket_collider_start_.assign(bucket_count + 1, 0);
+    parallel_for(bucket_count, MIN_BUCKETS_PER_THREAD, [&](const std::size_t b)
+    {
+        for (const RigidCollider& collider : colliders_)
+        {
+            if (overlaps(collider, b)) bucket_collider_start_[b + 1]++;
+        }
+    });
+    for (std::uint32_t b = 1; b <= bucket_count; b++) bucket_collider_start_[b] += bucket_collider_start_[b - 1];
+
+    // Colliders stay in their original order, so a particle meets them in the same order as before
+    bucket_colliders_.resize(bucket_collider_start_[bucket_count]);
+    parallel_for(bucket_count, MIN_BUCKETS_PER_THREAD, [&](const std::size_t b)
+    {
+        std::uint32_t next = bucket_collider_start_[b];
+        for (std::uint32_t c = 0; c < colliders_.size(); c++)
+        {
+            if (overlaps(colliders_[c], b)) bucket_colliders_[next++] = c;
+        }
+    });
+
+    parallel_for(count, MIN_PARTICLES_PER_THREAD, [&](const std::size_t i)
+    {
+        const std::uint32_t b = bucket_of_[i];
+        for (std::uint32_t k = bucket_collider_start_[b]; k < bucket_collider_start_[b + 1]; k++)
+        {
+            bounce_off(i, colliders_[bucket_colliders_[k]]);
+        }
+    });
+}
+
+void ParticleSystem::bounce_off(const std::size_t particle, const RigidCollider& collider)
+{
+    linkit::Vector3& position = positions[particle];
+    linkit::Vector3& velocity = velocities[particle];
+    const linkit::real radius = radii[particle];
+
+    // Every collider is tested as a sphere first, which is exact for spheres
+    const linkit::Vector3 offset = position - collider.frame.center;
+    const linkit::real reach = collider.radius + radius;
+    if (offset.magnitude_squared() >= reach * reach) return;
+
+    linkit::Vector3 normal; // Out of the rigid body
+    if (collider.is_sphere)
+    {
+        const linkit::real distance = offset.magnitude();
+        normal = distance > linkit::REAL_EPSILON ? offset * (1 / distance) : linkit::Vector3(0, 1, 0);
+        position += normal * (reach - distance);
+    }
+    else
+    {
+        const CollisionHandler::ShapeDistance hit = CollisionHandler::sphere_box_distance(position, radius, collider.frame, collider.half_sizes);
+        if (hit.distance >= 0) return;
+
+        normal = hit.normal * -1;
+        position += normal * -hit.distance;
+    }
+
+    // Bounce off the surface, losing some of the sliding velocity
+    const linkit::real normal_speed = velocity * normal;
+    if (normal_speed >= 0) return;
+    const linkit::Vector3 sliding = velocity - normal * normal_speed;
+    velocity = sliding * (1 - friction) - normal * (normal_speed * restitution);
+}
+
+void ParticleSystem::advance(const linkit::real dt)
+{
+    if (dt <= 0) return;
+
+    run_emitters(dt);
+    remove_dead(dt);
+    integrate(dt);
+    if (collide_particles) collide_with_particles();
+}
+
+void ParticleSystem::collide(const std::vector<GameObject*>& colliders)
+{
+    colliders_.clear();
+    for (const GameObject* obj : colliders)
+    {
+        if (!obj->collider) continue;
+        const ColliderPrimitive& collider = obj->get_collider();
+        if (collider.tag == "ColliderSphere")
+        {
+            CollisionHandler::BoxAxes frame;
+            frame.center = collider.get_transform().position;
+            colliders_.push_back({true, dynamic_cast<const ColliderSphere&>(collider).radius, frame, linkit::Vector3(0, 0, 0)});
+        }
+        else if (collider.tag == "ColliderBox")
+        {
+            const linkit::Vector3& half_sizes = dynamic_cast<const ColliderBox&>(collider).half_sizes;
+            colliders_.push_back({false, half_sizes.magnitude(), CollisionHandler::get_box_axes(collider.get_transform()), half_sizes});
+        }
+    }
+    collide_with_rigid_bodies();
+}
+
+const BoundingSphere& ParticleSystem::bounds() const
+{
+    return bounds_;
+}
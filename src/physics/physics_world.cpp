@@ -0,0 +1,276 @@
+#include "vectra/physics/physics_world.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "vectra/physics/parallel.h"
+
+namespace
+{
+    // Bodies are integrated in fixed-width blocks gathered into contiguous lanes, so the
+    // per-component loops in integrate_batch compile to packed SIMD arithmetic
+    constexpr std::size_t INTEGRATION_LANES = 8;
+
+    // Integrating a body takes tens of nanoseconds, clearing its accumulators a few
+    constexpr std::size_t MIN_BODIES_PER_THREAD = 4096;
+    constexpr std::size_t MIN_CLEARS_PER_THREAD = 65536;
+
+    // Relative change in accumulated force that wakes a sleeping body
+    constexpr linkit::real WAKE_FORCE_TOLERANCE = static_cast<linkit::real>(0.01);
+}
+
+BodyHandle PhysicsWorld::add_body(const Rigidbody& rb)
+{
+    const auto handle = static_cast<BodyHandle>(positions.size());
+
+    positions.push_back(rb.transform.position);
+    previous_positions.push_back(rb.transform.position);
+    orientations.push_back(rb.transform.rotation);
+    velocities.push_back(rb.velocity);
+    angular_velocities.push_back(rb.angular_velocity);
+    accumulated_forces.emplace_back(0, 0, 0);
+    accumulated_torques.emplace_back(0, 0, 0);
+    masses.push_back(rb.mass);
+    inverse_masses.push_back(rb.inverse_mass);
+    local_inverse_inertia_tensors.push_back(rb._local_inverse_inertia_tensor);
+    inverse_inertia_tensors.push_back(rb.get_inverse_inertia_tensor());
+    has_moved.push_back(0);
+    is_awake.push_back(1);
+    motion.push_back(2 * sleep_epsilon);
+    sleep_forces.emplace_back(0, 0, 0);
+
+    return handle;
+}
+
+std::size_t PhysicsWorld::size() const
+{
+    return positions.size();
+}
+
+void PhysicsWorld::clear()
+{
+    positions.clear();
+    previous_positions.clear();
+    orientations.clear();
+    velocities.clear();
+    angular_velocities.clear();
+    accumulated_forces.clear();
+    accumulated_torques.clear();
+    masses.clear();
+    inverse_masses.clear();
+    local_inverse_inertia_tensors.clear();
+    inverse_inertia_tensors.clear();
+    has_moved.clear();
+    is_awake.clear();
+    motion.clear();
+    sleep_forces.clear();
+    active_bodies.clear();
+}
+
+void PhysicsWorld::clear_accumulators()
+{
+    parallel_for(size(), MIN_CLEARS_PER_THREAD, [&](const std::size_t i)
+    {
+        accumulated_forces[i] = linkit::Vector3(0, 0, 0);
+        accumulated_torques[i] = linkit::Vector3(0, 0, 0);
+    });
+}
+
+void PhysicsWorld::add_force(const BodyHandle body, const linkit::Vector3& force)
+{
+    accumulated_forces[body] += force;
+}
+
+void PhysicsWorld::add_force_at_world_point(const BodyHandle body, const linkit::Vector3& force, const linkit::Vector3& point)
+{
+    accumulated_forces[body] += force;
+    linkit::Vector3 lever_arm = point - positions[body];
+    accumulated_torques[body] += lever_arm % force;
+}
+
+bool PhysicsWorld::has_finite_mass(const BodyHandle body) const
+{
+    return inverse_masses[body] != 0;
+}
+
+linkit::Matrix3 PhysicsWorld::inverse_inertia_tensor(const BodyHandle body) const
+{
+    // Change of basis optimisation as the inverse of a rotation matrix is its transpose
+    const linkit::Matrix3 rotation = orientations[body].to_matrix3();
+    return rotation * local_inverse_inertia_tensors[body] * rotation.transposed();
+}
+
+void PhysicsWorld::set_awake(const BodyHandle body, const bool awake)
+{
+    if (awake)
+    {
+        is_awake[body] = 1;
+        // Start above the threshold so the body doesn't fall straight back asleep
+        motion[body] = 2 * sleep_epsilon;
+        return;
+    }
+
+    is_awake[body] = 0;
+    velocities[body] = linkit::Vector3(0, 0, 0);
+    angular_velocities[body] = linkit::Vector3(0, 0, 0);
+    has_moved[body] = 0;
+    sleep_forces[body] = accumulated_forces[body];
+}
+
+void PhysicsWorld::build_active_list()
+{
+    active_bodies.clear();
+    for (std::size_t i = 0; i < size(); i++)
+    {
+        if (inverse_masses[i] == 0) continue; // Object is immovable
+
+        const auto body = static_cast<BodyHandle>(i);
+        if (!is_awake[i])
+        {
+            // Sleeping bodies wake up when the forces acting on them change
+            const linkit::Vector3 force_change = accumulated_forces[i] - sleep_forces[i];
+            const linkit::real reference = std::max(sleep_forces[i].magnitude_squared(), static_cast<linkit::real>(1));
+            if (allow_sleeping && force_change.magnitude_squared() <= WAKE_FORCE_TOLERANCE * WAKE_FORCE_TOLERANCE * reference)
+                continue;
+            set_awake(body, true);
+        }
+        active_bodies.push_back(body);
+    }
+}
+
+void PhysicsWorld::integrate(const linkit::real dt)
+{
+    build_active_list();
+    previous_positions = positions;
+
+    // Blocks touch disjoint bodies, so they can be integrated on any thread
+    const std::size_t blocks = (active_bodies.size() + INTEGRATION_LANES - 1) / INTEGRATION_LANES;
+    parallel_for(blocks, MIN_BODIES_PER_THREAD / INTEGRATION_LANES, [&](const std::size_t block)
+    {
+        const std::size_t first = block * INTEGRATION_LANES;
+        const std::size_t count = std::min(INTEGRATION_LANES, active_bodies.size() - first);
+        integrate_batch(active_bodies.data() + first, count, dt);
+    });
+}
+
+void PhysicsWorld::integrate_batch(const BodyHandle* bodies, const std::size_t count, const linkit::real dt)
+{
+    using linkit::real;
+    constexpr std::size_t L = INTEGRATION_LANES;
+
+    // Unused lanes stay zeroed and are never scattered back
+    alignas(64) real px[L]{}, py[L]{}, pz[L]{};
+    alignas(64) real vx[L]{}, vy[L]{}, vz[L]{};
+    alignas(64) real ax[L]{}, ay[L]{}, az[L]{};
+    alignas(64) real qw[L]{}, qx[L]{}, qy[L]{}, qz[L]{};
+    alignas(64) real wx[L]{}, wy[L]{}, wz[L]{};
+    alignas(64) real alx[L]{}, aly[L]{}, alz[L]{};
+    alignas(64) std::uint8_t moved[L]{};
+
+    // Gather. The world inverse inertia is computed once per body here and cached for the contact solver
+    for (std::size_t l = 0; l < count; l++)
+    {
+        const BodyHandle b = bodies[l];
+
+        // Change of basis optimisation as the inverse of a rotation matrix is its transpose
+        const linkit::Matrix3 rotation = orientations[b].to_matrix3();
+        inverse_inertia_tensors[b] = rotation * local_inverse_inertia_tensors[b] * rotation.transposed();
+
+        const linkit::Vector3 acceleration = accumulated_forces[b] * inverse_masses[b];
+        const linkit::Vector3 angular_acceleration = inverse_inertia_tensors[b] * accumulated_torques[b];
+
+        px[l] = positions[b].x; py[l] = positions[b].y; pz[l] = positions[b].z;
+        vx[l] = velocities[b].x; vy[l] = velocities[b].y; vz[l] = velocities[b].z;
+        ax[l] = acceleration.x; ay[l] = acceleration.y; az[l] = acceleration.z;
+        qw[l] = orientations[b].w; qx[l] = orientations[b].x; qy[l] = orientations[b].y; qz[l] = orientations[b].z;
+        wx[l] = angular_velocities[b].x; wy[l] = angular_velocities[b].y; wz[l] = angular_velocities[b].z;
+        alx[l] = angular_acceleration.x; aly[l] = angular_acceleration.y; alz[l] = angular_acceleration.z;
+    }
+
+    const real half_dt = static_cast<real>(0.5) * dt;
+    const real half_dt_squared = half_dt * dt;
+
+    // Linear
+    for (std::size_t l = 0; l < L; l++)
+    {
+        vx[l] += ax[l] * dt;
+        vy[l] += ay[l] * dt;
+        vz[l] += az[l] * dt;
+
+        moved[l] = (vx[l] * vx[l] + vy[l] * vy[l] + vz[l] * vz[l]) > linkit::REAL_EPSILON;
+
+        px[l] += vx[l] * dt + ax[l] * half_dt_squared;
+        py[l] += vy[l] * dt + ay[l] * half_dt_squared;
+        pz[l] += vz[l] * dt + az[l] * half_dt_squared;
+    }
+
+    // Angular: q += 1/2 * (0, w dt) * q, then normalise
+    for (std::size_t l = 0; l < L; l++)
+    {
+        wx[l] += alx[l] * dt;
+        wy[l] += aly[l] * dt;
+        wz[l] += alz[l] * dt;
+
+        const real hx = wx[l] * half_dt;
+        const real hy = wy[l] * half_dt;
+        const real hz = wz[l] * half_dt;
+
+        const real w = qw[l] - hx * qx[l] - hy * qy[l] - hz * qz[l];
+        const real x = qx[l] + hx * qw[l] + hy * qz[l] - hz * qy[l];
+        const real y = qy[l] + hy * qw[l] + hz * qx[l] - hx * qz[l];
+        const real z = qz[l] + hz * qw[l] + hx * qy[l] - hy * qx[l];
+
+        const real length_squared = w * w + x * x + y * y + z * z;
+        const real inverse_length = length_squared > 0 ? 1 / std::sqrt(length_squared) : 0;
+
+        qw[l] = length_squared > 0 ? w * inverse_length : 1;
+        qx[l] = x * inverse_length;
+        qy[l] = y * inverse_length;
+        qz[l] = z * inverse_length;
+    }
+
+    // Scatter
+    for (std::size_t l = 0; l < count; l++)
+    {
+        const BodyHandle b = bodies[l];
+        positions[b] = linkit::Vector3(px[l], py[l], pz[l]);
+        velocities[b] = linkit::Vector3(vx[l], vy[l], vz[l]);
+        orientations[b] = linkit::Quaternion(qw[l], qx[l], qy[l], qz[l]);
+        angular_velocities[b] = linkit::Vector3(wx[l], wy[l], wz[l]);
+        has_moved[b] = moved[l];
+    }
+}
+
+void PhysicsWorld::update_sleep_states(const linkit::real dt)
+{
+    if (!allow_sleeping) return;
+
+    // Recency-weighted average with a half-life of one second
+    const linkit::real bias = linkit::real_pow(static_cast<linkit::real>(0.5), dt);
+    for (const BodyHandle b : active_bodies)
+    {
+        const linkit::real current_motion = velocities[b] * velocities[b] + angular_velocities[b] * angular_velocities[b];
+        motion[b] = bias * motion[b] + (1 - bias) * current_motion;
+        motion[b] = std::min(motion[b], 10 * sleep_epsilon);
+
+        if (motion[b] < sleep_epsilon)
+        {
+            set_awake(b, false);
+        }
+    }
+}
+
+void PhysicsWorld::write_pose(const BodyHandle body, Transform& transform) const
+{
+    transform.position = positions[body];
+    transform.rotation = orientations[body];
+}
+
+void PhysicsWorld::read_body(const BodyHandle body, Rigidbody& rb) const
+{
+    write_pose(body, rb.transform);
+    rb.velocity = velocities[body];
+    rb.angular_velocity = angular_velocities[body];
+    rb.mass = masses[body];
+    rb.inverse_mass = inverse_masses[body];
+}
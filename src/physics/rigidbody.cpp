@@ -12,17 +12,12 @@ Rigidbody::Rigidbody()
 {
     transform = Transform();
 
-    velocity = linkit::Vector3(0.0, 0.0, 0.0);
+    velocity = linkit::Vector3(0, 0, 0);
     acceleration = linkit::Vector3(0.0f, 0.0f, 0.0f);
 
     angular_velocity = linkit::Vector3(0.0f, 0.0f, 0.0f);
     angular_acceleration = linkit::Vector3(0.0f, 0.0f, 0.0f);
 
-    accumulated_force = linkit::Vector3(0.0f, 0.0f, 0.0f);
-    accumulated_torque = linkit::Vector3(0.0f, 0.0f, 0.0f);
-
-    last_frame_acceleration = linkit::Vector3(0.0f, 0.0f, 0.0f);
-
     // Will be set by a child? constructor? bounding box?
     _local_inverse_inertia_tensor = linkit::Matrix3();
 
@@ -30,13 +25,6 @@ Rigidbody::Rigidbody()
     inverse_mass = (mass > 0.0f) ? (1.0f / mass) : 0.0f; // Handle infinite mass case
 
     linear_damping = 1.0f;
-    has_moved = false;
-}
-
-void Rigidbody::clear_accumulators()
-{
-    accumulated_force = linkit::Vector3(0.0f, 0.0f, 0.0f);
-    accumulated_torque = linkit::Vector3(0.0f, 0.0f, 0.0f);
 }
 
 linkit::Matrix4 Rigidbody::transform_matrix()
@@ -68,60 +56,6 @@ linkit::Matrix3 Rigidbody::get_inverse_inertia_tensor() const
     return transform.rotation.to_matrix3() * _local_inverse_inertia_tensor * transform.rotation.to_matrix3().transposed();
 }
 
-void Rigidbody::add_force(const linkit::Vector3& force)
-{
-    accumulated_force += force;
-}
-
-void Rigidbody::add_force_at_world_point(const linkit::Vector3& force, const linkit::Vector3& point)
-{
-    accumulated_force += force;
-    linkit::Vector3 lever_arm = point - transform.position;
-    accumulated_torque += lever_arm % force;
-}
-
-void Rigidbody::add_force_at_local_point(const linkit::Vector3& force, const linkit::Vector3& point)
-{
-    add_force_at_world_point(force, local_to_world(point));
-}
-
-void Rigidbody::compute_accelerations()
-{
-    acceleration = accumulated_force * inverse_mass;
-    angular_acceleration = get_inverse_inertia_tensor() * accumulated_torque;
-}
-
-
-void Rigidbody::step_rotation(const linkit::real dt)
-{
-
-    angular_velocity += angular_acceleration * dt;
-    transform.rotation.add_scaled_vector(angular_velocity, dt);
-    transform.rotation.normalize();
-}
-
-void Rigidbody::step_position(const linkit::real dt)
-{
-    velocity += acceleration * dt;
-    //velocity *= linkit::real_pow(linear_damping, dt);
-    if (velocity*velocity > linkit::REAL_EPSILON) has_moved = true;
-    else has_moved = false;
-    transform.position += velocity * dt + 0.5 * acceleration * dt * dt;
-}
-
-void Rigidbody::step(const linkit::real dt)
-{
-    if (has_infinite_mass()) return; // Object is immovable
-
-    compute_accelerations();
-
-    // Store the acceleration for resting contact velocity compensation
-    last_frame_acceleration = acceleration;
-
-    step_position(dt);
-    step_rotation(dt);
-}
-
 bool Rigidbody::has_finite_mass() const
 {
     return inverse_mass != 0;
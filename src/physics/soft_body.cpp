@@ -0,0 +1,432 @@
+#include "vectra/physics/soft_body.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "vectra/physics/colliders/collider_box.h"
+#include "vectra/physics/colliders/collider_sphere.h"
+#include "vectra/physics/parallel.h"
+
+namespace
+{
+    // Every colour is projected once per substep, so threads only pay off for very large bodies
+    constexpr std::size_t MIN_CONSTRAINTS_PER_THREAD = 8192;
+    constexpr std::size_t MIN_PARTICLES_PER_THREAD = 8192;
+    constexpr std::size_t PARALLEL_COLOURS = 64; // One bit each in a particle's mask
+
+    std::uint64_t edge_key(std::uint32_t a, std::uint32_t b)
+    {
+        if (a > b) std::swap(a, b);
+        return (static_cast<std::uint64_t>(a) << 32) | b;
+    }
+
+    // Greedy colouring: each constraint takes the first colour none of its particles is in yet.
+    // Reorders constraints so every colour is contiguous and returns the colour offsets
+    template <class Constraint, std::size_t N>
+    std::vector<std::size_t> colour(std::vector<Constraint>& constraints, const std::size_t particle_count)
+    {
+        std::vector<std::uint64_t> used(particle_count, 0);
+        std::vector<std::size_t> colour_of(constraints.size());
+        std::size_t colour_count = 0;
+
+        for (std::size_t i = 0; i < constraints.size(); i++)
+        {
+            std::uint64_t mask = 0;
+            for (std::size_t p = 0; p < N; p++) mask |= used[constraints[i].particles[p]];
+
+            std::size_t c = 0;
+            while (c < PARALLEL_COLOURS && (mask & (std::uint64_t(1) << c))) c++;
+            colour_of[i] = c;
+            if (c == PARALLEL_COLOURS) continue; // Left for the serial colour
+
+            for (std::size_t p = 0; p < N; p++) used[constraints[i].particles[p]] |= std::uint64_t(1) << c;
+            colour_count = std::max(colour_count, c + 1);
+        }
+
+        // colour_count parallel colours followed by the serial one
+        std::vector<std::size_t> offsets(colour_count + 2, 0);
+        for (std::size_t i = 0; i < constraints.size(); i++)
+        {
+            offsets[std::min(colour_of[i], colour_count) + 1]++;
+        }
+        for (std::size_t c = 1; c < offsets.size(); c++) offsets[c] += offsets[c - 1];
+
+        std::vector<Constraint> sorted(constraints.size());
+        std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < constraints.size(); i++)
+        {
+            sorted[next[std::min(colour_of[i], colour_count)]++] = constraints[i];
+        }
+        constraints = std::move(sorted);
+        return offsets;
+    }
+
+    // Runs project(i) over every constraint, colour after colour
+    template <class Function>
+    void for_each_by_colour(const std::vector<std::size_t>& colours, const Function& project)
+    {
+        if (colours.size() < 2) return;
+        const std::size_t serial = colours.size() - 2;
+        for (std::size_t c = 0; c < serial; c++)
+        {
+            const std::size_t first = colours[c];
+            parallel_for(colours[c + 1] - first, MIN_CONSTRAINTS_PER_THREAD, [&](const std::size_t i)
+            {
+                project(first + i);
+            });
+        }
+        for (std::size_t i = colours[serial]; i < colours[serial + 1]; i++) project(i);
+    }
+
+    linkit::real six_volume(const linkit::Vector3& a, const linkit::Vector3& b, const linkit::Vector3& c, const linkit::Vector3& d)
+    {
+        return ((b - a) % (c - a)) * (d - a);
+    }
+}
+
+SoftBody::SoftBody(const SoftBodyDescription& description) : description(description)
+{
+    if (description.shape == SoftBodyShape::BLOCK) build_block();
+    else build_cloth();
+
+    for (const std::uint32_t pinned : description.pinned)
+    {
+        if (pinned < inverse_masses.size()) inverse_masses[pinned] = 0;
+    }
+
+    previous_positions = positions;
+    velocities.assign(positions.size(), linkit::Vector3(0, 0, 0));
+    colour_constraints();
+}
+
+std::size_t SoftBody::particle_count() const
+{
+    return positions.size();
+}
+
+std::uint32_t SoftBody::add_particle(const linkit::Vector3& position, const linkit::real mass)
+{
+    positions.push_back(position);
+    inverse_masses.push_back(mass > 0 ? 1 / mass : 0);
+    return static_cast<std::uint32_t>(positions.size() - 1);
+}
+
+void SoftBody::build_cloth()
+{
+    const int columns = std::max(2, description.resolution[0]);
+    const int rows = std::max(2, description.resolution[1]);
+    const linkit::real spacing = description.spacing;
+    const linkit::Vector3 corner = description.origin - linkit::Vector3((columns - 1) * spacing, 0, (rows - 1) * spacing) * static_cast<linkit::real>(0.5);
+
+    for (int z = 0; z < rows; z++)
+    {
+        for (int x = 0; x < columns; x++)
+        {
+            add_particle(corner + linkit::Vector3(x * spacing, 0, z * spacing), description.particle_mass);
+        }
+    }
+
+    // Two triangles per cell facing +y, the diagonal alternating so the sheet has no preferred fold
+    std::vector<std::uint32_t> indices;
+    indices.reserve(6 * (columns - 1) * (rows - 1));
+    for (int z = 0; z < rows - 1; z++)
+    {
+        for (int x = 0; x < columns - 1; x++)
+        {
+            const std::uint32_t a = x + columns * z;
+            const std::uint32_t b = a + 1;
+            const std::uint32_t c = a + columns;
+            const std::uint32_t d = c + 1;
+            if ((x + z) % 2 == 0) indices.insert(indices.end(), {a, c, b, b, c, d});
+            else indices.insert(indices.end(), {a, d, b, a, c, d});
+        }
+    }
+
+    std::unordered_set<std::uint64_t> edges;
+    for (std::size_t t = 0; t < indices.size(); t += 3)
+    {
+        for (int e = 0; e < 3; e++)
+        {
+            const std::uint32_t a = indices[t + e];
+            const std::uint32_t b = indices[t + (e + 1) % 3];
+            if (!edges.insert(edge_key(a, b)).second) continue;
+            stretch_constraints.push_back({{a, b}, (positions[a] - positions[b]).magnitude()});
+        }
+    }
+
+    add_bending(indices);
+    triangles = std::make_shared<const std::vector<std::uint32_t>>(std::move(indices));
+}
+
+void SoftBody::build_block()
+{
+    const int nx = std::max(2, description.resolution[0]);
+    const int ny = std::max(2, description.resolution[1]);
+    const int nz = std::max(2, description.resolution[2]);
+    const linkit::real spacing = description.spacing;
+    const linkit::Vector3 corner = description.origin - linkit::Vector3((nx - 1) * spacing, (ny - 1) * spacing, (nz - 1) * spacing) * static_cast<linkit::real>(0.5);
+    const auto index = [&](const int x, const int y, const int z) { return static_cast<std::uint32_t>(x + nx * (y + ny * z)); };
+
+    for (int z = 0; z < nz; z++)
+    {
+        for (int y = 0; y < ny; y++)
+        {
+            for (int x = 0; x < nx; x++)
+            {
+                add_particle(corner + linkit::Vector3(x * spacing, y * spacing, z * spacing), description.particle_mass);
+            }
+        }
+    }
+
+    // Six tetrahedra per cell around the diagonal from corner 0 to corner 7, corner k at (k & 1, k & 2, k & 4)
+    constexpr int CELL_TETRAHEDRA[6][4] = {{0, 1, 3, 7}, {0, 3, 2, 7}, {0, 2, 6, 7}, {0, 6, 4, 7}, {0, 4, 5, 7}, {0, 5, 1, 7}};
+    std::unordered_set<std::uint64_t> edges;
+    for (int z = 0; z < nz - 1; z++)
+    {
+        for (int y = 0; y < ny - 1; y++)
+        {
+            for (int x = 0; x < nx - 1; x++)
+            {
+                std::uint32_t cell[8];
+                for (int k = 0; k < 8; k++) cell[k] = index(x + (k & 1), y + ((k >> 1) & 1), z + ((k >> 2) & 1));
+
+                for (const auto& tetrahedron : CELL_TETRAHEDRA)
+                {
+                    VolumeConstraint volume{{cell[tetrahedron[0]], cell[tetrahedron[1]], cell[tetrahedron[2]], cell[tetrahedron[3]]}, 0};
+                    volume.rest_volume = six_volume(positions[volume.particles[0]], positions[volume.particles[1]],
+                                                    positions[volume.particles[2]], positions[volume.particles[3]]);
+                    volume_constraints.push_back(volume);
+
+                    for (int i = 0; i < 4; i++)
+                    {
+                        for (int j = i + 1; j < 4; j++)
+                        {
+                            const std::uint32_t a = volume.particles[i];
+                            const std::uint32_t b = volume.particles[j];
+                            if (!edges.insert(edge_key(a, b)).second) continue;
+                            stretch_constraints.push_back({{a, b}, (positions[a] - positions[b]).magnitude()});
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Surface: both triangles of every boundary quad, wound to face out of the block
+    std::vector<std::uint32_t> indices;
+    const linkit::Vector3 centre = description.origin;
+    const auto add_quad = [&](const std::uint32_t a, const std::uint32_t b, const std::uint32_t c, const std::uint32_t d)
+    {
+        const linkit::Vector3 normal = (positions[b] - positions[a]) % (positions[c] - positions[a]);
+        const linkit::Vector3 outward = (positions[a] + positions[c]) * static_cast<linkit::real>(0.5) - centre;
+        if (normal * outward >= 0) indices.insert(indices.end(), {a, b, c, a, c, d});
+        else indices.insert(indices.end(), {a, c, b, a, d, c});
+    };
+    for (const int x : {0, nx - 1})
+    {
+        for (int z = 0; z < nz - 1; z++)
+        {
+            for (int y = 0; y < ny - 1; y++) add_quad(index(x, y, z), index(x, y + 1, z), index(x, y + 1, z + 1), index(x, y, z + 1));
+        }
+    }
+    for (const int y : {0, ny - 1})
+    {
+        for (int z = 0; z < nz - 1; z++)
+        {
+            for (int x = 0; x < nx - 1; x++) add_quad(index(x, y, z), index(x + 1, y, z), index(x + 1, y, z + 1), index(x, y, z + 1));
+        }
+    }
+    for (const int z : {0, nz - 1})
+    {
+        for (int y = 0; y < ny - 1; y++)
+        {
+            for (int x = 0; x < nx - 1; x++) add_quad(index(x, y, z), index(x + 1, y, z), index(x + 1, y + 1, z), index(x, y + 1, z));
+        }
+    }
+
+    add_bending(indices);
+    triangles = std::make_shared<const std::vector<std::uint32_t>>(std::move(indices));
+}
+
+void SoftBody::add_bending(const std::vector<std::uint32_t>& triangle_indices)
+{
+    // Corner opposite each edge, for the first triangle that has it
+    std::unordered_map<std::uint64_t, std::uint32_t> opposite;
+    for (std::size_t t = 0; t < triangle_indices.size(); t += 3)
+    {
+        for (int e = 0; e < 3; e++)
+        {
+            const std::uint64_t key = edge_key(triangle_indices[t + e], triangle_indices[t + (e + 1) % 3]);
+            const std::uint32_t far_corner = triangle_indices[t + (e + 2) % 3];
+
+            const auto [it, first_triangle] = opposite.emplace(key, far_corner);
+            if (first_triangle || it->second == far_corner) continue;
+            bending_constraints.push_back({{it->second, far_corner}, (positions[it->second] - positions[far_corner]).magnitude()});
+        }
+    }
+}
+
+void SoftBody::colour_constraints()
+{
+    stretch_colours_ = colour<DistanceConstraint, 2>(stretch_constraints, positions.size());
+    bending_colours_ = colour<DistanceConstraint, 2>(bending_constraints, positions.size());
+    volume_colours_ = colour<VolumeConstraint, 4>(volume_constraints, positions.size());
+}
+
+BoundingSphere SoftBody::swept_bounds(const linkit::real dt) const
+{
+    if (positions.empty()) return BoundingSphere(description.origin, 0);
+
+    linkit::Vector3 centre(0, 0, 0);
+    for (const auto& position : positions) centre += position;
+    centre = centre * (1 / static_cast<linkit::real>(positions.size()));
+
+    linkit::real radius_squared = 0;
+    linkit::real speed_squared = 0;
+    for (std::size_t i = 0; i < positions.size(); i++)
+    {
+        radius_squared = std::max(radius_squared, (positions[i] - centre).magnitude_squared());
+        speed_squared = std::max(speed_squared, velocities[i].magnitude_squared());
+    }
+
+    const linkit::real travel = (linkit::real_sqrt(speed_squared) + gravity.magnitude() * dt) * dt;
+    return BoundingSphere(centre, linkit::real_sqrt(radius_squared) + travel + particle_radius);
+}
+
+void SoftBody::solve_distances(std::vector<DistanceConstraint>& constraints, const std::vector<std::size_t>& colours,
+                               const linkit::real compliance, const linkit::real h)
+{
+    const linkit::real alpha = compliance / (h * h);
+    for_each_by_colour(colours, [&](const std::size_t c)
+    {
+        const DistanceConstraint& constraint = constraints[c];
+        const std::uint32_t a = constraint.particles[0];
+        const std::uint32_t b = constraint.particles[1];
+        const linkit::real weight = inverse_masses[a] + inverse_masses[b];
+        if (weight <= 0) return;
+
+        const linkit::Vector3 offset = positions[a] - positions[b];
+        const linkit::real length = offset.magnitude();
+        if (length < linkit::REAL_EPSILON) return;
+
+        const linkit::real lambda = -(length - constraint.rest_length) / (weight + alpha);
+        const linkit::Vector3 correction = offset * (lambda / length);
+        positions[a] += correction * inverse_masses[a];
+        positions[b] -= correction * inverse_masses[b];
+    });
+}
+
+void SoftBody::solve_volumes(const linkit::real h)
+{
+    const linkit::real alpha = volume_compliance / (h * h);
+    for_each_by_colour(volume_colours_, [&](const std::size_t c)
+    {
+        const VolumeConstraint& constraint = volume_constraints[c];
+        const std::uint32_t* p = constraint.particles;
+        const linkit::Vector3 e1 = positions[p[1]] - positions[p[0]];
+        const linkit::Vector3 e2 = positions[p[2]] - positions[p[0]];
+        const linkit::Vector3 e3 = positions[p[3]] - positions[p[0]];
+
+        // Gradients of six times the signed volume with respect to each corner
+        linkit::Vector3 gradients[4];
+        gradients[1] = e2 % e3;
+        gradients[2] = e3 % e1;
+        gradients[3] = e1 % e2;
+        gradients[0] = (gradients[1] + gradients[2] + gradients[3]) * -1;
+
+        linkit::real weight = 0;
+        for (int i = 0; i < 4; i++) weight += inverse_masses[p[i]] * gradients[i].magnitude_squared();
+        if (weight <= linkit::REAL_EPSILON) return;
+
+        const linkit::real lambda = -(e1 * gradients[1] - constraint.rest_volume) / (weight + alpha);
+        for (int i = 0; i < 4; i++) positions[p[i]] += gradients[i] * (lambda * inverse_masses[p[i]]);
+    });
+}
+
+void SoftBody::solve_collisions()
+{
+    if (colliders_.empty()) return;
+
+    parallel_for(positions.size(), MIN_PARTICLES_PER_THREAD, [&](const std::size_t i)
+    {
+        if (inverse_masses[i] == 0) return;
+        linkit::Vector3& position = positions[i];
+
+        for (const RigidCollider& collider : colliders_)
+        {
+            // Every collider is tested as a sphere first, which is exact for spheres
+            const linkit::Vector3 offset = position - collider.frame.center;
+            const linkit::real reach = collider.radius + particle_radius;
+            if (offset.magnitude_squared() >= reach * reach) continue;
+
+            linkit::Vector3 normal; // Out of the rigid body
+            if (collider.is_sphere)
+            {
+                const linkit::real distance = offset.magnitude();
+                normal = distance > linkit::REAL_EPSILON ? offset * (1 / distance) : linkit::Vector3(0, 1, 0);
+                position += normal * (reach - distance);
+            }
+            else
+            {
+                const CollisionHandler::ShapeDistance hit = CollisionHandler::sphere_box_distance(position, particle_radius, collider.frame, collider.half_sizes);
+                if (hit.distance >= 0) continue;
+
+                normal = hit.normal * -1;
+                position += normal * -hit.distance;
+            }
+
+            // Friction removes part of this substep's sliding along the surface
+            const linkit::Vector3 slide = position - previous_positions[i];
+            position -= (slide - normal * (slide * normal)) * friction;
+        }
+    });
+}
+
+void SoftBody::step(const linkit::real dt, const std::vector<GameObject*>& colliders)
+{
+    if (positions.empty() || dt <= 0) return;
+
+    colliders_.clear();
+    for (const GameObject* obj : colliders)
+    {
+        if (!obj->collider) continue;
+        const ColliderPrimitive& collider = obj->get_collider();
+        if (collider.tag == "ColliderSphere")
+        {
+            CollisionHandler::BoxAxes frame;
+            frame.center = collider.get_transform().position;
+            colliders_.push_back({true, dynamic_cast<const ColliderSphere&>(collider).radius, frame, linkit::Vector3(0, 0, 0)});
+        }
+        else if (collider.tag == "ColliderBox")
+        {
+            const linkit::Vector3& half_sizes = dynamic_cast<const ColliderBox&>(collider).half_sizes;
+            colliders_.push_back({false, half_sizes.magnitude(), CollisionHandler::get_box_axes(collider.get_transform()), half_sizes});
+        }
+    }
+
+    const int substep_count = std::max(1, substeps);
+    const linkit::real h = dt / substep_count;
+    const linkit::real velocity_scale = std::max(static_cast<linkit::real>(0), 1 - damping * h);
+
+    for (int s = 0; s < substep_count; s++)
+    {
+        for (std::size_t i = 0; i < positions.size(); i++)
+        {
+            previous_positions[i] = positions[i];
+            if (inverse_masses[i] == 0) continue;
+            velocities[i] += gravity * h;
+            positions[i] += velocities[i] * h;
+        }
+
+        solve_distances(stretch_constraints, stretch_colours_, stretch_compliance, h);
+        solve_distances(bending_constraints, bending_colours_, bending_compliance, h);
+        solve_volumes(h);
+        solve_collisions();
+
+        for (std::size_t i = 0; i < positions.size(); i++)
+        {
+            velocities[i] = (positions[i] - previous_positions[i]) * (velocity_scale / h);
+        }
+    }
+}
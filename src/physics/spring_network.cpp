@@ -0,0 +1,241 @@
+#include "vectra/physics/spring_network.h"
+
+#include <algorithm>
+
+#include "vectra/physics/parallel.h"
+
+namespace
+{
+    // The integrator moves a body by dt * (v + 1.5 * dv) in a step, so the stiffness term is weighted to match
+    constexpr linkit::real POSITION_WEIGHT = static_cast<linkit::real>(1.5);
+    // Each conjugate gradient iteration does one product, so threads have to be repaid many times per step
+    constexpr std::size_t MIN_SPRINGS_PER_THREAD = 8192;
+
+    linkit::real dot(const std::vector<linkit::Vector3>& a, const std::vector<linkit::Vector3>& b)
+    {
+        linkit::real sum = 0;
+        for (std::size_t i = 0; i < a.size(); i++) sum += a[i] * b[i];
+        return sum;
+    }
+
+    linkit::Vector3 component_product(const linkit::Vector3& a, const linkit::Vector3& b)
+    {
+        return linkit::Vector3(a.x * b.x, a.y * b.y, a.z * b.z);
+    }
+
+    // axial * n n^T u + lateral * (I - n n^T) u
+    linkit::Vector3 apply_block(const linkit::Vector3& n, const linkit::real axial, const linkit::real lateral, const linkit::Vector3& u)
+    {
+        const linkit::Vector3 along = n * (n * u);
+        return along * axial + (u - along) * lateral;
+    }
+}
+
+void SpringNetwork::add(GameObject* first, GameObject* second, const linkit::real spring_constant,
+                        const linkit::real rest_length, const linkit::real damping)
+{
+    springs.push_back({first, second, spring_constant, rest_length, damping});
+    dirty_ = true;
+}
+
+void SpringNetwork::clear()
+{
+    springs.clear();
+    dirty_ = true;
+}
+
+bool SpringNetwork::empty() const
+{
+    return springs.empty();
+}
+
+int SpringNetwork::last_iterations() const
+{
+    return last_iterations_;
+}
+
+void SpringNetwork::rebuild(const PhysicsWorld& world)
+{
+    bodies_.clear();
+    unknown_index_.assign(world.size(), -1);
+
+    const auto unknown = [&](const GameObject* obj) -> std::int32_t
+    {
+        const BodyHandle body = obj->body;
+        if (body == INVALID_BODY_HANDLE || !world.has_finite_mass(body)) return -1;
+        if (unknown_index_[body] < 0)
+        {
+            unknown_index_[body] = static_cast<std::int32_t>(bodies_.size());
+            bodies_.push_back(body);
+        }
+        return unknown_index_[body];
+    };
+
+    blocks_.clear();
+    blocks_.reserve(springs.size());
+    for (const auto& spring : springs)
+    {
+        blocks_.push_back({unknown(spring.first), unknown(spring.second), linkit::Vector3(0, 0, 0), 0, 0});
+    }
+
+    delta_v_.assign(bodies_.size(), linkit::Vector3(0, 0, 0));
+    dirty_ = false;
+}
+
+void SpringNetwork::multiply(const PhysicsWorld& world, const std::vector<linkit::Vector3>& p, std::vector<linkit::Vector3>& out)
+{
+    const std::size_t n = bodies_.size();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        out[i] = p[i] * world.masses[bodies_[i]];
+    }
+
+    // Springs are split between threads. Thread 0 adds into out, the others into their own buffer
+    const std::size_t thread_count = worker_count(blocks_.size(), MIN_SPRINGS_PER_THREAD);
+    thread_products_.resize(thread_count);
+    run_on_threads(thread_count, [&](const std::size_t t)
+    {
+        linkit::Vector3* products = out.data();
+        if (t > 0)
+        {
+            thread_products_[t].assign(n, linkit::Vector3(0, 0, 0));
+            products = thread_products_[t].data();
+        }
+
+        const std::size_t first = blocks_.size() * t / thread_count;
+        const std::size_t last = blocks_.size() * (t + 1) / thread_count;
+        for (std::size_t s = first; s < last; s++)
+        {
+            const SpringBlock& block = blocks_[s];
+            linkit::Vector3 u(0, 0, 0);
+            if (block.first >= 0) u += p[block.first];
+            if (block.second >= 0) u -= p[block.second];
+
+            const linkit::Vector3 product = apply_block(block.direction, block.axial, block.lateral, u);
+            if (block.first >= 0) products[block.first] += product;
+            if (block.second >= 0) products[block.second] -= product;
+        }
+    });
+
+    // Reduce in thread order so the result doesn't depend on scheduling
+    for (std::size_t t = 1; t < thread_count; t++)
+    {
+        for (std::size_t i = 0; i < n; i++) out[i] += thread_products_[t][i];
+    }
+}
+
+void SpringNetwork::solve(PhysicsWorld& world, const linkit::real dt)
+{
+    last_iterations_ = 0;
+    if (springs.empty() || dt <= 0) return;
+    if (dirty_ || unknown_index_.size() != world.size()) rebuild(world);
+
+    const std::size_t n = bodies_.size();
+    if (n == 0) return;
+
+    rhs_.resize(n);
+    residual_.resize(n);
+    search_.resize(n);
+    product_.resize(n);
+    preconditioned_.resize(n);
+    inverse_diagonal_.resize(n);
+
+    // Right hand side dt * f starts from the forces already accumulated this step
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const BodyHandle body = bodies_[i];
+        rhs_[i] = world.accumulated_forces[body] * dt;
+        inverse_diagonal_[i] = linkit::Vector3(1, 1, 1) * world.masses[body];
+    }
+
+    // Linearise every spring about the current state
+    for (std::size_t s = 0; s < springs.size(); s++)
+    {
+        const NetworkSpring& spring = springs[s];
+        SpringBlock& block = blocks_[s];
+        block.axial = 0;
+        block.lateral = 0;
+        if (block.first < 0 && block.second < 0) continue;
+
+        const BodyHandle a = spring.first->body;
+        const BodyHandle b = spring.second->body;
+        const linkit::Vector3 offset = world.positions[a] - world.positions[b];
+        const linkit::real length = offset.magnitude();
+        if (length < linkit::REAL_EPSILON) continue; // No direction to push along
+
+        const linkit::Vector3 direction = offset * (1 / length);
+        const linkit::Vector3 relative_velocity = world.velocities[a] - world.velocities[b];
+        const linkit::Vector3 force = direction * (-spring.spring_constant * (length - spring.rest_length)
+                                                   - spring.damping * (relative_velocity * direction));
+
+        // df/dx is -k (n n^T + (1 - L / l) (I - n n^T)). The lateral part is dropped while the spring is
+        // compressed, which keeps the matrix positive definite for conjugate gradients
+        const linkit::real stretch = std::max(static_cast<linkit::real>(0), 1 - spring.rest_length / length);
+        const linkit::real stiffness = dt * dt * spring.spring_constant;
+        const linkit::Vector3 stiffness_term = apply_block(direction, stiffness, stiffness * stretch, relative_velocity);
+
+        block.direction = direction;
+        block.axial = dt * spring.damping + POSITION_WEIGHT * stiffness;
+        block.lateral = POSITION_WEIGHT * stiffness * stretch;
+
+        const linkit::Vector3 diagonal(block.lateral + (block.axial - block.lateral) * direction.x * direction.x,
+                                       block.lateral + (block.axial - block.lateral) * direction.y * direction.y,
+                                       block.lateral + (block.axial - block.lateral) * direction.z * direction.z);
+        if (block.first >= 0)
+        {
+            rhs_[block.first] += force * dt - stiffness_term;
+            inverse_diagonal_[block.first] += diagonal;
+        }
+        if (block.second >= 0)
+        {
+            rhs_[block.second] -= force * dt - stiffness_term;
+            inverse_diagonal_[block.second] += diagonal;
+        }
+    }
+    for (auto& diagonal : inverse_diagonal_)
+    {
+        diagonal = linkit::Vector3(1 / diagonal.x, 1 / diagonal.y, 1 / diagonal.z);
+    }
+
+    // Preconditioned conjugate gradients, starting from last step's velocity change
+    const linkit::real target = tolerance * tolerance * dot(rhs_, rhs_);
+    multiply(world, delta_v_, product_);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        residual_[i] = rhs_[i] - product_[i];
+        preconditioned_[i] = component_product(inverse_diagonal_[i], residual_[i]);
+        search_[i] = preconditioned_[i];
+    }
+    linkit::real residual_dot = dot(residual_, preconditioned_);
+
+    while (last_iterations_ < max_iterations && dot(residual_, residual_) > target)
+    {
+        multiply(world, search_, product_);
+        const linkit::real curvature = dot(search_, product_);
+        if (curvature <= 0) break;
+
+        const linkit::real alpha = residual_dot / curvature;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            delta_v_[i] += search_[i] * alpha;
+            residual_[i] -= product_[i] * alpha;
+            preconditioned_[i] = component_product(inverse_diagonal_[i], residual_[i]);
+        }
+
+        const linkit::real next_residual_dot = dot(residual_, preconditioned_);
+        const linkit::real beta = next_residual_dot / residual_dot;
+        residual_dot = next_residual_dot;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            search_[i] = preconditioned_[i] + search_[i] * beta;
+        }
+        last_iterations_++;
+    }
+
+    // The integrator turns this force back into exactly dv
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const BodyHandle body = bodies_[i];
+        world.accumulated_forces[body] = delta_v_[i] * (world.masses[body] / dt);
+    }
+}
@@ -0,0 +1,112 @@
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "vectra/rendering/deformable_mesh.h"
+#include "vectra/rendering/utils.h"
+
+
+DeformableMesh::DeformableMesh()
+{
+    texture_.id = texture_from_file("pale_green.png", "resources/textures/colours");
+    texture_.type = "texture_diffuse";
+    texture_.path = "pale_green.png";
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    // Same layout as Mesh, so the model shader draws it unchanged
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, m_BoneIDs));
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
+    glBindVertexArray(0);
+}
+
+DeformableMesh::~DeformableMesh()
+{
+    glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteTextures(1, &texture_.id);
+}
+
+void DeformableMesh::update(const std::vector<linkit::Vector3>& positions, const std::shared_ptr<const std::vector<std::uint32_t>>& triangles)
+{
+    if (!triangles) return;
+
+    vertices_.resize(positions.size(), Vertex{});
+    for (std::size_t i = 0; i < positions.size(); i++)
+    {
+        vertices_[i].Position = vector3_to_vec3(positions[i]);
+        vertices_[i].Normal = glm::vec3(0.0f);
+    }
+
+    // Area weighted vertex normals
+    const std::vector<std::uint32_t>& indices = *triangles;
+    for (std::size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        Vertex& a = vertices_[indices[t]];
+        Vertex& b = vertices_[indices[t + 1]];
+        Vertex& c = vertices_[indices[t + 2]];
+        const glm::vec3 normal = glm::cross(b.Position - a.Position, c.Position - a.Position);
+        a.Normal += normal;
+        b.Normal += normal;
+        c.Normal += normal;
+    }
+    for (auto& vertex : vertices_)
+    {
+        const float length = glm::length(vertex.Normal);
+        if (length > 0.0f) vertex.Normal /= length;
+    }
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (vertices_.size() > vertex_capacity_)
+    {
+        vertex_capacity_ = vertices_.size();
+        glBufferData(GL_ARRAY_BUFFER, vertex_capacity_ * sizeof(Vertex), vertices_.data(), GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_.size() * sizeof(Vertex), vertices_.data());
+    }
+
+    // Triangles never change for a soft body, so they are only uploaded when a different body is shown
+    if (triangles != triangles_)
+    {
+        triangles_ = triangles;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint32_t), indices.data(), GL_STATIC_DRAW);
+    }
+    glBindVertexArray(0);
+}
+
+void DeformableMesh::draw(Shader &shader)
+{
+    if (!triangles_) return;
+
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(glGetUniformLocation(shader.ID, "texture_diffuse1"), 0);
+    glBindTexture(GL_TEXTURE_2D, texture_.id);
+
+    // Cloth is seen from both sides
+    glDisable(GL_CULL_FACE);
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(triangles_->size()), GL_UNSIGNED_INT, nullptr);
+    glBindVertexArray(0);
+    glEnable(GL_CULL_FACE);
+}
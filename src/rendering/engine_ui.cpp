@@ -1,4 +1,9 @@
+#include <algorithm>
 #include <filesystem>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -199,6 +204,9 @@ void EngineUI::setup_initial_dock_layout(ImGuiID dockspace_id)
     // Split top from the center for Toolbar
     ImGuiID dock_top_id = ImGui::DockBuilderSplitNode(dock_main_id, ImGuiDir_Up, 0.06f, nullptr, &dock_main_id);
 
+    // Split the bottom of the center for the Profiler timeline
+    ImGuiID dock_bottom_id = ImGui::DockBuilderSplitNode(dock_main_id, ImGuiDir_Down, 0.25f, nullptr, &dock_main_id);
+
     // Dock windows
     ImGui::DockBuilderDockWindow("Hierarchy", dock_inspector);
     ImGui::DockBuilderDockWindow("Inspector", dock_left_id);
@@ -206,6 +214,7 @@ void EngineUI::setup_initial_dock_layout(ImGuiID dockspace_id)
     ImGui::DockBuilderDockWindow("Debug", dock_left_id); // NEW: Debug panel docked in left area
     ImGui::DockBuilderDockWindow("Scene Selection", dock_left_id);
     ImGui::DockBuilderDockWindow("Toolbar", dock_top_id);
+    ImGui::DockBuilderDockWindow("Profiler", dock_bottom_id);
 
     ImGui::DockBuilderFinish(dockspace_id);
 }
@@ -248,6 +257,30 @@ void EngineUI::draw_debug_panel(EngineState& state)
         {
             state.simulation_frequency = static_cast<linkit::real>(sim_freq);
         }
+        ImGui::Checkbox("Interpolate Rendering", &state.interpolate_rendering);
+
+        ImGui::Checkbox("Adaptive Time Step", &state.adaptive_time_step);
+        if (state.adaptive_time_step)
+        {
+            float min_freq = static_cast<float>(state.min_simulation_frequency);
+            float max_freq = static_cast<float>(state.max_simulation_frequency);
+            if (ImGui::SliderFloat("Min Frequency", &min_freq, 10.0f, 240.0f, "%.0f"))
+            {
+                state.min_simulation_frequency = static_cast<linkit::real>(min_freq);
+            }
+            if (ImGui::SliderFloat("Max Frequency", &max_freq, 60.0f, 2000.0f, "%.0f"))
+            {
+                state.max_simulation_frequency = static_cast<linkit::real>(max_freq);
+            }
+        }
+        if (state.current_dt > 0.0)
+        {
+            ImGui::Text("Physics dt: %.3f ms (%.0f Hz)", state.current_dt * 1000.0, 1.0 / state.current_dt);
+            ImGui::Text("Tick jitter: %.3f ms mean, %.3f ms max", state.tick_jitter * 1000.0, state.max_tick_jitter * 1000.0);
+        }
+
+        ImGui::SliderInt("Physics Substeps (applied on restart)", &state.physics_substeps, 1, 16);
+        ImGui::Checkbox("Continuous Collision (applied on restart)", &state.continuous_collision);
 
         ImGui::Spacing();
 
@@ -276,7 +309,167 @@ void EngineUI::draw_debug_panel(EngineState& state)
 
         // Misc
         ImGui::Text("Max collision contacts: %d", state.max_collision_contacts);
+        ImGui::Checkbox("Allow Sleeping (applied on restart)", &state.allow_sleeping);
+
+    }
+    ImGui::End();
+}
+
+void EngineUI::draw_profiler()
+{
+    if (ImGui::Begin("Profiler"))
+    {
+#if VECTRA_PROFILING
+        Profiler& profiler = Profiler::instance();
+
+        bool recording = profiler.enabled();
+        if (ImGui::Checkbox("Record", &recording)) profiler.set_enabled(recording);
+        ImGui::SameLine();
+        ImGui::Checkbox("Freeze", &profiler_frozen_);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(160.0f);
+        ImGui::SliderFloat("Window (ms)", &profiler_window_ms_, 5.0f, 500.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+        ImGui::SameLine();
+        if (ImGui::Button("Export Chrome Trace"))
+        {
+            const std::string trace_file = "vectra_trace.json";
+            profiler_status_message_ = profiler.write_chrome_trace(trace_file)
+                ? "Saved " + std::filesystem::absolute(trace_file).string()
+                : "Could not write " + trace_file;
+        }
+        if (!profiler_status_message_.empty())
+        {
+            ImGui::SameLine();
+            ImGui::TextColored(color_comment, "%s", profiler_status_message_.c_str());
+        }
+
+        const auto window_ns = static_cast<std::int64_t>(profiler_window_ms_ * 1e6f);
+        if (!profiler_frozen_)
+        {
+            profiler_view_end_ns_ = profiler.now_ns();
+            profiler_zones_.clear();
+            profiler.collect(profiler_zones_, profiler_view_end_ns_ - window_ns);
+            std::sort(profiler_zones_.begin(), profiler_zones_.end(), [](const ProfileZone& a, const ProfileZone& b)
+            {
+                return a.thread != b.thread ? a.thread < b.thread : a.start_ns < b.start_ns;
+            });
+        }
+        const std::int64_t view_start_ns = profiler_view_end_ns_ - window_ns;
+        const std::vector<std::string> thread_names = profiler.thread_names();
+
+        // One lane per thread with zones in view, one row per nesting depth
+        constexpr std::uint32_t max_rows = 8;
+        std::vector<std::uint32_t> lane_rows(thread_names.size(), 0);
+        for (const ProfileZone& zone : profiler_zones_)
+        {
+            lane_rows[zone.thread] = std::max(lane_rows[zone.thread], std::min(zone.depth + 1, max_rows));
+        }
+
+        const float row_height = ImGui::GetTextLineHeight() + 4.0f;
+        const float label_width = 90.0f;
+        float timeline_height = 0.0f;
+        for (const std::uint32_t rows : lane_rows) timeline_height += rows > 0 ? rows * row_height + 4.0f : 0.0f;
+
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float timeline_width = std::max(ImGui::GetContentRegionAvail().x - label_width, 1.0f);
+        ImGui::InvisibleButton("##ProfilerCanvas", ImVec2(label_width + timeline_width, std::max(timeline_height, row_height)));
+        const bool hovered = ImGui::IsItemHovered();
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+        const ImVec4 palette[] = {color_purple, color_green, color_pink, color_cyan, color_orange, color_yellow, color_red};
+        const ImU32 text_color = ImGui::ColorConvertFloat4ToU32(color_background);
+
+        // Where each thread's lane starts
+        std::vector<float> lane_top(thread_names.size(), 0.0f);
+        float y = origin.y;
+        for (std::size_t t = 0; t < thread_names.size(); t++)
+        {
+            if (lane_rows[t] == 0) continue;
+            lane_top[t] = y;
+            draw_list->AddText(ImVec2(origin.x, y + 2.0f), ImGui::ColorConvertFloat4ToU32(color_comment), thread_names[t].c_str());
+            y += lane_rows[t] * row_height + 4.0f;
+        }
+
+        const ProfileZone* hovered_zone = nullptr;
+        for (const ProfileZone& zone : profiler_zones_)
+        {
+            if (zone.depth >= max_rows) continue;
+            const float x0 = origin.x + label_width + std::max(0.0f, static_cast<float>(zone.start_ns - view_start_ns) / window_ns) * timeline_width;
+            const float x1 = origin.x + label_width + std::min(1.0f, static_cast<float>(zone.end_ns - view_start_ns) / window_ns) * timeline_width;
+            const float y0 = lane_top[zone.thread] + zone.depth * row_height;
+            const ImVec2 top_left(x0, y0);
+            const ImVec2 bottom_right(std::max(x1, x0 + 1.0f), y0 + row_height - 1.0f);
+
+            const std::size_t color_index = std::hash<std::string_view>{}(zone.name) % std::size(palette);
+            draw_list->AddRectFilled(top_left, bottom_right, ImGui::ColorConvertFloat4ToU32(palette[color_index]));
+            if (ImGui::CalcTextSize(zone.name).x + 4.0f < bottom_right.x - top_left.x)
+            {
+                draw_list->PushClipRect(top_left, bottom_right, true);
+                draw_list->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), text_color, zone.name);
+                draw_list->PopClipRect();
+            }
+            if (hovered && mouse.x >= top_left.x && mouse.x < bottom_right.x && mouse.y >= top_left.y && mouse.y < bottom_right.y)
+            {
+                hovered_zone = &zone;
+            }
+        }
 
+        if (hovered_zone)
+        {
+            ImGui::BeginTooltip();
+            ImGui::TextColored(color_cyan, "%s", hovered_zone->name);
+            ImGui::Text("%.3f ms on %s", static_cast<double>(hovered_zone->end_ns - hovered_zone->start_ns) / 1e6,
+                        thread_names[hovered_zone->thread].c_str());
+            ImGui::EndTooltip();
+        }
+
+        // Time spent in each zone over the window, most expensive first
+        struct ZoneTotals
+        {
+            int calls = 0;
+            double total_ms = 0.0;
+            double max_ms = 0.0;
+        };
+        std::unordered_map<std::string_view, ZoneTotals> totals;
+        for (const ProfileZone& zone : profiler_zones_)
+        {
+            ZoneTotals& entry = totals[zone.name];
+            const double ms = static_cast<double>(zone.end_ns - zone.start_ns) / 1e6;
+            entry.calls++;
+            entry.total_ms += ms;
+            entry.max_ms = std::max(entry.max_ms, ms);
+        }
+        std::vector<std::pair<std::string_view, ZoneTotals>> sorted_totals(totals.begin(), totals.end());
+        std::sort(sorted_totals.begin(), sorted_totals.end(), [](const auto& a, const auto& b)
+        {
+            return a.second.total_ms > b.second.total_ms;
+        });
+
+        if (ImGui::BeginTable("##ProfilerTotals", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+        {
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("Calls");
+            ImGui::TableSetupColumn("Total (ms)");
+            ImGui::TableSetupColumn("Max (ms)");
+            ImGui::TableHeadersRow();
+            for (const auto& [name, entry] : sorted_totals)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(name.data(), name.data() + name.size());
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", entry.calls);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", entry.total_ms);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", entry.max_ms);
+            }
+            ImGui::EndTable();
+        }
+#else
+        ImGui::TextColored(color_comment, "Profiling zones were compiled out (VECTRA_ENABLE_PROFILER=OFF)");
+#endif
     }
     ImGui::End();
 }
@@ -374,15 +567,17 @@ void EngineUI::draw_hierarchy(const SceneSnapshot& scene_snapshot)
         ImGui::TextColored(color_cyan, "Scene Objects");
         ImGui::Separator();
 
-        for (int i = 0; i < static_cast<int>(scene_snapshot.object_snapshots.size()); ++i)
+        const SnapshotObjectTable* table = scene_snapshot.object_table.get();
+        for (int i = 0; i < static_cast<int>(scene_snapshot.object_count()); ++i)
         {
-            const auto& obj = scene_snapshot.object_snapshots[i];
+            const std::string& name = table->names[i];
+            const std::string& model_name = table->model_names[table->model_ids[i]];
 
             bool is_selected = (selected_object_index_ == i);
 
             // Use object name, fall back to model_name_index if empty
-            std::string display_name = obj.name.empty() ?
-                (obj.model_name + "_" + std::to_string(i)) : obj.name;
+            std::string display_name = name.empty() ?
+                (model_name + "_" + std::to_string(i)) : name;
 
             if (ImGui::Selectable(display_name.c_str(), is_selected))
             {
@@ -399,18 +594,22 @@ void EngineUI::draw_hierarchy(const SceneSnapshot& scene_snapshot)
     ImGui::End();
 }
 
-void EngineUI::draw_inspector(const SceneSnapshot& scene_snapshot)
+void EngineUI::draw_inspector(ForceRequestQueue& force_requests, const SceneSnapshot& scene_snapshot)
 {
     if (ImGui::Begin("Inspector"))
     {
         if (selected_object_index_ >= 0 &&
-            selected_object_index_ < static_cast<int>(scene_snapshot.object_snapshots.size()))
+            selected_object_index_ < static_cast<int>(scene_snapshot.object_count()))
         {
-            const auto& obj = scene_snapshot.object_snapshots[selected_object_index_];
+            const int id = selected_object_index_;
+            const SnapshotObjectTable& table = *scene_snapshot.object_table;
+            const std::string& name = table.names[id];
+            const std::string& model_name = table.model_names[table.model_ids[id]];
+            const Transform& transform = scene_snapshot.transforms[id];
 
             // Object name header
-            std::string display_name = obj.name.empty() ?
-                (obj.model_name + "_" + std::to_string(selected_object_index_)) : obj.name;
+            std::string display_name = name.empty() ?
+                (model_name + "_" + std::to_string(id)) : name;
 
             ImGui::TextColored(color_purple, "%s", display_name.c_str());
             ImGui::Separator();
@@ -423,9 +622,9 @@ void EngineUI::draw_inspector(const SceneSnapshot& scene_snapshot)
                 // Position (read-only)
                 ImGui::TextColored(color_cyan, "Position");
                 float pos[3] = {
-                    static_cast<float>(obj.transform.position.x),
-                    static_cast<float>(obj.transform.position.y),
-                    static_cast<float>(obj.transform.position.z)
+                    static_cast<float>(transform.position.x),
+                    static_cast<float>(transform.position.y),
+                    static_cast<float>(transform.position.z)
                 };
                 ImGui::BeginDisabled();
                 ImGui::InputFloat3("##pos", pos, "%.3f");
@@ -436,10 +635,10 @@ void EngineUI::draw_inspector(const SceneSnapshot& scene_snapshot)
                 // Rotation (read-only) - display as quaternion
                 ImGui::TextColored(color_cyan, "Rotation (Quaternion)");
                 float rot[4] = {
-                    static_cast<float>(obj.transform.rotation.x),
-                    static_cast<float>(obj.transform.rotation.y),
-                    static_cast<float>(obj.transform.rotation.z),
-                    static_cast<float>(obj.transform.rotation.w)
+                    static_cast<float>(transform.rotation.x),
+                    static_cast<float>(transform.rotation.y),
+                    static_cast<float>(transform.rotation.z),
+                    static_cast<float>(transform.rotation.w)
                 };
                 ImGui::BeginDisabled();
                 ImGui::InputFloat4("##rot", rot, "%.3f");
@@ -450,9 +649,9 @@ void EngineUI::draw_inspector(const SceneSnapshot& scene_snapshot)
                 // Scale (read-only)
                 ImGui::TextColored(color_cyan, "Scale");
                 float scale[3] = {
-                    static_cast<float>(obj.transform.scale.x),
-                    static_cast<float>(obj.transform.scale.y),
-                    static_cast<float>(obj.transform.scale.z)
+                    static_cast<float>(transform.scale.x),
+                    static_cast<float>(transform.scale.y),
+                    static_cast<float>(transform.scale.z)
                 };
                 ImGui::BeginDisabled();
                 ImGui::InputFloat3("##scale", scale, "%.3f");
@@ -466,22 +665,22 @@ void EngineUI::draw_inspector(const SceneSnapshot& scene_snapshot)
             {
                 ImGui::TextColored(color_cyan, "Resultant Force");
                 float force[3] = {
-                    static_cast<float>(obj.force.x),
-                    static_cast<float>(obj.force.y),
-                    static_cast<float>(obj.force.z)
+                    static_cast<float>(scene_snapshot.forces[id].x),
+                    static_cast<float>(scene_snapshot.forces[id].y),
+                    static_cast<float>(scene_snapshot.forces[id].z)
                 };
                 ImGui::BeginDisabled();
                 ImGui::InputFloat3("##force", force, "%.3f");
                 ImGui::EndDisabled();
 
                 ImGui::Spacing();
-                if (obj.has_spring)
+                if (scene_snapshot.has_spring[id])
                 {
                     ImGui::TextColored(color_cyan, "Spring Anchor Point");
                     float anchor[3] = {
-                        static_cast<float>(obj.spring_anchor.x),
-                        static_cast<float>(obj.spring_anchor.y),
-                        static_cast<float>(obj.spring_anchor.z)
+                        static_cast<float>(scene_snapshot.spring_anchors[id].x),
+                        static_cast<float>(scene_snapshot.spring_anchors[id].y),
+                        static_cast<float>(scene_snapshot.spring_anchors[id].z)
                     };
                     ImGui::BeginDisabled();
                     ImGui::InputFloat3("##anchor", anchor, "%.3f");
@@ -490,13 +689,21 @@ void EngineUI::draw_inspector(const SceneSnapshot& scene_snapshot)
                     ImGui::Spacing();
                 }
 
+                // Pushes the object for one physics step, recorded when the engine records a replay
+                ImGui::TextColored(color_cyan, "Apply Force");
+                ImGui::DragFloat3("##apply_force", inspector_force_, 10.0f, 0.0f, 0.0f, "%.1f");
+                if (ImGui::Button("Apply", ImVec2(-1, 0)))
+                {
+                    force_requests.push(static_cast<std::size_t>(id),
+                                        linkit::Vector3(inspector_force_[0], inspector_force_[1], inspector_force_[2]));
+                }
             }
             ImGui::Spacing();
             // Model info section
             if (ImGui::CollapsingHeader("Model", ImGuiTreeNodeFlags_DefaultOpen))
             {
                 ImGui::Indent(10.0f);
-                ImGui::Text("Model: %s", obj.model_name.c_str());
+                ImGui::Text("Model: %s", model_name.c_str());
                 ImGui::Unindent(10.0f);
             }
         }
@@ -644,8 +851,9 @@ void EngineUI::draw_scene_selection(EngineState& state)
     ImGui::PopStyleVar();
 }
 
-void EngineUI::draw(EngineState& state, SceneSnapshot& scene_snapshot, GLuint scene_texture_id)
+void EngineUI::draw(EngineState& state, ForceRequestQueue& force_requests, SceneSnapshot& scene_snapshot, GLuint scene_texture_id)
 {
+    VECTRA_PROFILE_SCOPE("EngineUI::draw");
     // Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -687,8 +895,9 @@ void EngineUI::draw(EngineState& state, SceneSnapshot& scene_snapshot, GLuint sc
     // Draw all panels
     draw_toolbar(state);
     draw_hierarchy(scene_snapshot);
-    draw_inspector(scene_snapshot);
+    draw_inspector(force_requests, scene_snapshot);
     draw_debug_panel(state); // NEW: render Debug panel
+    draw_profiler();
     draw_scene_view(state, scene_texture_id);
     draw_scene_selection(state);
 
@@ -774,6 +983,7 @@ void EngineUI::draw_restart_overlay()
 
 void EngineUI::end_frame()
 {
+    VECTRA_PROFILE_SCOPE("EngineUI::end_frame");
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
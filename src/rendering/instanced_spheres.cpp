@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "vectra/rendering/instanced_spheres.h"
+
+namespace
+{
+    // Particles are tiny on screen, so one subdivision of an icosahedron (80 triangles) is round enough
+    constexpr int SUBDIVISIONS = 1;
+
+    // Unit icosphere, whose positions are also its normals
+    void build_icosphere(std::vector<Vertex>& vertices, std::vector<std::uint32_t>& indices)
+    {
+        const float t = (1.0f + glm::sqrt(5.0f)) / 2.0f;
+        const std::array<glm::vec3, 12> corners = {
+            glm::vec3(-1, t, 0), glm::vec3(1, t, 0), glm::vec3(-1, -t, 0), glm::vec3(1, -t, 0),
+            glm::vec3(0, -1, t), glm::vec3(0, 1, t), glm::vec3(0, -1, -t), glm::vec3(0, 1, -t),
+            glm::vec3(t, 0, -1), glm::vec3(t, 0, 1), glm::vec3(-t, 0, -1), glm::vec3(-t, 0, 1)
+        };
+        std::vector<glm::vec3> points;
+        for (const glm::vec3& corner : corners) points.push_back(glm::normalize(corner));
+
+        indices = {
+            0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+            1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+            3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+            4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+        };
+
+        // Each edge is split once, shared by the two triangles on either side
+        for (int level = 0; level < SUBDIVISIONS; level++)
+        {
+            std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> midpoints;
+            auto midpoint = [&](const std::uint32_t a, const std::uint32_t b)
+            {
+                const auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                const auto found = midpoints.find(key);
+                if (found != midpoints.end()) return found->second;
+
+                points.push_back(glm::normalize(points[a] + points[b]));
+                const auto index = static_cast<std::uint32_t>(points.size() - 1);
+                midpoints.emplace(key, index);
+                return index;
+            };
+
+            std::vector<std::uint32_t> split;
+            split.reserve(indices.size() * 4);
+            for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                const std::uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+                const std::uint32_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+                split.insert(split.end(), {a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca});
+            }
+            indices = std::move(split);
+        }
+
+        vertices.assign(points.size(), Vertex{});
+        for (std::size_t i = 0; i < points.size(); i++)
+        {
+            vertices[i].Position = points[i];
+            vertices[i].Normal = points[i];
+            vertices[i].TexCoords = glm::vec2(0.5f);
+        }
+    }
+}
+
+InstancedSpheres::InstancedSpheres()
+{
+    texture_.id = texture_from_file("orange_yellow.png", "resources/textures/colours");
+    texture_.type = "texture_diffuse";
+    texture_.path = "orange_yellow.png";
+
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    build_icosphere(vertices, indices);
+    index_count_ = static_cast<unsigned int>(indices.size());
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &instance_VBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint32_t), indices.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+
+    // Position and radius, advanced once per instance rather than per vertex
+    glBindBuffer(GL_ARRAY_BUFFER, instance_VBO);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glVertexAttribDivisor(3, 1);
+    glBindVertexArray(0);
+}
+
+InstancedSpheres::~InstancedSpheres()
+{
+    glDeleteBuffers(1, &instance_VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteTextures(1, &texture_.id);
+}
+
+void InstancedSpheres::update(const std::vector<float>& instances)
+{
+    instance_count_ = instances.size() / 4;
+    if (instance_count_ == 0) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_VBO);
+    if (instance_count_ > instance_capacity_)
+    {
+        instance_capacity_ = instance_count_;
+        glBufferData(GL_ARRAY_BUFFER, instance_capacity_ * 4 * sizeof(float), instances.data(), GL_STREAM_DRAW);
+    }
+    else
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instance_count_ * 4 * sizeof(float), instances.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedSpheres::draw(Shader &shader)
+{
+    if (instance_count_ == 0) return;
+
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(glGetUniformLocation(shader.ID, "texture_diffuse1"), 0);
+    glBindTexture(GL_TEXTURE_2D, texture_.id);
+
+    glBindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, index_count_, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(instance_count_));
+    glBindVertexArray(0);
+}
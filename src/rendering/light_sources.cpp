@@ -0,0 +1,37 @@
+#include "vectra/rendering/light_sources.h"
+
+#include "vectra/rendering/shader.h"
+
+void DirectionalLight::apply_to_shader(const Shader& shader, const std::string& uniform_name) const
+{
+    shader.set_vec3(uniform_name + ".direction", direction);
+    shader.set_vec3(uniform_name + ".ambient", ambient);
+    shader.set_vec3(uniform_name + ".diffuse", diffuse);
+    shader.set_vec3(uniform_name + ".specular", specular);
+    shader.set_float(uniform_name + ".strength", strength);
+}
+
+void PointLight::apply_to_shader(const Shader& shader, const std::string& uniform_name) const
+{
+    shader.set_vec3(uniform_name + ".position", position);
+    shader.set_vec3(uniform_name + ".ambient", ambient);
+    shader.set_vec3(uniform_name + ".diffuse", diffuse);
+    shader.set_vec3(uniform_name + ".specular", specular);
+    shader.set_float(uniform_name + ".constant", constant);
+    shader.set_float(uniform_name + ".linear", linear);
+    shader.set_float(uniform_name + ".quadratic", quadratic);
+}
+
+void SpotLight::apply_to_shader(const Shader& shader, const std::string& uniform_name) const
+{
+    shader.set_vec3(uniform_name + ".position", position);
+    shader.set_vec3(uniform_name + ".direction", direction);
+    shader.set_float(uniform_name + ".cut_off", cut_off);
+    shader.set_float(uniform_name + ".outer_cut_off", outer_cut_off);
+    shader.set_vec3(uniform_name + ".ambient", ambient);
+    shader.set_vec3(uniform_name + ".diffuse", diffuse);
+    shader.set_vec3(uniform_name + ".specular", specular);
+    shader.set_float(uniform_name + ".constant", constant);
+    shader.set_float(uniform_name + ".linear", linear);
+    shader.set_float(uniform_name + ".quadratic", quadratic);
+}
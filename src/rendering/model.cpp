@@ -12,8 +12,6 @@
 #include "vectra/rendering/model.h"
 
 
-unsigned int texture_from_file(const char *path, const std::string &directory, bool gamma = false);
-
 Model::Model(std::string const &path, bool gamma) : gamma_correction(gamma)
 {
     load_model(path);
@@ -21,6 +21,7 @@
 #include "camera.h"
 #include "utils.h"
 #include "vectra/core/scene.h"
+#include "vectra/core/profiler.h"
 
 void framebuffer_size_callback(GLFWwindow* window, const int width, const int height)
 {
@@ -150,6 +151,7 @@ Renderer::Renderer(EngineState* state)
     scene_fbo_ = std::make_unique<Framebuffer>(state_->scene_view_width, state_->scene_view_height);
 
     model_shader_ = std::make_unique<Shader>("resources/shaders/model.vert", "resources/shaders/blinn_phong.frag");
+    particle_shader_ = std::make_unique<Shader>("resources/shaders/particle.vert", "resources/shaders/blinn_phong.frag");
     // Load depth-only shader for shadow mapping (stub)
     depth_shader_ = std::make_unique<Shader>("resources/shaders/shadow_mapping_depth.vert", "resources/shaders/shadow_mapping_depth.frag");
 
@@ -200,7 +202,6 @@ void Renderer::setup_from_scene(const Scene& scene)
     camera_ = scene.camera;
 
     scene_lights_ = scene.scene_lights;
-    skybox_ = std::make_unique<Skybox>(scene.skybox);
     projection_matrix_ = camera_.get_projection_matrix();
 
 }
@@ -247,17 +248,21 @@ void Renderer::render_snapshot_frame(Skybox &skybox, const SceneSnapshot& snapsh
     glm::mat4 view_matrix = camera_.get_view_matrix();
     glm::vec3 camera_position = vector3_to_vec3(camera_.transform.position);
 
-    for (const auto& obj_snapshot : snapshot.object_snapshots) {
-        glm::mat4 model_matrix = Camera::get_model_matrix(obj_snapshot.transform);
+    resolve_models(snapshot);
+    for (std::size_t id = 0; id < snapshot.object_count(); id++) {
+        glm::mat4 model_matrix = glm::make_mat4(&snapshot.model_matrices[16 * id]);
 
-        draw_game_object(obj_snapshot.model_name, model_matrix, view_matrix, projection_matrix_, camera_position);
+        draw_game_object(*snapshot_models_[snapshot.object_table->model_ids[id]], model_matrix, view_matrix, projection_matrix_, camera_position);
     }
+    draw_soft_bodies(snapshot, view_matrix, projection_matrix_, camera_position);
+    draw_particles(snapshot, view_matrix, projection_matrix_, camera_position);
 
     skybox_->draw(view_matrix, projection_matrix_);
 }
 
 void Renderer::render_to_framebuffer(const SceneSnapshot& snapshot, const linkit::real dt)
 {
+    VECTRA_PROFILE_SCOPE("Renderer::render_to_framebuffer");
     process_input(pWindow_, camera_, dt, state_->scene_view_focused);
 
     // Resize the framebuffer if needed
@@ -273,7 +278,10 @@ void Renderer::render_to_framebuffer(const SceneSnapshot& snapshot, const linkit
     );
 
     // NEW: render shadow maps (currently a stub)
-    render_shadow_maps(snapshot, dt);
+    {
+        VECTRA_PROFILE_SCOPE("Shadow maps");
+        render_shadow_maps(snapshot, dt);
+    }
 
     // Bind framebuffer and render scene
     scene_fbo_->bind();
@@ -284,20 +292,21 @@ void Renderer::render_to_framebuffer(const SceneSnapshot& snapshot, const linkit
     glm::mat4 view_matrix = camera_.get_view_matrix();
     glm::vec3 camera_position = vector3_to_vec3(camera_.transform.position);
 
-    for (const auto& obj_snapshot : snapshot.object_snapshots) {
-        glm::mat4 model_matrix = Camera::get_model_matrix(obj_snapshot.transform);
-        draw_game_object(obj_snapshot.model_name, model_matrix, view_matrix, projection_matrix_, camera_position);
+    resolve_models(snapshot);
+    for (std::size_t id = 0; id < snapshot.object_count(); id++) {
+        glm::mat4 model_matrix = glm::make_mat4(&snapshot.model_matrices[16 * id]);
+        draw_game_object(*snapshot_models_[snapshot.object_table->model_ids[id]], model_matrix, view_matrix, projection_matrix_, camera_position);
 
         if (state_->draw_forces)
         {
             debug_drawer_->set_light_sources(scene_lights_, camera_position);
-            debug_drawer_->draw_force(obj_snapshot.transform, obj_snapshot.force, view_matrix, projection_matrix_, camera_position);
+            debug_drawer_->draw_force(snapshot.transforms[id], snapshot.forces[id], view_matrix, projection_matrix_, camera_position);
 
         }
-        if (obj_snapshot.has_spring)
+        if (snapshot.has_spring[id])
         {
             debug_drawer_->set_light_sources(scene_lights_, camera_position);
-            debug_drawer_->draw_spring(obj_snapshot.transform.position, obj_snapshot.spring_anchor, view_matrix, projection_matrix_, camera_position);
+            debug_drawer_->draw_spring(snapshot.transforms[id].position, snapshot.spring_anchors[id], view_matrix, projection_matrix_, camera_position);
         }
         if (state_->draw_bvh && snapshot.bvh_root)
         {
@@ -305,6 +314,8 @@ void Renderer::render_to_framebuffer(const SceneSnapshot& snapshot, const linkit
             debug_drawer_->draw_bvh(snapshot.bvh_root, view_matrix, projection_matrix_);
         }
     }
+    draw_soft_bodies(snapshot, view_matrix, projection_matrix_, camera_position);
+    draw_particles(snapshot, view_matrix, projection_matrix_, camera_position);
 
     skybox_->draw(view_matrix, projection_matrix_);
 
@@ -333,6 +344,7 @@ GLuint Renderer::get_scene_texture_id() const
 
 void Renderer::end_frame() const
 {
+    VECTRA_PROFILE_SCOPE("Present");
     glfwSwapBuffers(pWindow_);
 }
 
@@ -341,6 +353,7 @@ void Renderer::end_frame() const
 void Renderer::cleanup(const Scene &scene)
 {
     model_shader_->delete_program();
+    particle_shader_->delete_program();
 
 
     glfwTerminate();
@@ -366,7 +379,7 @@ void Renderer::draw_game_object(GameObject& obj, glm::mat4 model_matrix, glm::ma
     model_cache_.at(obj.model_name).draw(*model_shader_);
 }
 
-void Renderer::draw_game_object(const std::string& model_name, glm::mat4 model_matrix, glm::mat4 view_matrix, glm::mat4 projection_matrix, glm::vec3 camera_position)
+void Renderer::draw_game_object(Model& model, glm::mat4 model_matrix, glm::mat4 view_matrix, glm::mat4 projection_matrix, glm::vec3 camera_position)
 {
     model_shader_->use();
     model_shader_->set_mat4("model", model_matrix);
@@ -381,7 +394,63 @@ void Renderer::draw_game_object(const std::string& model_name, glm::mat4 model_m
 
 
 
-    model_cache_.at(model_name).draw(*model_shader_);
+    model.draw(*model_shader_);
+}
+
+void Renderer::resolve_models(const SceneSnapshot& snapshot)
+{
+    if (snapshot.object_table == resolved_table_) return;
+
+    resolved_table_ = snapshot.object_table;
+    snapshot_models_.clear();
+    if (!resolved_table_) return;
+    for (const auto& model_name : resolved_table_->model_names)
+    {
+        snapshot_models_.push_back(&model_cache_.at(model_name));
+    }
+}
+
+// Soft bodies are already in world space, so they are drawn with an identity model matrix
+void Renderer::draw_soft_bodies(const SceneSnapshot& snapshot, glm::mat4 view_matrix, glm::mat4 projection_matrix, glm::vec3 camera_position)
+{
+    soft_body_meshes_.resize(snapshot.soft_body_snapshots.size());
+    if (soft_body_meshes_.empty()) return;
+
+    model_shader_->use();
+    model_shader_->set_mat4("model", glm::mat4(1.0f));
+    model_shader_->set_mat4("view", view_matrix);
+    model_shader_->set_mat4("projection", projection_matrix);
+    model_shader_->set_vec3("camera_position", camera_position);
+
+    scene_lights_.setup_lighting(*model_shader_, camera_position);
+
+    for (std::size_t i = 0; i < soft_body_meshes_.size(); i++)
+    {
+        if (!soft_body_meshes_[i]) soft_body_meshes_[i] = std::make_unique<DeformableMesh>();
+        soft_body_meshes_[i]->update(snapshot.soft_body_snapshots[i].positions, snapshot.soft_body_snapshots[i].triangles);
+        soft_body_meshes_[i]->draw(*model_shader_);
+    }
+}
+
+// Every particle of a system is drawn in one instanced call
+void Renderer::draw_particles(const SceneSnapshot& snapshot, glm::mat4 view_matrix, glm::mat4 projection_matrix, glm::vec3 camera_position)
+{
+    particle_meshes_.resize(snapshot.particle_snapshots.size());
+    if (particle_meshes_.empty()) return;
+
+    particle_shader_->use();
+    particle_shader_->set_mat4("view", view_matrix);
+    particle_shader_->set_mat4("projection", projection_matrix);
+    particle_shader_->set_vec3("camera_position", camera_position);
+
+    scene_lights_.setup_lighting(*particle_shader_, camera_position);
+
+    for (std::size_t i = 0; i < particle_meshes_.size(); i++)
+    {
+        if (!particle_meshes_[i]) particle_meshes_[i] = std::make_unique<InstancedSpheres>();
+        particle_meshes_[i]->update(snapshot.particle_snapshots[i].instances);
+        particle_meshes_[i]->draw(*particle_shader_);
+    }
 }
 
 // Minimal stub implementation for shadow map generation. Will be expanded in follow-up changes.
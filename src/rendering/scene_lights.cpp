@@ -0,0 +1,29 @@
+#include "vectra/rendering/scene_lights.h"
+
+#include <string>
+
+#include "vectra/rendering/shader.h"
+
+void SceneLights::setup_lighting(const Shader& shader, glm::vec3 camera_position) const
+{
+    shader.use();
+    shader.set_vec3("view_pos", camera_position);
+
+    // Directional Lights
+    shader.set_int("num_directional_lights", static_cast<int>(directional_lights.size()));
+    for (size_t i = 0; i < directional_lights.size(); ++i) {
+        directional_lights[i].apply_to_shader(shader, "directional_lights[" + std::to_string(i) + "]");
+    }
+
+    // Point Lights
+    shader.set_int("num_point_lights", static_cast<int>(point_lights.size()));
+    for (size_t i = 0; i < point_lights.size(); ++i) {
+        point_lights[i].apply_to_shader(shader, "point_lights[" + std::to_string(i) + "]");
+    }
+
+    // Spotlights
+    shader.set_int("num_spot_lights", static_cast<int>(spot_lights.size()));
+    for (size_t i = 0; i < spot_lights.size(); ++i) {
+        spot_lights[i].apply_to_shader(shader, "spot_lights[" + std::to_string(i) + "]");
+    }
+}
@@ -4,6 +4,8 @@
 #include <ostream>
 #include <stb/stb_image.h>
 
+#include "vectra/core/job_system.h"
+
 Skybox::Skybox()
 {
     float vertices[] = {
@@ -81,19 +83,32 @@ unsigned int Skybox::load_cubemap()
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
     stbi_set_flip_vertically_on_load(false);
-    int width, height, nrComponents;
+
+    // The faces are decoded side by side on the job system, then uploaded here where the OpenGL context is current
+    struct FaceImage
+    {
+        unsigned char *data = nullptr;
+        int width = 0, height = 0, components = 0;
+    };
+    std::vector<FaceImage> images(faces.size());
+    JobSystem::instance().parallel_for(faces.size(), 1, [&](const std::size_t i)
+    {
+        FaceImage& image = images[i];
+        image.data = stbi_load(faces[i].c_str(), &image.width, &image.height, &image.components, 0);
+    });
+
     for (unsigned int i = 0; i < faces.size(); i++)
     {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrComponents, 0);
-        if (data)
+        const FaceImage& image = images[i];
+        if (image.data)
         {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.data);
+            stbi_image_free(image.data);
         }
         else
         {
             std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
+            stbi_image_free(image.data);
         }
     }
 